@@ -45,7 +45,7 @@ public:
 private:
     void searchBar();
     HidVertical hid;
-    const std::map<u8, std::string>& validCountries;
+    const std::map<u8, std::string> validCountries;
     std::map<u8, std::string> countries;
     std::string searchString    = "";
     std::string oldSearchString = "";
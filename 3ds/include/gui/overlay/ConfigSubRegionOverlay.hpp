@@ -45,7 +45,7 @@ public:
 private:
     void searchBar();
     HidVertical hid;
-    const std::map<u8, std::string>& validSubRegions;
+    const std::map<u8, std::string> validSubRegions;
     std::map<u8, std::string> subregions;
     std::string searchString    = "";
     std::string oldSearchString = "";
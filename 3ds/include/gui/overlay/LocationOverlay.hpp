@@ -47,7 +47,7 @@ private:
     std::shared_ptr<PKX> pkm;
     void searchBar();
     HidVertical hid;
-    const std::map<u16, std::string>& validLocations;
+    const std::map<u16, std::string> validLocations;
     std::map<u16, std::string> locations;
     std::string searchString    = "";
     std::string oldSearchString = "";
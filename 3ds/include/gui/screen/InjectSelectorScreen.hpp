@@ -50,7 +50,7 @@ private:
     bool toggleFilter(const std::string& lang);
     bool toggleFilter(u8 type);
     HidHorizontal hid;
-    std::vector<nlohmann::json> wondercards;
+    std::vector<MysteryGift::eventData> wondercards;
     std::vector<std::unique_ptr<Button>> buttons;
     std::vector<std::unique_ptr<ToggleButton>> langFilters;
     std::vector<std::unique_ptr<ToggleButton>> typeFilters;
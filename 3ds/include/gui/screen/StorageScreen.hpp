@@ -28,6 +28,7 @@
 #define STORAGESCREEN_HPP
 
 #include "Button.hpp"
+#include "CompiledPKFilter.hpp"
 #include "PKFilter.hpp"
 #include "PKX.hpp"
 #include "Sav.hpp"
@@ -66,8 +67,10 @@ private:
     void setBoxName(bool storage);
     void pickup();
     bool isValidTransfer(std::shared_ptr<PKX> moveMon, bool bulkTransfer = false);
+    bool isValidTransfer(const PKX& moveMon, bool bulkTransfer = false);
     void scrunchSelection();
     void grabSelection(bool remove);
+    const CompiledPKFilter& compiled() const;
 
     void shareSend();
     void shareReceive();
@@ -93,6 +96,9 @@ private:
     std::pair<int, int> selectDimensions = {0, 0};
     bool currentlySelecting              = false;
     std::shared_ptr<PKFilter> filter     = std::make_shared<PKFilter>();
+    // Only the storage overlay leads to the filter screen, so filter is compiled again on the first draw after that overlay is gone
+    mutable std::unique_ptr<CompiledPKFilter> compiledFilter;
+    mutable bool filterMayChange = false;
 };
 
 #endif
@@ -60,7 +60,7 @@ namespace TitleLoader
     void scanSaves(void);
     bool load(std::shared_ptr<Title> title);
     bool load(std::shared_ptr<Title> title, const std::string& path);
-    bool load(u8* data, size_t size);
+    bool load(std::unique_ptr<u8[]> data, size_t size);
     void backupSave(const std::string& id);
     void saveChanges(void);
     void saveToTitle(bool ask);
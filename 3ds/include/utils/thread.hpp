@@ -32,7 +32,7 @@
 
 namespace Threads
 {
-    void create(ThreadFunc entrypoint, void* arg = nullptr);
+    void create(ThreadFunc entrypoint, void* arg = nullptr, size_t stackSize = 4 * 1024);
     void destroy(void);
 }
 
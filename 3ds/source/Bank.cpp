@@ -28,9 +28,12 @@
 #include "Configuration.hpp"
 #include "FSStream.hpp"
 #include "PB7.hpp"
+#include "PKXView.hpp"
 #include "archive.hpp"
 #include "banks.hpp"
+#include "crc.hpp"
 #include "gui.hpp"
+#include <cstddef>
 
 #define BANK(paths) paths.first
 #define JSON(paths) paths.second
@@ -49,7 +52,10 @@ void Bank::load(int maxBoxes)
         delete[] data;
         data = nullptr;
     }
-    needsCheck = false;
+    slotIndex    = nullptr;
+    namesChanged = false;
+    forceCompact = false;
+    journalCount = 0;
     if (name() == "pksm_1" && io::exists("/3ds/PKSM/bank/bank.bin"))
     {
         convertFromBankBin();
@@ -58,13 +64,14 @@ void Bank::load(int maxBoxes)
     {
         auto paths    = this->paths();
         bool needSave = false;
+        finishCompaction();
         FSStream in(ARCHIVE, BANK(paths), FS_OPEN_READ);
         if (in.good())
         {
             Gui::waitFrame(i18n::localize("BANK_LOAD"));
-            BankHeader h{"BAD_MGC", 0, 0};
+            BankHeader h{"BAD_MGC", 0, 0, 0};
             size = in.size();
-            in.read((char*)&h, sizeof(BankHeader) - sizeof(int));
+            in.read((char*)&h, offsetof(BankHeader, boxes));
             if (memcmp(&h, BANK_MAGIC.data(), 8))
             {
                 Gui::warn(i18n::localize("BANK_CORRUPT"));
@@ -75,25 +82,44 @@ void Bank::load(int maxBoxes)
             else
             {
                 // NOTE: THIS IS THE CONVERSION SECTION. WILL NEED TO BE MODIFIED WHEN THE FORMAT IS CHANGED
+                // Older versions have no generation, so no journal can belong to them
+                bool current = h.version == BANK_VERSION;
                 if (h.version == 1)
                 {
-                    h.boxes  = (size - (sizeof(BankHeader) - sizeof(int))) / sizeof(BankEntry) / 30;
+                    h.boxes  = (size - offsetof(BankHeader, boxes)) / sizeof(BankEntry) / 30;
                     maxBoxes = h.boxes;
                     extern nlohmann::json g_banks;
                     g_banks[bankName] = maxBoxes;
                     Banks::saveJson();
-                    data      = new u8[size = size + sizeof(int)];
+                    data      = new u8[size = size - offsetof(BankHeader, boxes) + sizeof(BankHeader)];
+                    h.version = BANK_VERSION;
+                    needSave  = true;
+                }
+                else if (h.version == 2)
+                {
+                    in.read(&h.boxes, sizeof(int));
+                    data      = new u8[size = size - offsetof(BankHeader, generation) + sizeof(BankHeader)];
                     h.version = BANK_VERSION;
                     needSave  = true;
                 }
                 else
                 {
                     data = new u8[size];
-                    in.read(&h.boxes, sizeof(int));
+                    in.read(&h.boxes, sizeof(BankHeader) - offsetof(BankHeader, boxes));
                 }
                 std::copy((char*)&h, (char*)(&h + 1), data);
                 in.read(data + sizeof(BankHeader), size - sizeof(BankHeader));
                 in.close();
+                dirtyEntries.assign(boxes() * 30, false);
+                if (current)
+                {
+                    replayJournal();
+                }
+                contentSum = checksum();
+                if (needSave)
+                {
+                    forceCompact = true;
+                }
             }
         }
         else
@@ -116,13 +142,15 @@ void Bank::load(int maxBoxes)
             if (boxNames.is_discarded())
             {
                 createJSON();
-                needSave = true;
+                namesChanged = true;
+                needSave     = true;
             }
             else
             {
                 for (int i = boxNames.size(); i < boxes(); i++)
                 {
-                    boxNames[i] = i18n::localize("STORAGE") + " " + std::to_string(i + 1);
+                    boxNames[i]  = i18n::localize("STORAGE") + " " + std::to_string(i + 1);
+                    namesChanged = true;
                     if (!needSave)
                     {
                         needSave = true;
@@ -134,7 +162,8 @@ void Bank::load(int maxBoxes)
         {
             in.close();
             createJSON();
-            needSave = true;
+            namesChanged = true;
+            needSave     = true;
         }
 
         if (boxes() != maxBoxes)
@@ -148,52 +177,204 @@ void Bank::load(int maxBoxes)
         }
         else
         {
-            sha256(prevHash.data(), data, size);
+            savedSum = contentSum;
         }
     }
 }
 
 bool Bank::save() const
 {
-    if (Configuration::getInstance().autoBackup())
+    Gui::waitFrame(i18n::localize("BANK_SAVE"));
+    if (forceCompact || !appendJournal())
     {
-        if (!backup() && !Gui::showChoiceMessage(i18n::localize("BACKUP_FAIL_SAVE_1"), i18n::localize("BACKUP_FAIL_SAVE_2")))
+        // Only a full rewrite replaces data that is already on the SD card, so that's when the backup is needed
+        if (Configuration::getInstance().autoBackup())
+        {
+            if (!backup() && !Gui::showChoiceMessage(i18n::localize("BACKUP_FAIL_SAVE_1"), i18n::localize("BACKUP_FAIL_SAVE_2")))
+            {
+                return false;
+            }
+        }
+        if (!compact())
         {
             return false;
         }
     }
-    auto paths = this->paths();
-    Gui::waitFrame(i18n::localize("BANK_SAVE"));
-    Archive::deleteFile(ARCHIVE, BANK(paths));
-    FSStream out(ARCHIVE, BANK(paths), FS_OPEN_WRITE, sizeof(BankHeader) + sizeof(BankEntry) * boxes() * 30);
-    if (out.good())
+    if (namesChanged && !saveJSON())
     {
-        out.write(data, sizeof(BankHeader) + sizeof(BankEntry) * boxes() * 30);
-        out.close();
+        return false;
+    }
 
-        std::string jsonData = boxNames.dump(2);
-        Archive::deleteFile(ARCHIVE, JSON(paths));
-        out = FSStream(ARCHIVE, JSON(paths), FS_OPEN_WRITE, jsonData.size());
-        if (out.good())
+    std::fill(dirtyEntries.begin(), dirtyEntries.end(), false);
+    savedSum = contentSum;
+    return true;
+}
+
+bool Bank::appendJournal() const
+{
+    std::vector<u32> changed;
+    for (size_t i = 0; i < dirtyEntries.size(); i++)
+    {
+        if (dirtyEntries[i])
         {
-            out.write(jsonData.data(), jsonData.size() + 1);
-            sha256(prevHash.data(), data, sizeof(BankHeader) + sizeof(BankEntry) * boxes() * 30);
+            changed.push_back(i);
         }
-        else
+    }
+    if (changed.empty())
+    {
+        return true;
+    }
+    if (journalCount + changed.size() > JOURNAL_CAPACITY)
+    {
+        return false;
+    }
+
+    FSStream out(ARCHIVE, journalPath(), FS_OPEN_READ | FS_OPEN_WRITE, sizeof(JournalHeader) + sizeof(JournalRecord) * JOURNAL_CAPACITY);
+    if (!out.good())
+    {
+        out.close();
+        return false;
+    }
+    BankEntry* bank = (BankEntry*)(data + sizeof(BankHeader));
+    out.seek(sizeof(JournalHeader) + sizeof(JournalRecord) * journalCount, SEEK_SET);
+    for (u32 index : changed)
+    {
+        JournalRecord record{index, bank[index]};
+        if (out.write(&record, sizeof(JournalRecord)) != sizeof(JournalRecord))
         {
-            Gui::error(i18n::localize("BANK_NAME_ERROR"), out.result());
+            out.close();
+            return false;
         }
+    }
+    // The records only count once the header says so, which makes a save that was cut off a no-op instead of a half-applied one
+    JournalHeader header;
+    std::copy(JOURNAL_MAGIC.begin(), JOURNAL_MAGIC.end(), header.MAGIC);
+    header.count      = journalCount + changed.size();
+    header.generation = ((BankHeader*)data)->generation;
+    out.seek(0, SEEK_SET);
+    if (out.write(&header, sizeof(JournalHeader)) != sizeof(JournalHeader))
+    {
         out.close();
-        return true;
+        return false;
     }
-    else
+    out.close();
+    journalCount = header.count;
+    return true;
+}
+
+bool Bank::compact() const
+{
+    auto paths       = this->paths();
+    std::string temp = BANK(paths) + ".tmp";
+    u32 bankSize     = sizeof(BankHeader) + sizeof(BankEntry) * boxes() * 30;
+    // The journal on disk was written for the old generation, so it stops applying as soon as the new bank is in place
+    ((BankHeader*)data)->generation++;
+    Archive::deleteFile(ARCHIVE, temp);
+    // The magic goes in last, so that a temporary bank that has it is known to be complete
+    static constexpr u8 noMagic[8] = {0};
+    FSStream out(ARCHIVE, temp, FS_OPEN_WRITE, bankSize);
+    bool good = out.good() && out.write(noMagic, 8) == 8 && out.write(data + 8, bankSize - 8) == bankSize - 8;
+    if (good)
+    {
+        out.seek(0, SEEK_SET);
+        good = out.write(data, 8) == 8;
+    }
+    if (!good)
     {
         Gui::error(i18n::localize("BANK_SAVE_ERROR"), out.result());
         out.close();
+        Archive::deleteFile(ARCHIVE, temp);
+        ((BankHeader*)data)->generation--;
         return false;
     }
+    out.close();
 
-    needsCheck = false;
+    // From here on the new bank is what load() sees, even if the move is cut off
+    journalCount = 0;
+    Result res   = Archive::moveFile(ARCHIVE, temp, ARCHIVE, BANK(paths));
+    if (R_FAILED(res))
+    {
+        Gui::error(i18n::localize("BANK_SAVE_ERROR"), res);
+        return false;
+    }
+    forceCompact = false;
+    namesChanged = true;
+    return true;
+}
+
+void Bank::finishCompaction() const
+{
+    auto paths       = this->paths();
+    std::string temp = BANK(paths) + ".tmp";
+    FSStream in(ARCHIVE, temp, FS_OPEN_READ);
+    if (!in.good())
+    {
+        in.close();
+        return;
+    }
+    char magic[8] = {0};
+    in.read(magic, 8);
+    in.close();
+    if (!memcmp(magic, BANK_MAGIC.data(), 8))
+    {
+        Archive::moveFile(ARCHIVE, temp, ARCHIVE, BANK(paths));
+    }
+    else
+    {
+        Archive::deleteFile(ARCHIVE, temp);
+    }
+}
+
+bool Bank::saveJSON() const
+{
+    auto paths           = this->paths();
+    std::string jsonData = boxNames.dump(2);
+    Archive::deleteFile(ARCHIVE, JSON(paths));
+    FSStream out(ARCHIVE, JSON(paths), FS_OPEN_WRITE, jsonData.size());
+    if (out.good())
+    {
+        out.write(jsonData.data(), jsonData.size() + 1);
+        out.close();
+        namesChanged = false;
+        return true;
+    }
+    Gui::error(i18n::localize("BANK_NAME_ERROR"), out.result());
+    out.close();
+    return false;
+}
+
+void Bank::replayJournal()
+{
+    journalCount = 0;
+    FSStream in(ARCHIVE, journalPath(), FS_OPEN_READ);
+    if (!in.good())
+    {
+        in.close();
+        return;
+    }
+    JournalHeader header;
+    if (in.read(&header, sizeof(JournalHeader)) != sizeof(JournalHeader) || memcmp(header.MAGIC, JOURNAL_MAGIC.data(), 8) ||
+        header.count > JOURNAL_CAPACITY || header.generation != ((BankHeader*)data)->generation)
+    {
+        in.close();
+        return;
+    }
+    BankEntry* bank = (BankEntry*)(data + sizeof(BankHeader));
+    for (u32 i = 0; i < header.count; i++)
+    {
+        JournalRecord record;
+        if (in.read(&record, sizeof(JournalRecord)) != sizeof(JournalRecord))
+        {
+            break;
+        }
+        // Records hold whole entries in the order they were saved, so the last one for a slot is what it held at the last save
+        if (record.index < (u32)boxes() * 30)
+        {
+            bank[record.index] = record.entry;
+        }
+    }
+    in.close();
+    journalCount = header.count;
 }
 
 void Bank::resize(size_t boxes)
@@ -210,12 +391,16 @@ void Bank::resize(size_t boxes)
         {
             std::fill_n(newData + size, newSize - size, 0xFF);
         }
-        data = newData;
+        data      = newData;
+        slotIndex = nullptr;
+        dirtyEntries.resize(boxes * 30, false);
+        forceCompact = true;
 
-        Archive::deleteFile(ARCHIVE, BANK(paths));
+        // compact() replaces the bank file itself, at its new size
         Archive::deleteFile(ARCHIVE, JSON(paths));
 
         ((BankHeader*)data)->boxes = boxes;
+        contentSum                 = checksum();
 
         for (size_t i = boxNames.size(); i < boxes; i++)
         {
@@ -249,6 +434,25 @@ std::shared_ptr<PKX> Bank::pkm(int box, int slot) const
     }
 }
 
+PKXView Bank::slotView(int box, int slot) const
+{
+    BankEntry* bank = (BankEntry*)(data + sizeof(BankHeader));
+    int index       = box * 30 + slot;
+    return PKXView(bank[index].gen, bank[index].data);
+}
+
+void Bank::forEachSlot(const std::function<void(int box, int slot, const PKX& pkm)>& visitor) const
+{
+    for (int i = 0; i < boxes() * 30; i++)
+    {
+        PKXView view = slotView(i / 30, i % 30);
+        if (view)
+        {
+            visitor(i / 30, i % 30, *view);
+        }
+    }
+}
+
 void Bank::pkm(std::shared_ptr<PKX> pkm, int box, int slot)
 {
     BankEntry* bank = (BankEntry*)(data + sizeof(BankHeader));
@@ -257,8 +461,13 @@ void Bank::pkm(std::shared_ptr<PKX> pkm, int box, int slot)
     if (pkm->species() == 0)
     {
         std::fill_n((char*)&newEntry, sizeof(BankEntry), 0xFF);
-        bank[index] = newEntry;
-        needsCheck  = true;
+        contentSum          = contentSum - entryChecksum(index, bank[index]) + entryChecksum(index, newEntry);
+        bank[index]         = newEntry;
+        dirtyEntries[index] = true;
+        if (slotIndex)
+        {
+            slotIndex->clear(index);
+        }
         return;
     }
     newEntry.gen = pkm->generation();
@@ -267,8 +476,86 @@ void Bank::pkm(std::shared_ptr<PKX> pkm, int box, int slot)
     {
         std::fill_n(newEntry.data + pkm->getLength(), 260 - pkm->getLength(), 0xFF);
     }
-    bank[index] = newEntry;
-    needsCheck  = true;
+    contentSum          = contentSum - entryChecksum(index, bank[index]) + entryChecksum(index, newEntry);
+    bank[index]         = newEntry;
+    dirtyEntries[index] = true;
+    if (slotIndex)
+    {
+        slotIndex->set(index, *pkm);
+    }
+}
+
+u32 Bank::filterBox(const CompiledPKFilter& filter, int box) const
+{
+    BankEntry* bank = (BankEntry*)(data + sizeof(BankHeader)) + box * 30;
+    u32 ret         = 0;
+    // Match runs of same-generation entries in one batch each
+    for (int start = 0; start < 30;)
+    {
+        int end = start + 1;
+        while (end < 30 && bank[end].gen == bank[start].gen)
+        {
+            end++;
+        }
+        ret |= filter.match(bank[start].gen, bank[start].data, sizeof(BankEntry), end - start) << start;
+        start = end;
+    }
+    return ret;
+}
+
+int Bank::transferBoxes(Sav& save, int firstBox, int saveBox, int count, const std::function<bool(int index, const PKX& from, const PKX& to)>& accept)
+{
+    BankEntry* bank = (BankEntry*)(data + sizeof(BankHeader));
+    int ret         = 0;
+    count           = std::min({count, boxes() - firstBox, save.maxBoxes() - saveBox});
+    for (int box = 0; box < count; box++)
+    {
+        for (int slot = 0; slot < 30 && (saveBox + box) * 30 + slot < save.maxSlot(); slot++)
+        {
+            const BankEntry& entry = bank[(firstBox + box) * 30 + slot];
+            u8 converted[260];
+            bool empty;
+            {
+                PKXView from(entry.gen, entry.data);
+                empty = !from || (from->encryptionConstant() == 0 && from->species() == 0);
+                if (!empty)
+                {
+                    if (!PKX::convert(save, entry.gen, entry.data, save.generation(), converted))
+                    {
+                        continue;
+                    }
+                    PKXView to(save.generation(), converted);
+                    if (!accept(box * 30 + slot, *from, *to))
+                    {
+                        continue;
+                    }
+                }
+            }
+
+            pkm(save.pkm(saveBox + box, slot), firstBox + box, slot);
+            if (empty)
+            {
+                save.pkm(save.emptyPkm(), saveBox + box, slot, false);
+            }
+            else
+            {
+                save.transfer(save.generation(), converted, saveBox + box, slot);
+            }
+            ret++;
+        }
+    }
+    return ret;
+}
+
+const PKXIndex& Bank::index() const
+{
+    if (!slotIndex)
+    {
+        slotIndex = std::make_unique<PKXIndex>();
+        slotIndex->reset(boxes() * 30);
+        forEachSlot([this](int box, int slot, const PKX& pkm) { slotIndex->set(box * 30 + slot, pkm); });
+    }
+    return *slotIndex;
 }
 
 bool Bank::backup() const
@@ -282,6 +569,7 @@ bool Bank::backup() const
         return false;
     }
     Archive::copyFile(ARCHIVE, JSON(paths), Archive::sd(), "/3ds/PKSM/backups/" + bankName + ".json.bak");
+    Archive::copyFile(ARCHIVE, journalPath(), Archive::sd(), "/3ds/PKSM/backups/" + bankName + ".jnl.bak");
     return true;
 }
 
@@ -293,6 +581,7 @@ std::string Bank::boxName(int box) const
 void Bank::boxName(std::string name, int box)
 {
     boxNames[box] = name;
+    namesChanged  = true;
 }
 
 void Bank::createJSON()
@@ -314,23 +603,45 @@ void Bank::createBank(int maxBoxes)
     std::copy(BANK_MAGIC.data(), BANK_MAGIC.data() + BANK_MAGIC.size(), data);
     *(int*)(data + 8)  = BANK_VERSION;
     *(int*)(data + 12) = maxBoxes;
+    *(u32*)(data + 16) = 0;
     std::fill_n(data + sizeof(BankHeader), sizeof(BankEntry) * boxes() * 30, 0xFF);
+    dirtyEntries.assign(boxes() * 30, false);
+    forceCompact = true;
+    contentSum   = 0;
 }
 
 bool Bank::hasChanged() const
 {
-    if (!needsCheck)
+    return contentSum != savedSum || namesChanged;
+}
+
+u64 Bank::entryChecksum(u32 index, const BankEntry& entry)
+{
+    // Entries that pkm() would not read back as a Pokemon count as zero, so an empty bank needs no hashing at all
+    switch (entry.gen)
     {
-        return false;
+        case Generation::FOUR:
+        case Generation::FIVE:
+        case Generation::SIX:
+        case Generation::SEVEN:
+        case Generation::LGPE:
+            break;
+        default:
+            return 0;
     }
-    u8 hash[SHA256_BLOCK_SIZE];
-    sha256(hash, data, sizeof(BankHeader) + sizeof(BankEntry) * boxes() * 30);
-    if (memcmp(hash, prevHash.data(), SHA256_BLOCK_SIZE))
+    // Scaled by an odd multiplier unique to the slot
+    return CRC::fnv1a64((const u8*)&entry, sizeof(BankEntry)) * (2 * u64(index) + 1);
+}
+
+u64 Bank::checksum() const
+{
+    const BankEntry* bank = (const BankEntry*)(data + sizeof(BankHeader));
+    u64 sum               = 0;
+    for (int i = 0; i < boxes() * 30; i++)
     {
-        return true;
+        sum += entryChecksum(i, bank[i]);
     }
-    needsCheck = false;
-    return false;
+    return sum;
 }
 
 void Bank::convertFromBankBin()
@@ -355,12 +666,17 @@ void Bank::convertFromBankBin()
 
     data = new u8[size = sizeof(BankHeader) + sizeof(BankEntry) * oldSize / 232];
     std::copy(BANK_MAGIC.data(), BANK_MAGIC.data() + BANK_MAGIC.size(), data);
-    ((BankHeader*)data)->version = BANK_VERSION;
-    ((BankHeader*)data)->boxes   = oldSize / 232 / 30;
+    ((BankHeader*)data)->version    = BANK_VERSION;
+    ((BankHeader*)data)->boxes      = oldSize / 232 / 30;
+    ((BankHeader*)data)->generation = 0;
     extern nlohmann::json g_banks;
     g_banks["pksm_1"] = ((BankHeader*)data)->boxes;
     std::fill_n(data + sizeof(BankHeader), sizeof(BankEntry) * boxes() * 30, 0xFF);
-    boxNames = nlohmann::json::array();
+    dirtyEntries.assign(boxes() * 30, false);
+    forceCompact = true;
+    namesChanged = true;
+    contentSum   = 0;
+    boxNames     = nlohmann::json::array();
 
     for (int box = 0; box < std::min((int)oldSize / (232 * 30), boxes()); box++)
     {
@@ -454,9 +770,16 @@ bool Bank::setName(const std::string& name)
         }
         return false;
     }
+    // Follows the bank if it exists; a missing journal just means there are no pending records
+    Archive::moveFile(ARCHIVE, BANK(oldPaths) + ".jnl", ARCHIVE, journalPath());
     return true;
 }
 
+std::string Bank::journalPath() const
+{
+    return BANK(paths()) + ".jnl";
+}
+
 std::pair<std::string, std::string> Bank::paths() const
 {
     if (Configuration::getInstance().useExtData())
@@ -33,6 +33,7 @@
 #include "fetch.hpp"
 #include "gui.hpp"
 #include "i18n.hpp"
+#include "json.hpp"
 #include "loader.hpp"
 #include "random.hpp"
 #include "revision.h"
@@ -40,10 +41,22 @@
 #include "thread.hpp"
 #include <3ds.h>
 #include <stdio.h>
+#include <sys/stat.h>
 
 // increase the stack in order to allow quirc to decode large qrs
 int __stacksize__ = 64 * 1024;
 
+// Size, modification time and hash of every asset that passed its hash check, so that unchanged assets aren't read and hashed on every boot
+#define ASSET_STAMPS "/3ds/PKSM/assets/verified.json"
+
+#if STARTUP_TIMELINE
+// Writes how long each step of App::init took to /3ds/PKSM/startup.txt
+static std::vector<std::pair<const char*, u64>> timeline;
+#define TIMELINE(step) timeline.emplace_back(step, osGetTime())
+#else
+#define TIMELINE(step)
+#endif
+
 static u32 old_time_limit;
 static Handle hbldrHandle;
 
@@ -60,18 +73,60 @@ static bool matchSha256HashFromFile(const std::string& path, unsigned char* sha)
     FSStream in(Archive::sd(), path, FS_OPEN_READ);
     if (in.good())
     {
-        size_t size = in.size();
-        char* data  = new char[size];
-        in.read(data, size);
-        char hash[SHA256_BLOCK_SIZE];
-        sha256((unsigned char*)hash, (unsigned char*)data, size);
+        constexpr u32 chunkSize = 0x10000;
+        u8* data                = new u8[chunkSize];
+        SHA256_CTX ctx;
+        sha256_init(&ctx);
+        while (u32 read = in.read(data, chunkSize))
+        {
+            sha256_update(&ctx, data, read);
+        }
         delete[] data;
+        unsigned char hash[SHA256_BLOCK_SIZE];
+        sha256_final(&ctx, hash);
         match = memcmp(sha, hash, SHA256_BLOCK_SIZE) == 0;
     }
     in.close();
     return match;
 }
 
+static nlohmann::json readAssetStamps(void)
+{
+    nlohmann::json ret;
+    if (FILE* in = fopen(ASSET_STAMPS, "rt"))
+    {
+        ret = nlohmann::json::parse(in, nullptr, false);
+        fclose(in);
+    }
+    return ret.is_object() ? ret : nlohmann::json::object();
+}
+
+static void writeAssetStamps(const nlohmann::json& stamps)
+{
+    std::string data = stamps.dump();
+    if (FILE* out = fopen(ASSET_STAMPS, "wt"))
+    {
+        fwrite(data.data(), 1, data.size(), out);
+        fclose(out);
+    }
+}
+
+// What the asset on the SD card looks like right now. A different expected hash also counts as a change, for when an update changes an asset
+static nlohmann::json assetStamp(const asset& item)
+{
+    struct stat info;
+    if (stat(item.path.c_str(), &info) != 0)
+    {
+        return nullptr;
+    }
+    std::string hash;
+    for (auto byte : item.hash)
+    {
+        hash += StringUtils::format("%02x", byte);
+    }
+    return {{"size", (u64)info.st_size}, {"mtime", (s64)info.st_mtime}, {"sha256", hash}};
+}
+
 static Result downloadAdditionalAssets(void)
 {
     Result res      = 0;
@@ -84,38 +139,72 @@ static Result downloadAdditionalAssets(void)
             {0xea, 0x7f, 0x92, 0x86, 0x0a, 0x9b, 0x4d, 0x50, 0x3a, 0x0c, 0x2a, 0x6e, 0x48, 0x60, 0xfb, 0x93, 0x1f, 0xd3, 0xd7, 0x7d, 0x6a, 0xbb, 0x1d,
                 0xdb, 0xac, 0x59, 0xeb, 0xf1, 0x66, 0x34, 0xa4, 0x91}}};
 
-    for (auto item : assets)
+    nlohmann::json stamps = readAssetStamps();
+    bool stampsChanged    = false;
+    std::vector<asset*> missing;
+    std::vector<Fetch::Download> downloads;
+    for (auto& item : assets)
     {
         bool downloadAsset = true;
         if (io::exists(item.path))
         {
-            if (matchSha256HashFromFile(item.path, item.hash))
+            nlohmann::json stamp = assetStamp(item);
+            if (stamps.contains(item.path) && stamps[item.path] == stamp)
             {
                 downloadAsset = false;
             }
+            else if (matchSha256HashFromFile(item.path, item.hash))
+            {
+                downloadAsset     = false;
+                stamps[item.path] = stamp;
+                stampsChanged     = true;
+            }
             else
             {
                 std::remove(item.path.c_str());
+                stampsChanged = stamps.erase(item.path) > 0 || stampsChanged;
             }
         }
         if (downloadAsset)
         {
+            missing.push_back(&item);
+            downloads.push_back({item.url, item.path});
+        }
+    }
+    if (downloads.empty())
+    {
+        if (stampsChanged)
+        {
+            writeAssetStamps(stamps);
+        }
+        return res;
+    }
+
 #if !CITRA_DEBUG
-            u32 status;
-            ACU_GetWifiStatus(&status);
-            if (status == 0)
-                return -1;
+    u32 status;
+    ACU_GetWifiStatus(&status);
+    if (status == 0)
+        return -1;
 #endif
-            Result res1 = Fetch::download(item.url, item.path);
-            if (R_FAILED(res1))
-                return res1;
-            if (!matchSha256HashFromFile(item.path, item.hash))
-            {
-                std::remove(item.path.c_str());
-                return -1;
-            }
+    // All at once, so that the sheets share one connection to the server instead of waiting on each other
+    std::vector<Result> results = Fetch::download(downloads);
+    for (size_t i = 0; i < missing.size(); i++)
+    {
+        if (R_FAILED(results[i]))
+        {
+            res = results[i];
+        }
+        else if (!matchSha256HashFromFile(missing[i]->path, missing[i]->hash))
+        {
+            std::remove(missing[i]->path.c_str());
+            res = -1;
+        }
+        else
+        {
+            stamps[missing[i]->path] = assetStamp(*missing[i]);
         }
     }
+    writeAssetStamps(stamps);
     return res;
 }
 
@@ -370,6 +459,7 @@ Result App::init(const std::string& execPath)
 {
     Result res;
 
+    TIMELINE("start");
     hidInit();
     gfxInitDefault();
 
@@ -411,15 +501,21 @@ Result App::init(const std::string& execPath)
     {
         return consoleDisplayError("socInit failed.", -1);
     }
+    if (R_FAILED(res = Fetch::initialize()))
+        return consoleDisplayError("Fetch::initialize failed.", res);
+    TIMELINE("services");
 
     if (R_FAILED(res = downloadAdditionalAssets()))
         return consoleDisplayError(
             "Additional assets download failed.\n\nAlways make sure you're connected to the internet and on the lastest version.", res);
+    TIMELINE("additional assets");
     if (R_FAILED(res = Gui::init()))
         return consoleDisplayError("Gui::init failed.", res);
+    TIMELINE("Gui::init");
 
     i18n::init();
     Configuration::getInstance();
+    TIMELINE("i18n and configuration");
 
     if (Configuration::getInstance().autoUpdate() && update(execPath))
     {
@@ -448,11 +544,26 @@ Result App::init(const std::string& execPath)
         return -1;
     }
 
+    TIMELINE("update check");
     if (R_FAILED(res = Banks::init()))
         return consoleDisplayError("Banks::init failed.", res);
+    TIMELINE("Banks::init");
 
     Threads::create((ThreadFunc)TitleLoader::scanTitles);
     TitleLoader::scanSaves();
+    TIMELINE("TitleLoader::scanSaves");
+
+#if STARTUP_TIMELINE
+    if (FILE* out = fopen("/3ds/PKSM/startup.txt", "wt"))
+    {
+        for (size_t i = 1; i < timeline.size(); i++)
+        {
+            fprintf(out, "%-24s %6llu ms %6llu ms\n", timeline[i].first, timeline[i].second - timeline[i - 1].second,
+                timeline[i].second - timeline[0].second);
+        }
+        fclose(out);
+    }
+#endif
 
     randomNumbers.seed(osGetTime());
 
@@ -467,9 +578,11 @@ Result App::exit(void)
     svcCloseHandle(hbldrHandle);
     TitleLoader::exit();
     Gui::exit();
+    // Background downloads have to finish, and curl let go of its connections, while sockets are still up
+    Threads::destroy();
+    Fetch::exit();
     socExit();
     acExit();
-    Threads::destroy();
     i18n::exit();
     amExit();
     pxiDevExit();
@@ -134,8 +134,12 @@ void Banks::removeBank(const std::string& name)
         }
         remove(("/3ds/PKSM/banks/" + name + ".bnk").c_str());
         remove(("/3ds/PKSM/banks/" + name + ".json").c_str());
+        remove(("/3ds/PKSM/banks/" + name + ".bnk.jnl").c_str());
+        remove(("/3ds/PKSM/banks/" + name + ".bnk.tmp").c_str());
         Archive::deleteFile(Archive::data(), "/banks/" + name + ".bnk");
         Archive::deleteFile(Archive::data(), "/banks/" + name + ".json");
+        Archive::deleteFile(Archive::data(), "/banks/" + name + ".bnk.jnl");
+        Archive::deleteFile(Archive::data(), "/banks/" + name + ".bnk.tmp");
         for (auto i = g_banks.begin(); i != g_banks.end(); i++)
         {
             if (i.key() == name)
@@ -173,8 +177,12 @@ void Banks::renameBank(const std::string& oldName, const std::string& newName)
         {
             Archive::moveFile(Archive::data(), "/banks/" + oldName + ".bnk", Archive::data(), "/banks/" + newName + ".bnk");
             Archive::moveFile(Archive::data(), "/banks/" + oldName + ".json", Archive::data(), "/banks/" + newName + ".json");
+            Archive::moveFile(Archive::data(), "/banks/" + oldName + ".bnk.jnl", Archive::data(), "/banks/" + newName + ".bnk.jnl");
+            Archive::moveFile(Archive::data(), "/banks/" + oldName + ".bnk.tmp", Archive::data(), "/banks/" + newName + ".bnk.tmp");
             Archive::moveFile(Archive::sd(), "/3ds/PKSM/banks/" + oldName + ".bnk", Archive::sd(), "/3ds/PKSM/banks/" + newName + ".bnk");
             Archive::moveFile(Archive::sd(), "/3ds/PKSM/banks/" + oldName + ".json", Archive::sd(), "/3ds/PKSM/banks/" + newName + ".json");
+            Archive::moveFile(Archive::sd(), "/3ds/PKSM/banks/" + oldName + ".bnk.jnl", Archive::sd(), "/3ds/PKSM/banks/" + newName + ".bnk.jnl");
+            Archive::moveFile(Archive::sd(), "/3ds/PKSM/banks/" + oldName + ".bnk.tmp", Archive::sd(), "/3ds/PKSM/banks/" + newName + ".bnk.tmp");
         }
         g_banks[newName] = g_banks[oldName];
         g_banks.erase(oldName);
@@ -270,8 +270,10 @@ void SpeciesOverlay::update(touchPosition* touch)
                 pkm->species((u16)species);
                 pkm->alternativeForm(0);
                 pkm->setAbility(0);
+                // A new Pokemon has no PID yet, which would count as shiny for some trainer IDs
+                bool shiny = pkm->PID() != 0 && pkm->shiny();
                 pkm->PID(PKX::getRandomPID(pkm->species(), pkm->gender(), pkm->version(), pkm->nature(), pkm->alternativeForm(), pkm->abilityNumber(),
-                    pkm->PID(), pkm->generation()));
+                    shiny, pkm->TID(), pkm->SID(), pkm->generation()));
             }
             else
             {
@@ -268,14 +268,14 @@ void InjectSelectorScreen::drawTop() const
             else
             {
                 MysteryGift::giftData data;
-                const std::string& lang = i18n::langString(Configuration::getInstance().language());
-                if (wondercards[i].find(lang) != wondercards[i].end())
+                Language lang = Configuration::getInstance().language();
+                if (wondercards[i].has(lang))
                 {
-                    data = MysteryGift::wondercardInfo(wondercards[i][lang]);
+                    data = MysteryGift::wondercardInfo(wondercards[i].card(lang));
                 }
                 else
                 {
-                    data = MysteryGift::wondercardInfo(*wondercards[i].begin());
+                    data = MysteryGift::wondercardInfo(wondercards[i].card(wondercards[i].firstLanguage()));
                 }
                 int x = i % 2 == 0 ? 21 : 201;
                 int y = 43 + ((i % 10) / 2) * 37;
@@ -454,10 +454,11 @@ bool InjectSelectorScreen::toggleFilter(const std::string& lang)
 {
     if (langFilter != lang)
     {
-        wondercards = MysteryGift::wondercards();
+        wondercards       = MysteryGift::wondercards();
+        Language language = i18n::langFromString(lang);
         for (size_t i = wondercards.size(); i > 0; i--)
         {
-            if (!wondercards[i - 1].contains(lang))
+            if (!wondercards[i - 1].has(language))
             {
                 wondercards.erase(wondercards.begin() + i - 1);
             }
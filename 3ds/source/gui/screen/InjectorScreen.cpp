@@ -35,29 +35,26 @@ bool InjectorScreen::setLanguage(Language language)
     if (isLangAvailable(language))
     {
         lang       = language;
-        wondercard = MysteryGift::wondercard(ids[i18n::langString(lang)]);
+        wondercard = MysteryGift::wondercard(ids.card(lang));
 
         changeDate();
     }
     return false;
 }
 
-InjectorScreen::InjectorScreen(nlohmann::json ids)
+InjectorScreen::InjectorScreen(const MysteryGift::eventData& ids)
     : hid(40, 8), ids(ids), emptySlot(TitleLoader::save->emptyGiftLocation()), gifts(TitleLoader::save->currentGifts())
 {
-    const std::string& langString = i18n::langString(Configuration::getInstance().language());
-    if (ids.find(langString) != ids.end())
+    if (ids.has(Configuration::getInstance().language()))
     {
-        wondercard = MysteryGift::wondercard(ids[langString]);
-        game       = MysteryGift::wondercardInfo(ids[langString]).game;
-        lang       = Configuration::getInstance().language();
+        lang = Configuration::getInstance().language();
     }
     else
     {
-        wondercard = MysteryGift::wondercard(*ids.begin());
-        game       = MysteryGift::wondercardInfo(*ids.begin()).game;
-        lang       = i18n::langFromString(ids.begin().key());
+        lang = ids.firstLanguage();
     }
+    wondercard = MysteryGift::wondercard(ids.card(lang));
+    game       = MysteryGift::wondercardInfo(ids.card(lang)).game;
 
     slot          = emptySlot + 1;
     int langIndex = 1;
@@ -115,7 +112,7 @@ InjectorScreen::InjectorScreen(nlohmann::json ids)
 }
 
 InjectorScreen::InjectorScreen(std::unique_ptr<WCX> wcx)
-    : wondercard(std::move(wcx)), hid(40, 8), ids({}), emptySlot(TitleLoader::save->emptyGiftLocation()), gifts(TitleLoader::save->currentGifts())
+    : wondercard(std::move(wcx)), hid(40, 8), ids(), emptySlot(TitleLoader::save->emptyGiftLocation()), gifts(TitleLoader::save->currentGifts())
 {
     lang = Language::UNUSED;
 
@@ -539,7 +536,7 @@ void InjectorScreen::update(touchPosition* touch)
 
 bool InjectorScreen::isLangAvailable(Language l) const
 {
-    return ids.find(i18n::langString(l)) != ids.end();
+    return ids.has(l);
 }
 
 void InjectorScreen::changeDate()
@@ -345,6 +345,7 @@ void ScriptScreen::applyScript()
         {
             std::copy(scriptData.data() + index + 8, scriptData.data() + index + 8 + length, TitleLoader::save->rawData() + offset + i * length);
         }
+        TitleLoader::save->markDirty(offset, repeat * length);
 
         index += 12 + length;
     }
@@ -385,6 +386,8 @@ void ScriptScreen::parsePicoCScript(std::string& file)
         Gui::warn(i18n::localize("SCRIPTS_EXECUTION_ERROR"), file);
         Gui::setScreen(std::make_unique<ScrollingTextScreen>(error, nullptr));
     }
+    // The script had the raw save pointer, so there's no telling what it touched
+    TitleLoader::save->markDirty();
     if (Banks::bank->hasChanged())
     {
         Banks::bank->save();
@@ -30,6 +30,60 @@
 #include "gui.hpp"
 #include "loader.hpp"
 
+namespace
+{
+    PKXIndex::Column sortColumn(SortType type)
+    {
+        switch (type)
+        {
+            case DEX:
+                return PKXIndex::Column::SPECIES;
+            case FORM:
+                return PKXIndex::Column::FORM;
+            case TYPE1:
+                return PKXIndex::Column::TYPE1;
+            case TYPE2:
+                return PKXIndex::Column::TYPE2;
+            case HP:
+                return PKXIndex::statColumn(0);
+            case ATK:
+                return PKXIndex::statColumn(1);
+            case DEF:
+                return PKXIndex::statColumn(2);
+            case SATK:
+                return PKXIndex::statColumn(4);
+            case SDEF:
+                return PKXIndex::statColumn(5);
+            case SPE:
+                return PKXIndex::statColumn(3);
+            case HPIV:
+                return PKXIndex::ivColumn(0);
+            case ATKIV:
+                return PKXIndex::ivColumn(1);
+            case DEFIV:
+                return PKXIndex::ivColumn(2);
+            case SATKIV:
+                return PKXIndex::ivColumn(4);
+            case SDEFIV:
+                return PKXIndex::ivColumn(5);
+            case SPEIV:
+                return PKXIndex::ivColumn(3);
+            case NATURE:
+                return PKXIndex::Column::NATURE;
+            case LEVEL:
+                return PKXIndex::Column::LEVEL;
+            case TID:
+                return PKXIndex::Column::TID;
+            case HIDDENPOWER:
+                return PKXIndex::Column::HIDDENPOWER;
+            case FRIENDSHIP:
+                return PKXIndex::Column::FRIENDSHIP;
+            default:
+                return PKXIndex::Column::COLUMN_COUNT;
+        }
+    }
+}
+
 SortScreen::SortScreen(bool storage) : storage(storage)
 {
     for (int i = 0; i < 5; i++)
@@ -137,193 +191,65 @@ void SortScreen::sort()
         {
             sortTypes.push_back(DEX);
         }
-        std::vector<std::shared_ptr<PKX>> sortMe;
-        if (storage)
-        {
-            for (int i = 0; i < Banks::bank->boxes() * 30; i++)
-            {
-                std::shared_ptr<PKX> pkm = Banks::bank->pkm(i / 30, i % 30);
-                if (pkm->encryptionConstant() != 0 && pkm->species() != 0)
-                {
-                    sortMe.push_back(pkm);
-                }
-            }
-        }
-        else
-        {
-            for (int i = 0; i < TitleLoader::save->maxSlot(); i++)
-            {
-                std::shared_ptr<PKX> pkm = TitleLoader::save->pkm(i / 30, i % 30);
-                if (pkm->encryptionConstant() != 0 && pkm->species() != 0)
-                {
-                    sortMe.push_back(pkm);
-                }
-            }
-        }
-        std::stable_sort(sortMe.begin(), sortMe.end(), [this](const std::shared_ptr<PKX>& pkm1, const std::shared_ptr<PKX>& pkm2) {
+        const PKXIndex& index  = storage ? Banks::bank->index() : TitleLoader::save->index();
+        std::vector<u32> order = index.occupiedRows();
+        std::stable_sort(order.begin(), order.end(), [this, &index](u32 row1, u32 row2) {
             for (auto type : sortTypes)
             {
                 switch (type)
                 {
-                    case DEX:
-                        if (pkm1->species() < pkm2->species())
-                            return true;
-                        if (pkm2->species() < pkm1->species())
-                            return false;
-                        break;
-                    case FORM:
-                        if (pkm1->alternativeForm() < pkm2->alternativeForm())
-                            return true;
-                        if (pkm2->alternativeForm() < pkm1->alternativeForm())
-                            return false;
-                        break;
-                    case TYPE1:
-                        if (pkm1->type1() < pkm2->type1())
-                            return true;
-                        if (pkm2->type1() < pkm1->type1())
-                            return false;
-                        break;
-                    case TYPE2:
-                        if (pkm1->type2() < pkm2->type2())
-                            return true;
-                        if (pkm2->type2() < pkm1->type2())
-                            return false;
-                        break;
-                    case HP:
-                        if (pkm1->stat(0) < pkm2->stat(0))
-                            return true;
-                        if (pkm2->stat(0) < pkm1->stat(0))
-                            return false;
-                        break;
-                    case ATK:
-                        if (pkm1->stat(1) < pkm2->stat(1))
-                            return true;
-                        if (pkm2->stat(1) < pkm1->stat(1))
-                            return false;
-                        break;
-                    case DEF:
-                        if (pkm1->stat(2) < pkm2->stat(2))
-                            return true;
-                        if (pkm2->stat(2) < pkm1->stat(2))
-                            return false;
-                        break;
-                    case SATK:
-                        if (pkm1->stat(4) < pkm2->stat(4))
-                            return true;
-                        if (pkm2->stat(4) < pkm1->stat(4))
-                            return false;
-                        break;
-                    case SDEF:
-                        if (pkm1->stat(5) < pkm2->stat(5))
-                            return true;
-                        if (pkm2->stat(5) < pkm1->stat(5))
-                            return false;
-                        break;
-                    case SPE:
-                        if (pkm1->stat(3) < pkm2->stat(3))
-                            return true;
-                        if (pkm2->stat(3) < pkm1->stat(3))
-                            return false;
-                        break;
-                    case NATURE:
-                        if (pkm1->nature() < pkm2->nature())
-                            return true;
-                        if (pkm2->nature() < pkm1->nature())
-                            return false;
-                        break;
-                    case LEVEL:
-                        if (pkm1->level() < pkm2->level())
-                            return true;
-                        if (pkm2->level() < pkm1->level())
-                            return false;
-                        break;
-                    case TID:
-                        if (pkm1->TID() < pkm2->TID())
-                            return true;
-                        if (pkm2->TID() < pkm1->TID())
-                            return false;
-                        break;
-                    case HPIV:
-                        if (pkm1->iv(0) < pkm2->iv(0))
-                            return true;
-                        if (pkm2->iv(0) < pkm1->iv(0))
-                            return false;
-                        break;
-                    case ATKIV:
-                        if (pkm1->iv(1) < pkm2->iv(1))
-                            return true;
-                        if (pkm2->iv(1) < pkm1->iv(1))
-                            return false;
-                        break;
-                    case DEFIV:
-                        if (pkm1->iv(2) < pkm2->iv(2))
-                            return true;
-                        if (pkm2->iv(2) < pkm1->iv(2))
-                            return false;
-                        break;
-                    case SATKIV:
-                        if (pkm1->iv(4) < pkm2->iv(4))
-                            return true;
-                        if (pkm2->iv(4) < pkm1->iv(4))
-                            return false;
-                        break;
-                    case SDEFIV:
-                        if (pkm1->iv(5) < pkm2->iv(5))
-                            return true;
-                        if (pkm2->iv(5) < pkm1->iv(5))
-                            return false;
-                        break;
-                    case SPEIV:
-                        if (pkm1->iv(3) < pkm2->iv(3))
-                            return true;
-                        if (pkm2->iv(3) < pkm1->iv(3))
-                            return false;
-                        break;
-                    case HIDDENPOWER:
-                        if (pkm1->hpType() < pkm2->hpType())
-                            return true;
-                        if (pkm2->hpType() < pkm1->hpType())
-                            return false;
-                        break;
-                    case FRIENDSHIP:
-                        if (pkm1->currentFriendship() < pkm2->currentFriendship())
-                            return true;
-                        if (pkm2->currentFriendship() < pkm1->currentFriendship())
-                            return false;
-                        break;
                     case NICKNAME:
-                        if (pkm1->nickname() < pkm2->nickname())
+                        if (index.nickname(row1) < index.nickname(row2))
                             return true;
-                        if (pkm2->nickname() < pkm1->nickname())
+                        if (index.nickname(row2) < index.nickname(row1))
                             return false;
                         break;
                     case SPECIESNAME:
-                        if (i18n::species(Configuration::getInstance().language(), pkm1->species()) <
-                            i18n::species(Configuration::getInstance().language(), pkm2->species()))
+                    {
+                        u16 species1 = index.value(PKXIndex::Column::SPECIES, row1);
+                        u16 species2 = index.value(PKXIndex::Column::SPECIES, row2);
+                        if (i18n::species(Configuration::getInstance().language(), species1) <
+                            i18n::species(Configuration::getInstance().language(), species2))
                             return true;
-                        if (i18n::species(Configuration::getInstance().language(), pkm2->species()) <
-                            i18n::species(Configuration::getInstance().language(), pkm1->species()))
+                        if (i18n::species(Configuration::getInstance().language(), species2) <
+                            i18n::species(Configuration::getInstance().language(), species1))
                             return false;
                         break;
+                    }
                     case OTNAME:
-                        if (pkm1->otName() < pkm2->otName())
+                        if (index.otName(row1) < index.otName(row2))
                             return true;
-                        if (pkm2->otName() < pkm1->otName())
+                        if (index.otName(row2) < index.otName(row1))
                             return false;
                         break;
                     case SHINY:
-                        if (pkm1->shiny() && !pkm2->shiny())
+                        if (index.value(PKXIndex::Column::SHINY, row1) > index.value(PKXIndex::Column::SHINY, row2))
                             return true;
-                        if (pkm2->shiny() && !pkm1->shiny())
+                        if (index.value(PKXIndex::Column::SHINY, row2) > index.value(PKXIndex::Column::SHINY, row1))
                             return false;
                         break;
                     default:
+                    {
+                        PKXIndex::Column column = sortColumn(type);
+                        if (column == PKXIndex::Column::COLUMN_COUNT)
+                            break;
+                        if (index.value(column, row1) < index.value(column, row2))
+                            return true;
+                        if (index.value(column, row2) < index.value(column, row1))
+                            return false;
                         break;
+                    }
                 }
             }
             return false;
         });
 
+        std::vector<std::shared_ptr<PKX>> sortMe;
+        for (u32 row : order)
+        {
+            sortMe.push_back(storage ? Banks::bank->pkm(row / 30, row % 30) : TitleLoader::save->pkm(row / 30, row % 30));
+        }
+
         if (storage)
         {
             for (size_t i = 0; i < sortMe.size(); i++)
@@ -34,6 +34,7 @@
 #include "FSStream.hpp"
 #include "MainMenu.hpp"
 #include "PK4.hpp"
+#include "PKXView.hpp"
 #include "QRScanner.hpp"
 #include "SavLGPE.hpp"
 #include "SortOverlay.hpp"
@@ -210,6 +211,16 @@ StorageScreen::~StorageScreen()
     TitleLoader::save->currentBox((u8)boxBox);
 }
 
+const CompiledPKFilter& StorageScreen::compiled() const
+{
+    if (!compiledFilter || (filterMayChange && !overlay))
+    {
+        compiledFilter  = std::make_unique<CompiledPKFilter>(*filter);
+        filterMayChange = overlay != nullptr;
+    }
+    return *compiledFilter;
+}
+
 void StorageScreen::drawBottom() const
 {
     Gui::sprite(ui_sheet_emulated_bg_bottom_green, 0, 0);
@@ -236,6 +247,8 @@ void StorageScreen::drawBottom() const
         }
     }
 
+    const u32 matches = TitleLoader::save->filterBox(compiled(), boxBox);
+
     u16 y = 45;
     for (u8 row = 0; row < 5; row++)
     {
@@ -254,10 +267,10 @@ void StorageScreen::drawBottom() const
             }
             else
             {
-                std::shared_ptr<PKX> pokemon = TitleLoader::save->pkm(boxBox, row * 6 + column);
+                PKXView pokemon = TitleLoader::save->slotView(boxBox, row * 6 + column);
                 if (pokemon->species() > 0)
                 {
-                    float blend = *pokemon == *filter ? 0.0f : 0.5f;
+                    float blend = (matches >> (row * 6 + column)) & 1 ? 0.0f : 0.5f;
                     Gui::pkm(*pokemon, x, y, 1.0f, COLOR_BLACK, blend);
                 }
                 if (TitleLoader::save->generation() == Generation::LGPE)
@@ -366,6 +379,8 @@ void StorageScreen::drawTop() const
     Gui::sprite(ui_sheet_storagemenu_cross_idx, 36, 220);
     Gui::sprite(ui_sheet_storagemenu_cross_idx, 246, 220);
 
+    const u32 matches = Banks::bank->filterBox(compiled(), storageBox);
+
     int y = 66;
     for (u8 row = 0; row < 5; row++)
     {
@@ -379,10 +394,10 @@ void StorageScreen::drawTop() const
             {
                 Gui::drawSolidRect(x, y, 34, 30, C2D_Color32(0x50, 0xC0, 0x40, 0xC0));
             }
-            auto pkm = Banks::bank->pkm(storageBox, row * 6 + column);
-            if (pkm->species() > 0)
+            PKXView pkm = Banks::bank->slotView(storageBox, row * 6 + column);
+            if (pkm && pkm->species() > 0)
             {
-                float blend = *pkm == *filter ? 0.0f : 0.5f;
+                float blend = (matches >> (row * 6 + column)) & 1 ? 0.0f : 0.5f;
                 Gui::pkm(*pkm, x, y, 1.0f, COLOR_BLACK, blend);
             }
             x += 34;
@@ -585,7 +600,8 @@ void StorageScreen::update(touchPosition* touch)
     else if (kDown & KEY_START)
     {
         addOverlay<StorageOverlay>(storageChosen, boxBox, storageBox, filter);
-        justSwitched = true;
+        justSwitched    = true;
+        filterMayChange = true;
     }
     else if (kDown & KEY_X)
     {
@@ -933,31 +949,32 @@ bool StorageScreen::releasePkm()
 
 bool StorageScreen::isValidTransfer(std::shared_ptr<PKX> moveMon, bool bulkTransfer)
 {
-    if (!moveMon)
-    {
-        return false;
-    }
+    return moveMon && isValidTransfer(*moveMon, bulkTransfer);
+}
+
+bool StorageScreen::isValidTransfer(const PKX& moveMon, bool bulkTransfer)
+{
     bool moveBad = false;
     for (int i = 0; i < 4; i++)
     {
-        if (moveMon->move(i) > TitleLoader::save->maxMove())
+        if (moveMon.move(i) > TitleLoader::save->maxMove())
         {
             moveBad = true;
             break;
         }
-        if (moveMon->generation() == Generation::SIX)
+        if (moveMon.generation() == Generation::SIX)
         {
-            PK6* pk6 = (PK6*)moveMon.get();
-            if (pk6->relearnMove(i) > TitleLoader::save->maxMove())
+            const PK6& pk6 = (const PK6&)moveMon;
+            if (pk6.relearnMove(i) > TitleLoader::save->maxMove())
             {
                 moveBad = true;
                 break;
             }
         }
-        else if (moveMon->generation() == Generation::SEVEN)
+        else if (moveMon.generation() == Generation::SEVEN)
         {
-            PK7* pk7 = (PK7*)moveMon.get();
-            if (pk7->relearnMove(i) > TitleLoader::save->maxMove())
+            const PK7& pk7 = (const PK7&)moveMon;
+            if (pk7.relearnMove(i) > TitleLoader::save->maxMove())
             {
                 moveBad = true;
                 break;
@@ -970,32 +987,32 @@ bool StorageScreen::isValidTransfer(std::shared_ptr<PKX> moveMon, bool bulkTrans
             Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_MOVE"));
         return false;
     }
-    else if (moveMon->species() > TitleLoader::save->maxSpecies())
+    else if (moveMon.species() > TitleLoader::save->maxSpecies())
     {
         if (!bulkTransfer)
             Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_SPECIES"));
         return false;
     }
-    else if (moveMon->alternativeForm() > TitleLoader::save->formCount(moveMon->species()) &&
-             !((moveMon->species() == 664 || moveMon->species() == 665) && moveMon->alternativeForm() <= TitleLoader::save->formCount(666)))
+    else if (moveMon.alternativeForm() > TitleLoader::save->formCount(moveMon.species()) &&
+             !((moveMon.species() == 664 || moveMon.species() == 665) && moveMon.alternativeForm() <= TitleLoader::save->formCount(666)))
     {
         if (!bulkTransfer)
             Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_FORM"));
         return false;
     }
-    else if (moveMon->ability() > TitleLoader::save->maxAbility())
+    else if (moveMon.ability() > TitleLoader::save->maxAbility())
     {
         if (!bulkTransfer)
             Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_ABILITY"));
         return false;
     }
-    else if (moveMon->heldItem() > TitleLoader::save->maxItem())
+    else if (moveMon.heldItem() > TitleLoader::save->maxItem())
     {
         if (!bulkTransfer)
             Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_ITEM"));
         return false;
     }
-    else if (moveMon->ball() > TitleLoader::save->maxBall())
+    else if (moveMon.ball() > TitleLoader::save->maxBall())
     {
         if (!bulkTransfer)
             Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_BALL"));
@@ -1129,6 +1146,11 @@ void StorageScreen::pickup()
                     std::shared_ptr<PKX> temPkm = TitleLoader::save->pkm(boxBox, cursorIndex - 1 + x + y * 6);
                     if (moveMon[index]->generation() == TitleLoader::save->generation() || acceptGenChange)
                     {
+                        // Stays in hand if there's no way to convert it
+                        if (!TitleLoader::save->transfer(moveMon[index]))
+                        {
+                            continue;
+                        }
                         TitleLoader::save->pkm(
                             moveMon[index], boxBox, cursorIndex - 1 + x + y * 6, Configuration::getInstance().transferEdit() && fromStorage);
                         TitleLoader::save->dex(moveMon[index]);
@@ -1192,6 +1214,11 @@ void StorageScreen::pickup()
                 if ((Configuration::getInstance().transferEdit() || bankMon->generation() == TitleLoader::save->generation()) ||
                     Gui::showChoiceMessage(i18n::localize("GEN_CHANGE_1"), i18n::localize("GEN_CHANGE_2")))
                 {
+                    if (!TitleLoader::save->transfer(bankMon))
+                    {
+                        Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"));
+                        return;
+                    }
                     if (storageChosen)
                     {
                         if (partyNum[0] != -1)
@@ -1336,39 +1363,40 @@ bool StorageScreen::swapBoxWithStorage()
 {
     std::vector<int> notGenMatch;
     bool acceptGenChange = Configuration::getInstance().transferEdit();
-    bool checkedWithUser = Configuration::getInstance().transferEdit();
-    for (int i = 0; i < 30; i++)
+    for (int i = 0; !acceptGenChange && i < 30; i++)
     {
-        if (boxBox * 30 + i >= TitleLoader::save->maxSlot())
+        PKXView bankMon = Banks::bank->slotView(storageBox, i);
+        if (bankMon && !(bankMon->encryptionConstant() == 0 && bankMon->species() == 0) && bankMon->generation() != TitleLoader::save->generation())
         {
+            acceptGenChange = Gui::showChoiceMessage(i18n::localize("GEN_CHANGE_1"), i18n::localize("GEN_CHANGE_2"));
             break;
         }
-        std::shared_ptr<PKX> temPkm = Banks::bank->pkm(storageBox, i);
-        if ((temPkm->encryptionConstant() == 0 && temPkm->species() == 0))
-        {
-            temPkm = TitleLoader::save->emptyPkm();
-        }
-        if (!checkedWithUser && temPkm->generation() != TitleLoader::save->generation())
+    }
+
+    std::vector<int> moved;
+    Banks::bank->transferBoxes(*TitleLoader::save, storageBox, boxBox, 1, [&](int index, const PKX& from, const PKX& to) {
+        if (!acceptGenChange && from.generation() != TitleLoader::save->generation())
         {
-            checkedWithUser = true;
-            acceptGenChange = Gui::showChoiceMessage(i18n::localize("GEN_CHANGE_1"), i18n::localize("GEN_CHANGE_2"));
+            notGenMatch.push_back(index + 1);
+            return false;
         }
-        if (acceptGenChange || temPkm->generation() == TitleLoader::save->generation())
+        if (!isValidTransfer(to, true))
         {
-            TitleLoader::save->transfer(temPkm);
-            if (isValidTransfer(temPkm, true))
-            {
-                auto otherTemPkm = TitleLoader::save->pkm(boxBox, i);
-                TitleLoader::save->pkm(temPkm, boxBox, i, Configuration::getInstance().transferEdit());
-                TitleLoader::save->dex(temPkm);
-                Banks::bank->pkm(otherTemPkm, storageBox, i);
-            }
+            return false;
         }
-        else
+        moved.push_back(index);
+        return true;
+    });
+    for (int i : moved)
+    {
+        std::shared_ptr<PKX> temPkm = TitleLoader::save->pkm(boxBox, i);
+        if (Configuration::getInstance().transferEdit())
         {
-            notGenMatch.push_back(i + 1);
+            TitleLoader::save->pkm(temPkm, boxBox, i, true);
         }
+        TitleLoader::save->dex(temPkm);
     }
+
     if (!notGenMatch.empty())
     {
         std::string unswapped;
@@ -1564,7 +1592,11 @@ void StorageScreen::grabSelection(bool remove)
 
 static bool transferFine(std::shared_ptr<PKX>& pkm)
 {
-    TitleLoader::save->transfer(pkm);
+    if (!TitleLoader::save->transfer(pkm))
+    {
+        Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"));
+        return false;
+    }
     for (int i = 0; i < 4; i++)
     {
         if (pkm->move(i) > TitleLoader::save->maxMove())
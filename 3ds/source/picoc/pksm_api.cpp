@@ -300,7 +300,11 @@ void sav_inject_pkx(struct ParseState* Parser, struct Value* ReturnValue, struct
         }
         else
         {
-            TitleLoader::save->transfer(pkm);
+            if (!TitleLoader::save->transfer(pkm))
+            {
+                Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"));
+                return;
+            }
             bool moveBad = false;
             for (int i = 0; i < 4; i++)
             {
@@ -747,7 +751,11 @@ void party_inject_pkx(struct ParseState* Parser, struct Value* ReturnValue, stru
         }
         else
         {
-            TitleLoader::save->transfer(pkm);
+            if (!TitleLoader::save->transfer(pkm))
+            {
+                Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"));
+                return;
+            }
             bool moveBad = false;
             for (int i = 0; i < 4; i++)
             {
@@ -855,37 +863,28 @@ void pkx_party_size(struct ParseState* Parser, struct Value* ReturnValue, struct
     }
 }
 
-void pkx_generate(struct ParseState* Parser, struct Value* ReturnValue, struct Value** Param, int NumArgs)
+// A Pokemon of the loaded save's generation that reads and writes data directly
+static std::unique_ptr<PKX> generatedView(u8* data)
 {
-    u8* data                 = (u8*)Param[0]->Val->Pointer;
-    int species              = Param[1]->Val->Integer;
-    std::unique_ptr<PKX> pkm = nullptr;
     switch (TitleLoader::save->generation())
     {
         case Generation::FOUR:
-            std::fill_n(data, 136, 0);
-            pkm = std::make_unique<PK4>(data, false, false, true);
-            break;
+            return std::make_unique<PK4>(data, false, false, true);
         case Generation::FIVE:
-            std::fill_n(data, 136, 0);
-            pkm = std::make_unique<PK5>(data, false, false, true);
-            break;
+            return std::make_unique<PK5>(data, false, false, true);
         case Generation::SIX:
-            std::fill_n(data, 232, 0);
-            pkm = std::make_unique<PK6>(data, false, false, true);
-            break;
+            return std::make_unique<PK6>(data, false, false, true);
         case Generation::SEVEN:
-            std::fill_n(data, 232, 0);
-            pkm = std::make_unique<PK7>(data, false, false, true);
-            break;
+            return std::make_unique<PK7>(data, false, false, true);
         case Generation::LGPE:
         default:
-            pkm = std::make_unique<PB7>(data, false, true);
-            std::fill_n(data, 260, 0);
-            break;
+            return std::make_unique<PB7>(data, false, true);
     }
+}
 
-    // From EditorScreen
+// Everything in a generated Pokemon that doesn't depend on its species
+static void generateCommon(PKX* pkm)
+{
     if (Configuration::getInstance().useSaveInfo())
     {
         pkm->TID(TitleLoader::save->TID());
@@ -910,7 +909,6 @@ void pkx_generate(struct ParseState* Parser, struct Value* ReturnValue, struct V
         }
     }
     pkm->ball(4);
-    pkm->encryptionConstant((((u32)randomNumbers()) % 0xFFFFFFFF) + 1);
     pkm->version(TitleLoader::save->version());
     switch (pkm->version())
     {
@@ -958,28 +956,71 @@ void pkx_generate(struct ParseState* Parser, struct Value* ReturnValue, struct V
     pkm->metLevel(1);
     if (pkm->generation() == Generation::SIX)
     {
-        ((PK6*)pkm.get())->consoleRegion(Configuration::getInstance().nationality());
-        ((PK6*)pkm.get())->geoCountry(0, Configuration::getInstance().defaultCountry());
-        ((PK6*)pkm.get())->geoRegion(0, Configuration::getInstance().defaultRegion());
-        ((PK6*)pkm.get())->country(Configuration::getInstance().defaultCountry());
-        ((PK6*)pkm.get())->region(Configuration::getInstance().defaultRegion());
+        ((PK6*)pkm)->consoleRegion(Configuration::getInstance().nationality());
+        ((PK6*)pkm)->geoCountry(0, Configuration::getInstance().defaultCountry());
+        ((PK6*)pkm)->geoRegion(0, Configuration::getInstance().defaultRegion());
+        ((PK6*)pkm)->country(Configuration::getInstance().defaultCountry());
+        ((PK6*)pkm)->region(Configuration::getInstance().defaultRegion());
     }
     else if (pkm->generation() == Generation::SEVEN)
     {
-        ((PK7*)pkm.get())->consoleRegion(Configuration::getInstance().nationality());
-        ((PK7*)pkm.get())->geoCountry(0, Configuration::getInstance().defaultCountry());
-        ((PK7*)pkm.get())->geoRegion(0, Configuration::getInstance().defaultRegion());
-        ((PK7*)pkm.get())->country(Configuration::getInstance().defaultCountry());
-        ((PK7*)pkm.get())->region(Configuration::getInstance().defaultRegion());
+        ((PK7*)pkm)->consoleRegion(Configuration::getInstance().nationality());
+        ((PK7*)pkm)->geoCountry(0, Configuration::getInstance().defaultCountry());
+        ((PK7*)pkm)->geoRegion(0, Configuration::getInstance().defaultRegion());
+        ((PK7*)pkm)->country(Configuration::getInstance().defaultCountry());
+        ((PK7*)pkm)->region(Configuration::getInstance().defaultRegion());
     }
+}
 
-    // From SpeciesOverlay
+// The rest, which pkx_generate_batch has to do for each Pokemon
+static void generateSpecies(PKX* pkm, int species)
+{
+    pkm->encryptionConstant((((u32)randomNumbers()) % 0xFFFFFFFF) + 1);
     pkm->nickname(i18n::species(Configuration::getInstance().language(), species));
     pkm->species((u16)species);
     pkm->alternativeForm(0);
     pkm->setAbility(0);
-    pkm->PID(PKX::getRandomPID(
-        pkm->species(), pkm->gender(), pkm->version(), pkm->nature(), pkm->alternativeForm(), pkm->abilityNumber(), pkm->PID(), pkm->generation()));
+    // The data starts out zeroed, and a PID of 0 would count as shiny for some trainer IDs
+    pkm->PID(PKX::getRandomPID(pkm->species(), pkm->gender(), pkm->version(), pkm->nature(), pkm->alternativeForm(), pkm->abilityNumber(),
+        false, pkm->TID(), pkm->SID(), pkm->generation()));
+}
+
+void pkx_generate(struct ParseState* Parser, struct Value* ReturnValue, struct Value** Param, int NumArgs)
+{
+    u8* data                 = (u8*)Param[0]->Val->Pointer;
+    int species              = Param[1]->Val->Integer;
+    std::unique_ptr<PKX> pkm = generatedView(data);
+    std::fill_n(data, pkm->getLength(), 0);
+
+    // From EditorScreen
+    generateCommon(pkm.get());
+    // From SpeciesOverlay
+    generateSpecies(pkm.get(), species);
+}
+
+// Generates count Pokemon back to back in data, one for each entry of species. The parts they share are only made once and copied
+void pkx_generate_batch(struct ParseState* Parser, struct Value* ReturnValue, struct Value** Param, int NumArgs)
+{
+    u8* data     = (u8*)Param[0]->Val->Pointer;
+    int* species = (int*)Param[1]->Val->Pointer;
+    int count    = Param[2]->Val->Integer;
+    if (count <= 0)
+    {
+        return;
+    }
+
+    std::unique_ptr<PKX> pkm = generatedView(data);
+    const size_t size        = pkm->getLength();
+    std::fill_n(data, size, 0);
+    generateCommon(pkm.get());
+    for (int i = 1; i < count; i++)
+    {
+        std::copy(data, data + size, data + i * size);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        generateSpecies(generatedView(data + i * size).get(), species[i]);
+    }
 }
 
 void sav_get_max(struct ParseState* Parser, struct Value* ReturnValue, struct Value** Param, int NumArgs)
@@ -25,13 +25,13 @@
  */
 
 #include "loader.hpp"
+#include "BackupStore.hpp"
 #include "Configuration.hpp"
 #include "Directory.hpp"
 #include "FSStream.hpp"
-#include <ctime>
-#include <sys/stat.h>
 
 static std::unordered_map<std::u16string, std::shared_ptr<Directory>> directories;
+static BackupStore backupStore("/3ds/PKSM/backups/store");
 
 static constexpr char langIds[8] = {
     'E', // USA
@@ -267,6 +267,8 @@ void TitleLoader::scanSaves(void)
         {
             std::vector<std::string> moreSaves = scanDirectoryFor(u"/3ds/PKSM/backups", id);
             saves.insert(saves.end(), moreSaves.begin(), moreSaves.end());
+            moreSaves = backupStore.backups(id);
+            saves.insert(saves.end(), moreSaves.begin(), moreSaves.end());
         }
         auto extraSaves = Configuration::getInstance().extraSaves(id);
         if (!extraSaves.empty())
@@ -292,6 +294,8 @@ void TitleLoader::scanSaves(void)
             {
                 std::vector<std::string> moreSaves = scanDirectoryFor(u"/3ds/PKSM/backups", id);
                 saves.insert(saves.end(), moreSaves.begin(), moreSaves.end());
+                moreSaves = backupStore.backups(id);
+                saves.insert(saves.end(), moreSaves.begin(), moreSaves.end());
             }
             auto extraSaves = Configuration::getInstance().extraSaves(id);
             if (!extraSaves.empty())
@@ -316,19 +320,10 @@ void TitleLoader::backupSave(const std::string& id)
         return;
     }
     Gui::waitFrame(i18n::localize("LOADER_BACKING_UP"));
-    char stringTime[15]   = {0};
-    time_t unixTime       = time(NULL);
-    struct tm* timeStruct = gmtime((const time_t*)&unixTime);
-    std::strftime(stringTime, 14, "%Y%m%d%H%M%S", timeStruct);
-    std::string path = "/3ds/PKSM/backups/" + id;
-    mkdir(path.c_str(), 777);
-    path += '/' + std::string(stringTime) + '/';
-    mkdir(path.c_str(), 777);
-    path += idToSaveName(id);
-    FSStream out = FSStream(Archive::sd(), path, FS_OPEN_WRITE | FS_OPEN_CREATE, TitleLoader::save->getLength());
-    if (out.good())
+    // Only the blocks that changed since the last backup take up room
+    std::string path = backupStore.backup(id, idToSaveName(id), save->rawData(), save->getLength(), save->blocks());
+    if (!path.empty())
     {
-        out.write(TitleLoader::save->rawData(), TitleLoader::save->getLength());
         if (Configuration::getInstance().showBackups())
         {
             sdSaves[id].emplace_back(path);
@@ -338,12 +333,11 @@ void TitleLoader::backupSave(const std::string& id)
     {
         Gui::warn(i18n::localize("BAD_OPEN_BACKUP"));
     }
-    out.close();
 }
 
-bool TitleLoader::load(u8* data, size_t size)
+bool TitleLoader::load(std::unique_ptr<u8[]> data, size_t size)
 {
-    save = Sav::getSave(data, size);
+    save = Sav::getSave(std::move(data), size);
     return save != nullptr;
 }
 
@@ -358,11 +352,11 @@ bool TitleLoader::load(std::shared_ptr<Title> title)
         FSStream in(archive, u"/main", FS_OPEN_READ);
         if (in.good())
         {
-            u8* data = new u8[in.size()];
-            in.read(data, in.size());
-            save = Sav::getSave(data, in.size());
+            u32 size = in.size();
+            std::unique_ptr<u8[]> data(new u8[size]);
+            in.read(data.get(), size);
             in.close();
-            delete[] data;
+            save = Sav::getSave(std::move(data), size);
             FSUSER_CloseArchive(archive);
             if (Configuration::getInstance().autoBackup())
             {
@@ -388,16 +382,15 @@ bool TitleLoader::load(std::shared_ptr<Title> title)
             return false;
         }
 
-        u8* data       = new u8[cap];
+        std::unique_ptr<u8[]> data(new u8[cap]);
         u32 sectorSize = (cap < 0x10000) ? cap : 0x10000;
 
         for (u32 i = 0; i < cap / sectorSize; ++i)
         {
-            SPIReadSaveData(title->SPICardType(), sectorSize * i, data + sectorSize * i, sectorSize);
+            SPIReadSaveData(title->SPICardType(), sectorSize * i, data.get() + sectorSize * i, sectorSize);
         }
 
-        save = Sav::getSave(data, cap);
-        delete[] data;
+        save = Sav::getSave(std::move(data), cap);
         if (Configuration::getInstance().autoBackup())
         {
             backupSave(title->checkpointPrefix());
@@ -413,26 +406,44 @@ bool TitleLoader::load(std::shared_ptr<Title> title, const std::string& savePath
     saveIsFile   = true;
     saveFileName = savePath;
     loadedTitle  = title;
-    FSStream in(Archive::sd(), StringUtils::UTF8toUTF16(savePath), FS_OPEN_READ);
     u32 size;
-    u8* saveData = nullptr;
-    if (in.good())
+    std::unique_ptr<u8[]> saveData = nullptr;
+    // Stored backups are put back together in memory, and saveChanges stores edits to one as a new backup of the same id
+    bool stored = BackupStore::isManifest(savePath);
+    if (stored)
     {
-        size     = in.size();
-        saveData = new u8[size];
-        in.read(saveData, size);
+        std::vector<u8> data;
+        if (!backupStore.restore(savePath, data))
+        {
+            Gui::warn(savePath, i18n::localize("SAVE_INVALID"));
+            loadedTitle  = nullptr;
+            saveFileName = "";
+            return false;
+        }
+        size = data.size();
+        saveData.reset(new u8[size]);
+        std::copy(data.begin(), data.end(), saveData.get());
     }
     else
     {
-        Gui::error(i18n::localize("BAD_OPEN_SAVE"), in.result());
-        loadedTitle  = nullptr;
-        saveFileName = "";
+        FSStream in(Archive::sd(), StringUtils::UTF8toUTF16(saveFileName), FS_OPEN_READ);
+        if (in.good())
+        {
+            size = in.size();
+            saveData.reset(new u8[size]);
+            in.read(saveData.get(), size);
+        }
+        else
+        {
+            Gui::error(i18n::localize("BAD_OPEN_SAVE"), in.result());
+            loadedTitle  = nullptr;
+            saveFileName = "";
+            in.close();
+            return false;
+        }
         in.close();
-        return false;
     }
-    in.close();
-    save = Sav::getSave(saveData, size);
-    delete[] saveData;
+    save = Sav::getSave(std::move(saveData), size);
     if (!save)
     {
         Gui::warn(saveFileName, i18n::localize("SAVE_INVALID"));
@@ -440,7 +451,8 @@ bool TitleLoader::load(std::shared_ptr<Title> title, const std::string& savePath
         loadedTitle  = nullptr;
         return false;
     }
-    if (Configuration::getInstance().autoBackup())
+    // A stored backup is in the store already
+    if (!stored && Configuration::getInstance().autoBackup())
     {
         if (title)
         {
@@ -553,10 +565,17 @@ void TitleLoader::saveChanges()
     save->resign();
     if (saveIsFile)
     {
-        // No need to check size; if it was read successfully, that means that it has the correct size
-        FSStream out(Archive::sd(), StringUtils::UTF8toUTF16(saveFileName), FS_OPEN_WRITE);
-        out.write(save->rawData(), save->getLength());
-        out.close();
+        if (BackupStore::isManifest(saveFileName))
+        {
+            backupSave(BackupStore::idOf(saveFileName));
+        }
+        else
+        {
+            // No need to check size; if it was read successfully, that means that it has the correct size
+            FSStream out(Archive::sd(), StringUtils::UTF8toUTF16(saveFileName), FS_OPEN_WRITE);
+            out.write(save->rawData(), save->getLength());
+            out.close();
+        }
         if (Configuration::getInstance().writeFileSave())
         {
             saveToTitle(true);
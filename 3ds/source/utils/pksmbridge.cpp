@@ -65,7 +65,7 @@ bool receiveSaveFromBridge(void)
     lastIPAddr = servaddr.sin_addr;
 
     size_t size = 0x100000;
-    char* data  = new char[size];
+    std::unique_ptr<u8[]> data(new u8[size]);
 
     size_t total = 0;
     size_t chunk = 1024;
@@ -73,7 +73,7 @@ bool receiveSaveFromBridge(void)
     while (total < size)
     {
         size_t torecv = size - total > chunk ? chunk : size - total;
-        n             = recv(fdconn, data + total, torecv, 0);
+        n             = recv(fdconn, data.get() + total, torecv, 0);
         total += n;
         if (n <= 0)
         {
@@ -87,7 +87,7 @@ bool receiveSaveFromBridge(void)
 
     if (n == 0 || total == size)
     {
-        if (TitleLoader::load((u8*)data, total))
+        if (TitleLoader::load(std::move(data), total))
         {
             saveFromBridge = true;
             Gui::setScreen(std::make_unique<MainMenu>());
@@ -98,7 +98,6 @@ bool receiveSaveFromBridge(void)
         Gui::error(i18n::localize("DATA_RECEIVE_FAIL"), errno);
     }
 
-    delete[] data;
     return true;
 }
 
@@ -28,11 +28,21 @@
 
 static std::vector<Thread> threads;
 
-void Threads::create(ThreadFunc entrypoint, void* arg)
+void Threads::create(ThreadFunc entrypoint, void* arg, size_t stackSize)
 {
+    // Free the threads that are already done, so that short-lived ones don't hold on to their stacks until exit
+    for (size_t i = threads.size(); i > 0; i--)
+    {
+        if (threadJoin(threads[i - 1], 0) == 0)
+        {
+            threadFree(threads[i - 1]);
+            threads.erase(threads.begin() + i - 1);
+        }
+    }
+
     s32 prio = 0;
     svcGetThreadPriority(&prio, CUR_THREAD_HANDLE);
-    Thread thread = threadCreate((ThreadFunc)entrypoint, arg, 4 * 1024, prio - 1, -2, false);
+    Thread thread = threadCreate((ThreadFunc)entrypoint, arg, stackSize, prio - 1, -2, false);
     threads.push_back(thread);
 }
 
@@ -1,7 +1,6 @@
 #!/usr/bin/python3
 import git
 import os
-import json
 import struct
 import bz2
 import gen4string
@@ -15,6 +14,60 @@ def getWC4(data):
 def sortById(thing):
 	return thing['id']
 
+# Languages in the order of PKSM's Language enum, starting from JP
+eventLangs = ["JPN", "ENG", "FRE", "ITA", "GER", "", "SPA", "KOR", "CHS", "CHT"]
+chunkSize = 16 * 1024
+noCard = 0xFFFF
+
+# Writes the event database MysteryGift reads: every wondercard gets a fixed size record and lives in a bz2 compressed chunk of
+# at most chunkSize bytes, so that listing events and fetching a single card only decompress what they need.
+# Layout, all little endian, with -1 meaning none for species, form and gender:
+#   char magic[8] = "PKSMMGDB"
+#   u32 version
+#   u32 cardCount, eventCount, chunkCount, stringsSize
+#   struct { u32 name; u32 game; u16 chunk; u16 offset; u16 size; u8 type; u8 lang; s16 species; s8 form; s8 gender; } cards[cardCount]
+#   struct { u16 id; s16 species; s8 form; s8 gender; u16 cards[10]; } events[eventCount], cards indexed by language
+#   struct { u32 offset; u32 size; u32 rawSize; } chunks[chunkCount], offsets from the start of the file
+#   char strings[stringsSize], NUL terminated; card names and games are offsets into it
+#   the compressed chunks
+def packEvents(sheet, data):
+	strings = b''
+	stringOffsets = {}
+	def string(value):
+		nonlocal strings
+		if value not in stringOffsets:
+			stringOffsets[value] = len(strings)
+			strings += value.encode('utf-8') + b'\0'
+		return stringOffsets[value]
+
+	cards = b''
+	chunks = []
+	raw = b''
+	for entry in sheet['wondercards']:
+		card = data[entry['offset']:entry['offset'] + entry['size']]
+		if len(raw) + len(card) > chunkSize and len(raw) > 0:
+			chunks.append(raw)
+			raw = b''
+		cards += struct.pack('<IIHHHBBHBB', string(entry['name']), string(entry['game']), len(chunks), len(raw), len(card),
+			validTypes.index(entry['type']), eventLangs.index(entry['lang']) + 1, entry['species'] & 0xFFFF, entry['form'] & 0xFF, entry['gender'] & 0xFF)
+		raw += card
+	if len(raw) > 0:
+		chunks.append(raw)
+
+	events = b''
+	for match in sheet['matches']:
+		indices = [match['indices'].get(lang, noCard) if lang else noCard for lang in eventLangs]
+		events += struct.pack('<HHBB10H', match['id'], match['species'] & 0xFFFF, match['form'] & 0xFF, match['gender'] & 0xFF, *indices)
+
+	compressed = [bz2.compress(chunk) for chunk in chunks]
+	header = b'PKSMMGDB' + struct.pack('<IIIII', 1, len(sheet['wondercards']), len(sheet['matches']), len(chunks), len(strings))
+	offset = len(header) + len(cards) + len(events) + 12 * len(chunks) + len(strings)
+	index = b''
+	for chunk, packed in zip(chunks, compressed):
+		index += struct.pack('<III', offset, len(packed), len(chunk))
+		offset += len(packed)
+	return header + cards + events + index + strings + b''.join(compressed)
+
 def scanDir(root, sheet, origOffset):
 	retdata = b''
 	for path, subdirs, files in os.walk(root):
@@ -43,6 +96,7 @@ def scanDir(root, sheet, origOffset):
 					else:
 						entry['name'] = name.replace("Item ", "").replace(" " + game, "").replace(" (" + lang + ")","")
 				entry['type'] = type
+				entry['lang'] = lang
 				entry['size'] = size
 				entry['game'] = game
 				entry['offset'] = origOffset + len(retdata)
@@ -187,8 +241,7 @@ def scanDir(root, sheet, origOffset):
 							entry['form'] = -1
 							entry['gender'] = -1
 						cardId = entry['name'][:3]
-						if not any(elem in "1234567890" for elem in cardId):
-							cardId = 999
+						cardId = int(cardId) if cardId.isdigit() else 999
 						inMatches = False
 						for i in range(len(sheet['matches'])):
 							if sheet['matches'][i]['id'] == cardId and sheet['matches'][i]['species'] == entry['species'] and sheet['matches'][i]['form'] == entry['form'] and sheet['matches'][i]['gender'] == entry['gender']:
@@ -243,19 +296,7 @@ for gen in range (4, 7+1):
 	if (gen == 7):
 		data += scanDir("./EventsGallery/Unreleased/Gen 7/Movie 21", sheet, len(data))
 	
-	# sort, then get rid of data not needed in final product
+	# sort, then export
 	sheet['matches'] = sorted(sheet['matches'], key=sortById)
-	for i in range(len(sheet['matches'])):
-		temp = sheet['matches'][i]['indices']
-		sheet['matches'][i] = temp
-		sheet['matches'][i]
-		
-	# export sheet
-	compressed = bz2.compress(str.encode(json.dumps(sheet)))
-	with open("./out/sheet{}.json.bz2".format(gen), 'wb') as f:
-		f.write(compressed)
-
-	# export data
-	compressed = bz2.compress(data)
-	with open("./out/data{}.bin.bz2".format(gen), 'wb') as f:
-		f.write(compressed)
+	with open("./out/events{}.bin".format(gen), 'wb') as f:
+		f.write(packEvents(sheet, data))
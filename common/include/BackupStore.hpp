@@ -0,0 +1,109 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#ifndef BACKUPSTORE_HPP
+#define BACKUPSTORE_HPP
+
+#include "Sav.hpp"
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Save backups kept as manifests of content-addressed chunks, so that a backup only takes room for the chunks no earlier backup had.
+// Chunks are cut along the save's checksummed blocks, which are what the game rewrites, and named by their SHA-256:
+//   <root>/chunks/<first two hex digits>/<hash in hex>
+//   <root>/<id>/<timestamp>.bkp
+// A manifest is, all little endian:
+//   char magic[8] = "PKSMBKUP"
+//   u32 version
+//   u32 size
+//   u32 nameLength
+//   char saveName[nameLength]
+//   u32 chunkCount
+//   struct { u32 length; u8 hash[32]; } chunks[chunkCount], in file order
+class BackupStore
+{
+public:
+    using Hash = std::array<u8, 32>;
+
+    struct Chunk
+    {
+        u32 length;
+        Hash hash;
+    };
+
+    struct Manifest
+    {
+        std::string saveName;
+        u32 size;
+        std::vector<Chunk> chunks;
+    };
+
+    struct Report
+    {
+        size_t manifests          = 0;
+        size_t damagedManifests   = 0;
+        size_t chunks             = 0;
+        size_t missingChunks      = 0;
+        size_t corruptChunks      = 0;
+        size_t unreferencedChunks = 0;
+    };
+
+    explicit BackupStore(const std::string& root) : root(root) {}
+
+    // Stores the chunks of data that aren't in the store yet, or whose file no longer holds what it should, and a manifest for the whole of
+    // it. blocks come from Sav::blocks and may be empty. Returns the manifest's path, or an empty string if something couldn't be written
+    std::string backup(const std::string& id, const std::string& saveName, const u8* data, u32 size, const std::vector<Sav::Block>& blocks);
+    // Reassembles a backup, checking every chunk against its hash
+    bool restore(const std::string& manifest, std::vector<u8>& out) const;
+    // The id a manifest was backed up under, or an empty string if the path isn't a manifest
+    static std::string idOf(const std::string& manifest);
+    // Manifests of one id, oldest first
+    std::vector<std::string> backups(const std::string& id) const;
+    bool readManifest(const std::string& path, Manifest& manifest) const;
+    static bool isManifest(const std::string& path);
+
+    // Rehashes every chunk that a manifest uses and counts the ones nothing uses
+    Report verify(void) const;
+    // Deletes all but the newest keep backups of every id, then every chunk no manifest uses anymore. Returns how many chunks went
+    size_t prune(size_t keep);
+
+    // Offset and length of each chunk of a save. Neighbouring blocks share a chunk while it stays within chunkSize, and anything longer is
+    // cut at multiples of chunkSize, so boundaries stay put from one backup to the next
+    static std::vector<std::pair<u32, u32>> split(u32 size, std::vector<Sav::Block> blocks);
+    // About a cluster of an SD card, which is the least a file takes up there
+    static constexpr u32 chunkSize = 0x8000;
+
+private:
+    std::string root;
+
+    std::string chunkPath(const Hash& hash) const;
+    std::vector<std::string> ids(void) const;
+    std::vector<std::string> chunkFiles(void) const;
+};
+
+#endif
@@ -28,7 +28,6 @@
 #define BANK_HPP
 
 #include "Sav.hpp"
-#include "sha256.h"
 
 class Bank
 {
@@ -37,40 +36,84 @@ public:
     ~Bank() { delete[] data; }
     std::shared_ptr<PKX> pkm(int box, int slot) const;
     void pkm(std::shared_ptr<PKX> pkm, int box, int slot);
+    // Allocation-free read access to stored Pokemon. forEachSlot skips empty slots
+    PKXView slotView(int box, int slot) const;
+    void forEachSlot(const std::function<void(int box, int slot, const PKX& pkm)>& visitor) const;
+    // Built on first use and kept up to date by pkm()
+    const PKXIndex& index() const;
+    // Bit i is set if slot i of the box matches
+    u32 filterBox(const CompiledPKFilter& filter, int box) const;
+    // Swaps count boxes starting at firstBox with the save's boxes starting at saveBox, converting the bank's Pokemon straight into the
+    // save data. accept gets the index of the slot counted from the first box, the bank's Pokemon and what it converted to; a slot it
+    // turns down, or whose Pokemon can't be converted, is left alone on both sides. Empty bank slots are always swapped. Trades and the
+    // Pokedex are left to the caller. Returns how many slots were swapped
+    int transferBoxes(Sav& save, int firstBox, int saveBox, int count, const std::function<bool(int index, const PKX& from, const PKX& to)>& accept);
     void resize(size_t boxes);
     void load(int maxBoxes);
     bool save() const;
     bool backup() const;
     std::string boxName(int box) const;
     std::pair<std::string, std::string> paths() const;
+    std::string journalPath() const;
     void boxName(std::string name, int box);
+    // O(1): compares a running checksum of the entries against the one recorded by the last save
     bool hasChanged() const;
     int boxes() const;
     const std::string& name() const;
     bool setName(const std::string& name);
 
 private:
-    static constexpr int BANK_VERSION            = 2;
+    static constexpr int BANK_VERSION            = 3;
     static constexpr std::string_view BANK_MAGIC = "PKSMBANK";
+    // Changed entries are appended to the journal on save; the bank file itself is only rewritten once the journal is full. A journal
+    // only applies to the bank generation it was written for, and every rewrite starts a new generation
+    static constexpr std::string_view JOURNAL_MAGIC = "PKSMJRNL";
+    static constexpr u32 JOURNAL_CAPACITY           = 128;
     void createJSON();
     void createBank(int maxBoxes);
     void convertFromBankBin();
+    bool appendJournal() const;
+    bool compact() const;
+    // Moves a complete bank left behind by an interrupted compact() into place, or removes an incomplete one
+    void finishCompaction() const;
+    bool saveJSON() const;
+    void replayJournal();
     struct BankHeader
     {
         const char MAGIC[8];
         int version;
         int boxes;
+        u32 generation;
     };
     struct BankEntry
     {
         Generation gen;
         u8 data[260];
     };
+    struct JournalHeader
+    {
+        char MAGIC[8];
+        u32 count;
+        u32 generation;
+    };
+    struct JournalRecord
+    {
+        u32 index;
+        BankEntry entry;
+    };
+    // Position-dependent, so moving an entry to another slot changes the sum
+    static u64 entryChecksum(u32 index, const BankEntry& entry);
+    u64 checksum() const;
     u8* data = nullptr;
     nlohmann::json boxNames;
     size_t size;
-    mutable std::array<u8, SHA256_BLOCK_SIZE> prevHash;
-    mutable bool needsCheck = false;
+    u64 contentSum       = 0;
+    mutable u64 savedSum = 0;
+    mutable std::vector<bool> dirtyEntries;
+    mutable bool namesChanged = false;
+    mutable bool forceCompact = false;
+    mutable u32 journalCount  = 0;
+    mutable std::unique_ptr<PKXIndex> slotIndex;
     std::string bankName;
 };
 
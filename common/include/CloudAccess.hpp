@@ -29,7 +29,9 @@
 
 #include "PKX.hpp"
 #include "json.hpp"
+#include <atomic>
 #include <memory>
+#include <vector>
 
 class CloudAccess
 {
@@ -79,12 +81,17 @@ public:
     bool good() const { return isGood; }
     static std::string makeURL(int page, SortType type, bool ascend, bool legal);
     nlohmann::json grabPage(int page);
+    // Gets a page from the SD card cache if it hasn't expired, revalidating or downloading it otherwise
+    static nlohmann::json fetchPage(int page, SortType type, bool ascend, bool legal);
+    static void clearCache();
 
 private:
+    // How many pages on each side of the current one are downloaded in the background
+    static constexpr int PREFETCH_DISTANCE = 2;
     struct Page
     {
         nlohmann::json data;
-        bool available = false;
+        std::atomic<bool> available{false};
     };
     struct PageDownloadInfo
     {
@@ -92,14 +99,22 @@ private:
             : page(page), number(number), type(type), ascend(ascend), legal(legal)
         {
         }
+        bool matches(int number, SortType type, bool ascend, bool legal) const
+        {
+            return this->number == number && this->type == type && this->ascend == ascend && this->legal == legal;
+        }
         std::shared_ptr<Page> page;
         int number;
         SortType type;
         bool ascend, legal;
     };
     void refreshPages();
+    std::shared_ptr<Page> takePage(int number);
+    void prefetchPages();
     bool isGood = false;
     std::shared_ptr<Page> current;
+    // The current page and its neighbours for the current sort and filter, some of which may still be downloading
+    std::vector<PageDownloadInfo> prefetched;
     int pageNumber;
     SortType sort = LATEST;
     bool ascend   = true;
@@ -27,6 +27,7 @@
 #ifndef MYSTERYGIFT_HPP
 #define MYSTERYGIFT_HPP
 
+#include "LanguageStrings.hpp"
 #include "PGF.hpp"
 #include "PGT.hpp"
 #include "WB7.hpp"
@@ -51,8 +52,24 @@ namespace MysteryGift
         int form;
         int gender;
     };
+    // One event, with the index of its wondercard in each language it was distributed in
+    struct eventData
+    {
+        static constexpr u16 NO_CARD = 0xFFFF;
+        u16 id                       = 0;
+        s16 species                  = -1;
+        s8 form                      = -1;
+        s8 gender                    = -1;
+        // Indexed by Language - 1, from JP to TW
+        u16 cards[10] = {NO_CARD, NO_CARD, NO_CARD, NO_CARD, NO_CARD, NO_CARD, NO_CARD, NO_CARD, NO_CARD, NO_CARD};
+
+        bool has(Language lang) const { return lang >= Language::JP && lang <= Language::TW && cards[lang - 1] != NO_CARD; }
+        size_t card(Language lang) const { return cards[lang - 1]; }
+        // The first language the event is available in, or UNUSED if there isn't one
+        Language firstLanguage() const;
+    };
     void init(Generation gen);
-    std::vector<nlohmann::json> wondercards();
+    const std::vector<eventData>& wondercards();
     MysteryGift::giftData wondercardInfo(size_t index);
     std::unique_ptr<WCX> wondercard(size_t index);
     void exit();
@@ -150,6 +150,7 @@ void pkx_encrypt(struct ParseState*, struct Value*, struct Value**, int);
 void pkx_box_size(struct ParseState*, struct Value*, struct Value**, int);
 void pkx_party_size(struct ParseState*, struct Value*, struct Value**, int);
 void pkx_generate(struct ParseState*, struct Value*, struct Value**, int);
+void pkx_generate_batch(struct ParseState*, struct Value*, struct Value**, int);
 void pkx_is_valid(struct ParseState*, struct Value*, struct Value**, int);
 void pkx_set_value(struct ParseState*, struct Value*, struct Value**, int);
 void pkx_get_value(struct ParseState*, struct Value*, struct Value**, int);
@@ -30,3 +30,6 @@
 #ifdef __SWITCH__
 #include <switch/types.h>
 #endif
+#ifdef PKSM_HOST
+#include <host/types.h>
+#endif
@@ -0,0 +1,42 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#ifndef CRC_HPP
+#define CRC_HPP
+
+#include "types.h"
+
+namespace CRC
+{
+    // CRC-16/CCITT (polynomial 0x1021, MSB first, initial value 0xFFFF). Used by Gen 4-6 saves
+    u16 ccitt16(const u8* buf, u32 len);
+    // CRC-16 (polynomial 0xA001, LSB first) with a caller-provided initial value. Used by Gen 7 and LGPE saves
+    u16 crc16(const u8* buf, u32 len, u16 crc);
+    // 64-bit FNV-1a. Not a CRC, but cheap enough to keep the bank's running checksum
+    u64 fnv1a64(const u8* buf, u32 len);
+}
+
+#endif
@@ -29,14 +29,41 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 class Fetch
 {
 public:
+    struct Download
+    {
+        std::string url;
+        std::string path;
+        std::string postData            = "";
+        curl_xferinfo_callback progress = nullptr;
+        void* progressInfo              = nullptr;
+    };
+    // Totals since initialize, to see how many transfers actually needed a new connection (and with it a TLS handshake)
+    struct Stats
+    {
+        u32 transfers;
+        u32 connections;
+        u64 bytes;
+    };
+
+    // Sets up curl, the pool of reusable handles and the DNS, TLS session and connection cache they share. Call it before starting any
+    // thread that uses Fetch
+    static Result initialize(void);
+    static void exit(void);
+    static Stats stats(void);
+
     static std::unique_ptr<Fetch> init(
         const std::string& url, bool post, bool ssl, std::string* writeData, struct curl_slist* headers, const std::string& postdata);
     static Result download(const std::string& url, const std::string& path, const std::string& postData = "",
         curl_xferinfo_callback progress = nullptr, void* progressInfo = nullptr);
+    // Downloads everything at once, with one result per download
+    static std::vector<Result> download(const std::vector<Download>& downloads);
+    // Runs the transfers at the same time on this thread and returns when all of them are done. Null entries fail with CURLE_FAILED_INIT
+    static std::vector<CURLcode> performAll(const std::vector<std::unique_ptr<Fetch>>& fetches);
 
     CURLcode perform();
     template <typename T>
@@ -52,6 +79,9 @@ public:
     std::unique_ptr<curl_mime, decltype(curl_mime_free)*> mimeInit();
 
 private:
-    Fetch() : curl(nullptr, &curl_easy_cleanup) {}
-    std::unique_ptr<CURL, decltype(curl_easy_cleanup)*> curl;
+    Fetch() : curl(nullptr, &release) {}
+    // Gives the handle back to the pool instead of closing its connections
+    static void release(CURL* handle);
+    void record();
+    std::unique_ptr<CURL, void (*)(CURL*)> curl;
 };
@@ -28,6 +28,7 @@
 #define G4TEXT_H
 
 #include "types.h"
+#include <array>
 
 static constexpr u16 G4Values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
     32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67,
@@ -283,4 +284,97 @@ static constexpr u16 G4Chars[] = {12288, 12353, 12354, 12355, 12356, 12357, 1235
 
 constexpr size_t G4TEXT_LENGTH = 2872;
 
+// Direct-index versions of the two arrays above, built at compile time so that converting a character is a table lookup instead of a search
+namespace G4Text
+{
+    constexpr u16 maxValue(void)
+    {
+        u16 ret = 0;
+        for (size_t i = 0; i < G4TEXT_LENGTH; i++)
+        {
+            if (G4Values[i] != 0xFFFF && G4Values[i] > ret)
+            {
+                ret = G4Values[i];
+            }
+        }
+        return ret;
+    }
+
+    constexpr size_t pageCount(void)
+    {
+        bool used[256] = {};
+        size_t ret     = 0;
+        for (size_t i = 0; i < G4TEXT_LENGTH; i++)
+        {
+            if (!used[G4Chars[i] >> 8])
+            {
+                used[G4Chars[i] >> 8] = true;
+                ret++;
+            }
+        }
+        return ret;
+    }
+
+    // Indexed by G4 value. Values that aren't in G4Values map to 0xFFFF
+    constexpr std::array<u16, maxValue() + 1> buildCharTable(void)
+    {
+        std::array<u16, maxValue() + 1> ret{};
+        for (size_t i = 0; i < ret.size(); i++)
+        {
+            ret[i] = 0xFFFF;
+        }
+        for (size_t i = 0; i < G4TEXT_LENGTH; i++)
+        {
+            if (G4Values[i] != 0xFFFF)
+            {
+                ret[G4Values[i]] = G4Chars[i];
+            }
+        }
+        return ret;
+    }
+
+    // Two-level table indexed by the high and low byte of a UTF-16 code unit. Page 0 is all zeroes and stands in for every unused page
+    struct ValueTable
+    {
+        std::array<u8, 256> page;
+        std::array<std::array<u16, 256>, pageCount() + 1> values;
+    };
+    static_assert(pageCount() < 256);
+
+    constexpr ValueTable buildValueTable(void)
+    {
+        ValueTable ret{};
+        u8 nextPage = 1;
+        for (size_t i = 0; i < G4TEXT_LENGTH; i++)
+        {
+            if (ret.page[G4Chars[i] >> 8] == 0)
+            {
+                ret.page[G4Chars[i] >> 8] = nextPage++;
+            }
+            u16& value = ret.values[ret.page[G4Chars[i] >> 8]][G4Chars[i] & 0xFF];
+            // Some characters appear more than once; the first one wins, as it did with std::find
+            if (value == 0)
+            {
+                value = G4Values[i];
+            }
+        }
+        return ret;
+    }
+
+    static constexpr std::array<u16, maxValue() + 1> charTable = buildCharTable();
+    static constexpr ValueTable valueTable                     = buildValueTable();
+
+    // UTF-16 code unit of a G4 value, or 0xFFFF for the terminator and for values that aren't characters
+    constexpr u16 toChar(u16 value)
+    {
+        return value < charTable.size() ? charTable[value] : 0xFFFF;
+    }
+
+    // G4 value of a UTF-16 code unit, or 0 if it can't be represented
+    constexpr u16 toValue(u16 codepoint)
+    {
+        return valueTable.values[valueTable.page[codepoint >> 8]][codepoint & 0xFF];
+    }
+}
+
 #endif
@@ -42,10 +42,19 @@ namespace StringUtils
     std::string format(std::string fmt_str, ...);
     std::u16string UTF8toUTF16(const std::string& src);
     std::string UTF16toUTF8(const std::u16string& src);
+    // Allocation-free versions for callers with their own storage. They return the number of code units written, which is at most outLen.
+    // UTF16toUTF8 stops at a NUL and never splits a character
+    size_t UTF8toUTF16(const char* src, size_t srcLen, char16_t* out, size_t outLen);
+    size_t UTF16toUTF8(const char16_t* src, size_t srcLen, char* out, size_t outLen);
     std::u16string getU16String(const u8* data, int ofs, int len, char16_t term);
     std::string getString(const u8* data, int ofs, int len, char16_t term = 0);
     void setString(u8* data, const std::u16string& v, int ofs, int len, char16_t terminator = 0, char16_t padding = 0);
     void setString(u8* data, const std::string& v, int ofs, int len, char16_t terminator = 0, char16_t padding = 0);
+    // getString and setString with transString45 (Generation 5) or transString67 (Generations 6 and 7) applied during the conversion
+    std::string getString45(const u8* data, int ofs, int len, char16_t term = 0);
+    void setString45(u8* data, const std::string& v, int ofs, int len, char16_t terminator = 0, char16_t padding = 0);
+    std::string getString67(const u8* data, int ofs, int len, char16_t term = 0);
+    void setString67(u8* data, const std::string& v, int ofs, int len, char16_t terminator = 0, char16_t padding = 0);
     std::string getString4(const u8* data, int ofs, int len);
     void setString4(u8* data, const std::string& v, int ofs, int len);
     std::vector<u16> stringToG4(const std::string& v);
@@ -0,0 +1,87 @@
+#!/usr/bin/python3
+# Packs the text tables of each language in assets/romfs/i18n into <language>/strings.bin, which LanguageStrings reads instead of the
+# text files when it's there. Run from this directory.
+#
+# Layout, all little endian:
+#   char magic[8] = "PKSMI18N"
+#   u32 version
+#   u32 tableCount
+#   struct { u32 key; u32 count; u32 offset; u32 size; } tables[tableCount], sorted by key
+# and at each table's offset, which is a multiple of four:
+#   u16 ids[count], sorted, padded to a multiple of four bytes
+#   u32 ends[count], where each string ends in strings[]
+#   char strings[], UTF-8 without terminators
+import os
+import struct
+
+base = "../assets/romfs/i18n"
+version = 1
+
+# Keys are LanguageStrings::Table values, in the same order; subregion tables are 0x100 + country
+listTables = ["abilities", "balls", "forms", "hp", "items", "moves", "natures", "species", "games"]
+mapTables = ["locations4", "locations5", "locations6", "locations7", "locationsLGPE", "countries"]
+subregionKey = 0x100
+
+
+def path(lang, name):
+    ret = os.path.join(base, lang, name)
+    return ret if os.path.exists(ret) else os.path.join(base, "en", name)
+
+
+def lines(lang, name):
+    with open(path(lang, name), "rb") as f:
+        ret = f.read().split(b"\n")
+    if ret[-1] == b"":
+        ret.pop()
+    return [line.split(b"\r")[0] for line in ret]
+
+
+def readList(lang, name):
+    return list(enumerate(lines(lang, name)))
+
+
+# Later lines win, like they do when the text file is loaded into a map
+def readMap(lang, name):
+    ret = {}
+    for line in lines(lang, name):
+        id, sep, value = line.partition(b"|")
+        ret[int(id, 0)] = value if sep else line
+    return sorted(ret.items())
+
+
+def packTable(entries):
+    ids = struct.pack("<%dH" % len(entries), *[id for id, _ in entries])
+    ids += b"\0" * (-len(ids) % 4)
+    strings = b""
+    ends = []
+    for _, value in entries:
+        strings += value
+        ends.append(len(strings))
+    return ids + struct.pack("<%dI" % len(ends), *ends) + strings
+
+
+def pack(lang):
+    tables = {}
+    for i, name in enumerate(listTables):
+        tables[i] = readList(lang, name + ".txt")
+    for i, name in enumerate(mapTables):
+        tables[len(listTables) + i] = readMap(lang, name + ".txt")
+    for country, _ in readMap(lang, "countries.txt"):
+        name = "subregions/%03d.txt" % country
+        tables[subregionKey + country] = readMap(lang, name) if os.path.exists(path(lang, name)) else []
+
+    header = b"PKSMI18N" + struct.pack("<II", version, len(tables))
+    directory = b""
+    data = b""
+    offset = len(header) + 16 * len(tables)
+    for key in sorted(tables):
+        table = packTable(tables[key])
+        directory += struct.pack("<IIII", key, len(tables[key]), offset + len(data), len(table))
+        data += table + b"\0" * (-len(table) % 4)
+    with open(os.path.join(base, lang, "strings.bin"), "wb") as f:
+        f.write(header + directory + data)
+
+
+for lang in sorted(os.listdir(base)):
+    if os.path.isdir(os.path.join(base, lang)):
+        pack(lang)
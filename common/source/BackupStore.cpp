@@ -0,0 +1,458 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "BackupStore.hpp"
+#include "STDirectory.hpp"
+#include "io.hpp"
+#include "sha256.h"
+#include <algorithm>
+#include <ctime>
+#include <set>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace
+{
+    constexpr char MAGIC[8]         = {'P', 'K', 'S', 'M', 'B', 'K', 'U', 'P'};
+    constexpr u32 VERSION           = 1;
+    constexpr const char* EXTENSION = ".bkp";
+
+    BackupStore::Hash hash(const u8* data, size_t length)
+    {
+        BackupStore::Hash ret;
+        SHA256_CTX ctx;
+        sha256_init(&ctx);
+        sha256_update(&ctx, data, length);
+        sha256_final(&ctx, ret.data());
+        return ret;
+    }
+
+    std::string hex(const BackupStore::Hash& hash)
+    {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string ret;
+        for (u8 byte : hash)
+        {
+            ret += digits[byte >> 4];
+            ret += digits[byte & 0xF];
+        }
+        return ret;
+    }
+
+    bool readFile(const std::string& path, std::vector<u8>& out)
+    {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in)
+        {
+            return false;
+        }
+        fseek(in, 0, SEEK_END);
+        out.resize(ftell(in));
+        fseek(in, 0, SEEK_SET);
+        bool good = fread(out.data(), 1, out.size(), in) == out.size();
+        fclose(in);
+        return good;
+    }
+
+    // Through a temporary file, so that a power cut never leaves half a file under the real name
+    bool writeFile(const std::string& path, const u8* data, size_t length)
+    {
+        std::string temp = path + ".tmp";
+        FILE* out        = fopen(temp.c_str(), "wb");
+        if (!out)
+        {
+            return false;
+        }
+        bool good = fwrite(data, 1, length, out) == length;
+        good &= fclose(out) == 0;
+        // The 3DS's SD card archive won't rename over a file that exists
+        if (good && rename(temp.c_str(), path.c_str()) != 0)
+        {
+            remove(path.c_str());
+            good = rename(temp.c_str(), path.c_str()) == 0;
+        }
+        if (!good)
+        {
+            remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool endsWith(const std::string& str, const std::string& end)
+    {
+        return str.size() >= end.size() && str.compare(str.size() - end.size(), end.size(), end) == 0;
+    }
+
+    template <typename T>
+    void append(std::vector<u8>& out, const T& value)
+    {
+        const u8* bytes = (const u8*)&value;
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    bool take(const std::vector<u8>& in, size_t& offset, T& value)
+    {
+        if (offset + sizeof(T) > in.size())
+        {
+            return false;
+        }
+        memcpy(&value, in.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+}
+
+std::vector<std::pair<u32, u32>> BackupStore::split(u32 size, std::vector<Sav::Block> blocks)
+{
+    std::sort(blocks.begin(), blocks.end(), [](const Sav::Block& a, const Sav::Block& b) { return a.offset < b.offset; });
+
+    // Each block, and each gap between them, is one piece
+    std::vector<std::pair<u32, u32>> pieces;
+    u32 pos = 0;
+    for (const auto& block : blocks)
+    {
+        u32 start = std::max(block.offset, pos);
+        u32 end   = std::min(block.offset + block.length, size);
+        if (end <= start)
+        {
+            continue;
+        }
+        if (start > pos)
+        {
+            pieces.emplace_back(pos, start);
+        }
+        pieces.emplace_back(start, end);
+        pos = end;
+    }
+    if (pos < size)
+    {
+        pieces.emplace_back(pos, size);
+    }
+
+    std::vector<std::pair<u32, u32>> ret;
+    bool open = false;
+    for (auto [start, end] : pieces)
+    {
+        if (end - start > chunkSize)
+        {
+            for (u32 offset = start; offset < end;)
+            {
+                u32 next = std::min((offset / chunkSize + 1) * chunkSize, end);
+                ret.emplace_back(offset, next - offset);
+                offset = next;
+            }
+            open = false;
+        }
+        else if (open && ret.back().second + (end - start) <= chunkSize)
+        {
+            ret.back().second += end - start;
+        }
+        else
+        {
+            ret.emplace_back(start, end - start);
+            open = true;
+        }
+    }
+    return ret;
+}
+
+std::string BackupStore::chunkPath(const Hash& hash) const
+{
+    std::string name = hex(hash);
+    return root + "/chunks/" + name.substr(0, 2) + "/" + name;
+}
+
+std::string BackupStore::backup(const std::string& id, const std::string& saveName, const u8* data, u32 size, const std::vector<Sav::Block>& blocks)
+{
+    mkdir(root.c_str(), 0777);
+    mkdir((root + "/chunks").c_str(), 0777);
+
+    std::vector<u8> manifest(MAGIC, MAGIC + 8);
+    append(manifest, VERSION);
+    append(manifest, size);
+    append(manifest, u32(saveName.size()));
+    manifest.insert(manifest.end(), saveName.begin(), saveName.end());
+    std::vector<std::pair<u32, u32>> chunks = split(size, blocks);
+    append(manifest, u32(chunks.size()));
+    std::vector<u8> stored;
+    for (auto [offset, length] : chunks)
+    {
+        Hash chunkHash   = hash(data + offset, length);
+        std::string path = chunkPath(chunkHash);
+        // A chunk that was cut short or damaged on the card would take every new backup using it down with it, so it's written again
+        if (!readFile(path, stored) || stored.size() != length || memcmp(stored.data(), data + offset, length))
+        {
+            mkdir(path.substr(0, path.rfind('/')).c_str(), 0777);
+            if (!writeFile(path, data + offset, length))
+            {
+                return "";
+            }
+        }
+        append(manifest, length);
+        manifest.insert(manifest.end(), chunkHash.begin(), chunkHash.end());
+    }
+
+    char stringTime[15]   = {0};
+    time_t unixTime       = time(NULL);
+    struct tm* timeStruct = gmtime((const time_t*)&unixTime);
+    std::strftime(stringTime, 15, "%Y%m%d%H%M%S", timeStruct);
+    std::string path = root + "/" + id;
+    mkdir(path.c_str(), 0777);
+    path += "/" + std::string(stringTime);
+    // A second backup within the same second goes after the first, which "_" does as it sorts after "."
+    std::string name = path + EXTENSION;
+    for (int i = 1; io::exists(name); i++)
+    {
+        name = path + "_" + std::to_string(i) + EXTENSION;
+    }
+    path = name;
+    return writeFile(path, manifest.data(), manifest.size()) ? path : "";
+}
+
+bool BackupStore::readManifest(const std::string& path, Manifest& manifest) const
+{
+    std::vector<u8> data;
+    if (!readFile(path, data) || data.size() < 8 || memcmp(data.data(), MAGIC, 8))
+    {
+        return false;
+    }
+    size_t offset = 8;
+    u32 version, nameLength, count;
+    if (!take(data, offset, version) || version != VERSION || !take(data, offset, manifest.size) || !take(data, offset, nameLength) ||
+        offset + nameLength > data.size())
+    {
+        return false;
+    }
+    manifest.saveName = std::string((const char*)data.data() + offset, nameLength);
+    offset += nameLength;
+    if (!take(data, offset, count))
+    {
+        return false;
+    }
+    manifest.chunks.resize(count);
+    u32 total = 0;
+    for (auto& chunk : manifest.chunks)
+    {
+        if (!take(data, offset, chunk.length) || !take(data, offset, chunk.hash))
+        {
+            return false;
+        }
+        total += chunk.length;
+    }
+    return total == manifest.size;
+}
+
+bool BackupStore::restore(const std::string& path, std::vector<u8>& out) const
+{
+    Manifest manifest;
+    if (!readManifest(path, manifest))
+    {
+        return false;
+    }
+    out.clear();
+    out.reserve(manifest.size);
+    std::vector<u8> chunk;
+    for (const auto& entry : manifest.chunks)
+    {
+        if (!readFile(chunkPath(entry.hash), chunk) || chunk.size() != entry.length || hash(chunk.data(), chunk.size()) != entry.hash)
+        {
+            return false;
+        }
+        out.insert(out.end(), chunk.begin(), chunk.end());
+    }
+    return true;
+}
+
+std::string BackupStore::idOf(const std::string& manifest)
+{
+    // <root>/<id>/<timestamp>.bkp
+    size_t slash = manifest.rfind('/');
+    if (slash == std::string::npos || slash == 0 || !isManifest(manifest))
+    {
+        return "";
+    }
+    size_t idEnd = manifest.rfind('/', slash - 1);
+    return idEnd == std::string::npos ? "" : manifest.substr(idEnd + 1, slash - idEnd - 1);
+}
+
+bool BackupStore::isManifest(const std::string& path)
+{
+    return endsWith(path, EXTENSION);
+}
+
+std::vector<std::string> BackupStore::ids(void) const
+{
+    std::vector<std::string> ret;
+    STDirectory directory(root);
+    for (size_t i = 0; i < directory.count(); i++)
+    {
+        std::string name = directory.item(i);
+        if (directory.folder(i) && name != "." && name != ".." && name != "chunks")
+        {
+            ret.emplace_back(name);
+        }
+    }
+    return ret;
+}
+
+std::vector<std::string> BackupStore::backups(const std::string& id) const
+{
+    std::vector<std::string> ret;
+    STDirectory directory(root + "/" + id);
+    for (size_t i = 0; i < directory.count(); i++)
+    {
+        if (!directory.folder(i) && isManifest(directory.item(i)))
+        {
+            ret.emplace_back(root + "/" + id + "/" + directory.item(i));
+        }
+    }
+    // Timestamps sort the same as text
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+BackupStore::Report BackupStore::verify(void) const
+{
+    Report report;
+    std::set<Hash> good, bad;
+    std::vector<u8> chunk;
+    for (const auto& id : ids())
+    {
+        for (const auto& path : backups(id))
+        {
+            report.manifests++;
+            Manifest manifest;
+            if (!readManifest(path, manifest))
+            {
+                report.damagedManifests++;
+                continue;
+            }
+            bool damaged = false;
+            for (const auto& entry : manifest.chunks)
+            {
+                if (good.count(entry.hash))
+                {
+                    continue;
+                }
+                if (!bad.count(entry.hash))
+                {
+                    if (!readFile(chunkPath(entry.hash), chunk))
+                    {
+                        report.missingChunks++;
+                        bad.insert(entry.hash);
+                    }
+                    else if (chunk.size() != entry.length || hash(chunk.data(), chunk.size()) != entry.hash)
+                    {
+                        report.corruptChunks++;
+                        bad.insert(entry.hash);
+                    }
+                    else
+                    {
+                        good.insert(entry.hash);
+                        continue;
+                    }
+                }
+                damaged = true;
+            }
+            report.damagedManifests += damaged;
+        }
+    }
+
+    std::set<std::string> referenced;
+    for (const auto& set : {good, bad})
+    {
+        for (const auto& entry : set)
+        {
+            referenced.insert(hex(entry));
+        }
+    }
+    for (const auto& path : chunkFiles())
+    {
+        report.chunks++;
+        report.unreferencedChunks += !referenced.count(path.substr(path.rfind('/') + 1));
+    }
+    return report;
+}
+
+size_t BackupStore::prune(size_t keep)
+{
+    std::set<std::string> referenced;
+    for (const auto& id : ids())
+    {
+        std::vector<std::string> manifests = backups(id);
+        for (size_t i = 0; i < manifests.size(); i++)
+        {
+            Manifest manifest;
+            if (i + keep < manifests.size())
+            {
+                remove(manifests[i].c_str());
+            }
+            else if (readManifest(manifests[i], manifest))
+            {
+                for (const auto& entry : manifest.chunks)
+                {
+                    referenced.insert(hex(entry.hash));
+                }
+            }
+        }
+    }
+
+    size_t ret = 0;
+    for (const auto& path : chunkFiles())
+    {
+        if (!referenced.count(path.substr(path.rfind('/') + 1)) && remove(path.c_str()) == 0)
+        {
+            ret++;
+        }
+    }
+    return ret;
+}
+
+std::vector<std::string> BackupStore::chunkFiles(void) const
+{
+    std::vector<std::string> ret;
+    STDirectory chunks(root + "/chunks");
+    for (size_t i = 0; i < chunks.count(); i++)
+    {
+        std::string prefix = chunks.item(i);
+        if (!chunks.folder(i) || prefix == "." || prefix == "..")
+        {
+            continue;
+        }
+        STDirectory files(root + "/chunks/" + prefix);
+        for (size_t j = 0; j < files.count(); j++)
+        {
+            if (!files.folder(j))
+            {
+                ret.emplace_back(root + "/chunks/" + prefix + "/" + files.item(j));
+            }
+        }
+    }
+    return ret;
+}
@@ -27,10 +27,27 @@
 #include "CloudAccess.hpp"
 #include "Configuration.hpp"
 #include "PK7.hpp"
+#include "STDirectory.hpp"
 #include "app.hpp"
 #include "base64.hpp"
 #include "fetch.hpp"
 #include "thread.hpp"
+#include <atomic>
+#include <set>
+#include <time.h>
+
+// Can be pointed at a local server to try things out without touching the real GPSS
+#ifndef GPSS_URL
+#define GPSS_URL "https://flagbrew.org"
+#endif
+
+#define CACHE_PATH "/3ds/PKSM/cache/"
+#define CACHE_PREFIX "gpss_"
+
+// Downloads need more stack than the default, for the TLS handshake
+#define PREFETCH_STACK_SIZE 0x10000
+// How long a page is used without asking the server again, unless the server says otherwise
+#define DEFAULT_PAGE_LIFETIME (5 * 60)
 
 static Generation numToGen(int num)
 {
@@ -50,29 +67,130 @@ static Generation numToGen(int num)
     return Generation::UNUSED;
 }
 
-void downloadCloudPage(CloudAccess::PageDownloadInfo* info)
+struct PageHeaders
 {
-    if (info)
+    std::string etag;
+    time_t lifetime = DEFAULT_PAGE_LIFETIME;
+    bool store      = true;
+};
+
+static size_t header_callback(char* buffer, size_t size, size_t nitems, void* userdata)
+{
+    PageHeaders* headers = (PageHeaders*)userdata;
+    std::string line(buffer, size * nitems);
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
     {
-        std::string retData;
-        auto fetch = Fetch::init(CloudAccess::makeURL(info->number, info->type, info->ascend, info->legal), false, true, &retData, nullptr, "");
-        if (fetch && fetch->perform() == CURLE_OK)
+        line.pop_back();
+    }
+    size_t colon = line.find(':');
+    if (colon != std::string::npos)
+    {
+        // Header names are case-insensitive, and so are cache directives, but ETags aren't
+        std::string name = line.substr(0, colon);
+        StringUtils::toLower(name);
+        std::string value = line.substr(std::min(line.find_first_not_of(' ', colon + 1), line.size()));
+        if (name == "etag")
         {
-            long status_code;
-            fetch->getinfo(CURLINFO_RESPONSE_CODE, &status_code);
-            switch (status_code)
+            headers->etag = value;
+        }
+        else if (name == "cache-control")
+        {
+            std::string directives = value;
+            StringUtils::toLower(directives);
+            if (directives.find("no-store") != std::string::npos)
             {
-                case 200:
-                    break;
-                default:
-                    info->page->data = {};
+                headers->store = false;
+            }
+            else if (directives.find("no-cache") != std::string::npos)
+            {
+                headers->lifetime = 0;
+            }
+            else if (size_t maxAge = directives.find("max-age="); maxAge != std::string::npos)
+            {
+                headers->lifetime = strtol(directives.c_str() + maxAge + 8, nullptr, 10);
             }
-            info->page->data = nlohmann::json::parse(retData, nullptr, false);
         }
-        else
+    }
+    return size * nitems;
+}
+
+static std::string cachePath(int num, CloudAccess::SortType type, bool ascend, bool legal)
+{
+    return StringUtils::format(CACHE_PATH CACHE_PREFIX "%i_%i_%i_%i.json", (int)type, (int)ascend, (int)legal, num);
+}
+
+// Only called while the page is claimed, so nothing else reads or writes path in between
+static void writeCache(const std::string& path, const std::string& etag, time_t expires, const nlohmann::json& page)
+{
+    nlohmann::json entry;
+    entry["etag"]    = etag;
+    entry["expires"] = expires;
+    entry["page"]    = page;
+    std::string data = entry.dump();
+    std::string temp = path + ".tmp";
+    FILE* out        = fopen(temp.c_str(), "wb");
+    if (!out)
+    {
+        return;
+    }
+    bool good = fwrite(data.data(), 1, data.size(), out) == data.size();
+    good &= fclose(out) == 0;
+    // The SD card can't rename over a file, so the old one goes first. Either way a reader never sees half a page
+    remove(path.c_str());
+    if (!good || rename(temp.c_str(), path.c_str()) != 0)
+    {
+        remove(temp.c_str());
+    }
+}
+
+namespace
+{
+    // Cache files that a fetchPage is working on. Anyone else after the same page waits for it to finish and then finds it in the
+    // cache, so the background downloads and the foreground never fetch or write the same page twice at once
+    std::set<std::string> claimedPages;
+    std::atomic_flag claimedPagesLock = ATOMIC_FLAG_INIT;
+
+    class PageClaim
+    {
+    public:
+        explicit PageClaim(const std::string& path) : path(path)
+        {
+            while (!tryClaim())
+            {
+                svcSleepThread(1000000);
+            }
+        }
+        ~PageClaim()
+        {
+            lock();
+            claimedPages.erase(path);
+            claimedPagesLock.clear(std::memory_order_release);
+        }
+
+    private:
+        static void lock()
         {
-            info->page->data = {};
+            while (claimedPagesLock.test_and_set(std::memory_order_acquire))
+            {
+                svcSleepThread(100000);
+            }
+        }
+        bool tryClaim()
+        {
+            lock();
+            bool ret = claimedPages.insert(path).second;
+            claimedPagesLock.clear(std::memory_order_release);
+            return ret;
         }
+        std::string path;
+    };
+}
+
+void downloadCloudPage(CloudAccess::PageDownloadInfo* info)
+{
+    if (info)
+    {
+        info->page->data      = CloudAccess::fetchPage(info->number, info->type, info->ascend, info->legal);
         info->page->available = true;
         delete info;
     }
@@ -80,44 +198,157 @@ void downloadCloudPage(CloudAccess::PageDownloadInfo* info)
 
 CloudAccess::CloudAccess() : pageNumber(1)
 {
-    current = std::make_shared<Page>();
-    if (current)
+    refreshPages();
+}
+
+void CloudAccess::refreshPages()
+{
+    current            = std::make_shared<Page>();
+    current->data      = grabPage(pageNumber);
+    current->available = true;
+    isGood             = !current->data.is_discarded() && current->data.size() > 0;
+    prefetched.clear();
+    if (isGood)
     {
-        current->data      = grabPage(pageNumber);
-        current->available = true;
-        isGood             = !current->data.is_discarded() && current->data.size() > 0;
+        prefetchPages();
     }
 }
 
-void CloudAccess::refreshPages()
+std::shared_ptr<CloudAccess::Page> CloudAccess::takePage(int num)
 {
-    current = std::make_shared<Page>();
-    if (current)
+    for (auto& info : prefetched)
     {
-        current->data      = grabPage(pageNumber);
-        current->available = true;
-        isGood             = !current->data.is_discarded() && current->data.size() > 0;
+        if (info.matches(num, sort, ascend, legal))
+        {
+            while (!info.page->available)
+            {
+                svcSleepThread(1000000);
+            }
+            // A failed download gets one more try, now that the user is actually waiting on it
+            if (!info.page->data.is_discarded() && info.page->data.size() > 0)
+            {
+                return info.page;
+            }
+            break;
+        }
+    }
+
+    auto ret       = std::make_shared<Page>();
+    ret->data      = grabPage(num);
+    ret->available = true;
+    return ret;
+}
+
+void CloudAccess::prefetchPages()
+{
+    int count = pages();
+    if (count <= 1)
+    {
+        prefetched = {PageDownloadInfo(current, pageNumber, sort, ascend, legal)};
+        return;
+    }
+    std::vector<PageDownloadInfo> window;
+    window.emplace_back(current, pageNumber, sort, ascend, legal);
+    for (int distance = 1; distance <= PREFETCH_DISTANCE; distance++)
+    {
+        for (int num : {(pageNumber - 1 + distance) % count + 1, (pageNumber - 1 - distance % count + count) % count + 1})
+        {
+            if (std::any_of(window.begin(), window.end(), [&](const PageDownloadInfo& info) { return info.number == num; }))
+            {
+                continue;
+            }
+            auto found = std::find_if(
+                prefetched.begin(), prefetched.end(), [&](const PageDownloadInfo& info) { return info.matches(num, sort, ascend, legal); });
+            if (found != prefetched.end())
+            {
+                window.push_back(*found);
+            }
+            else
+            {
+                window.emplace_back(std::make_shared<Page>(), num, sort, ascend, legal);
+                Threads::create((ThreadFunc)downloadCloudPage, new PageDownloadInfo(window.back()), PREFETCH_STACK_SIZE);
+            }
+        }
     }
+    prefetched = std::move(window);
 }
 
 nlohmann::json CloudAccess::grabPage(int num)
 {
+    return fetchPage(num, sort, ascend, legal);
+}
+
+nlohmann::json CloudAccess::fetchPage(int num, SortType type, bool ascend, bool legal)
+{
+    std::string path = cachePath(num, type, ascend, legal);
+    PageClaim claim(path);
+    nlohmann::json cached;
+    if (FILE* in = fopen(path.c_str(), "rb"))
+    {
+        cached = nlohmann::json::parse(in, nullptr, false);
+        fclose(in);
+    }
+    bool haveCache = cached.is_object() && cached.contains("page") && cached["expires"].is_number() && cached["etag"].is_string();
+    if (haveCache && cached["expires"].get<time_t>() > time(nullptr))
+    {
+        return cached["page"];
+    }
+
     std::string retData;
-    auto fetch = Fetch::init(makeURL(num, sort, ascend, legal), false, true, &retData, nullptr, "");
-    if (fetch && fetch->perform() == CURLE_OK)
+    PageHeaders headers;
+    struct curl_slist* requestHeaders = NULL;
+    std::string condition;
+    if (haveCache && !cached["etag"].get<std::string>().empty())
+    {
+        condition      = "If-None-Match: " + cached["etag"].get<std::string>();
+        requestHeaders = curl_slist_append(requestHeaders, condition.c_str());
+    }
+
+    nlohmann::json ret;
+    auto fetch = Fetch::init(makeURL(num, type, ascend, legal), false, true, &retData, requestHeaders, "");
+    if (fetch)
     {
-        long status_code;
-        fetch->getinfo(CURLINFO_RESPONSE_CODE, &status_code);
-        switch (status_code)
+        fetch->setopt(CURLOPT_HEADERFUNCTION, header_callback);
+        fetch->setopt(CURLOPT_HEADERDATA, &headers);
+        if (fetch->perform() == CURLE_OK)
         {
-            case 200:
-                break;
-            default:
-                return {};
+            long status_code;
+            fetch->getinfo(CURLINFO_RESPONSE_CODE, &status_code);
+            switch (status_code)
+            {
+                case 200:
+                    ret = nlohmann::json::parse(retData, nullptr, false);
+                    if (headers.store && !ret.is_discarded() && ret.size() > 0)
+                    {
+                        writeCache(path, headers.etag, time(nullptr) + headers.lifetime, ret);
+                    }
+                    break;
+                case 304:
+                    if (haveCache)
+                    {
+                        ret = cached["page"];
+                        writeCache(path, cached["etag"].get<std::string>(), time(nullptr) + headers.lifetime, ret);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    curl_slist_free_all(requestHeaders);
+    return ret;
+}
+
+void CloudAccess::clearCache()
+{
+    STDirectory directory(CACHE_PATH);
+    for (size_t i = 0; i < directory.count(); i++)
+    {
+        if (!directory.folder(i) && directory.item(i).find(CACHE_PREFIX) == 0)
+        {
+            remove((CACHE_PATH + directory.item(i)).c_str());
         }
-        return nlohmann::json::parse(retData, nullptr, false);
     }
-    return {};
 }
 
 static std::string sortTypeToString(CloudAccess::SortType type)
@@ -134,7 +365,7 @@ static std::string sortTypeToString(CloudAccess::SortType type)
 
 std::string CloudAccess::makeURL(int num, SortType type, bool ascend, bool legal)
 {
-    return "https://flagbrew.org/api/v1/gpss/all?pksm=yes&count=30&sort=" + sortTypeToString(type) +
+    return GPSS_URL "/api/v1/gpss/all?pksm=yes&count=30&sort=" + sortTypeToString(type) +
            "&dir=" + (ascend ? std::string("ascend") : std::string("descend")) + "&legal_only=" + (legal ? std::string("yes") : std::string("no")) +
            "&page=" + std::to_string(num);
 }
@@ -188,7 +419,7 @@ void incrementPkmDownloadCount(std::string* num)
 {
     if (num)
     {
-        if (auto fetch = Fetch::init("https://flagbrew.org/gpss/download/" + *num, false, true, nullptr, nullptr, ""))
+        if (auto fetch = Fetch::init(GPSS_URL "/gpss/download/" + *num, false, true, nullptr, nullptr, ""))
         {
             fetch->perform();
         }
@@ -228,7 +459,7 @@ std::shared_ptr<PKX> CloudAccess::fetchPkm(size_t slot) const
         }
 
         if (auto fetch = Fetch::init(
-                "https://flagbrew.org/gpss/download/" + current->data["results"][slot]["code"].get<std::string>(), false, true, nullptr, nullptr, ""))
+                GPSS_URL "/gpss/download/" + current->data["results"][slot]["code"].get<std::string>(), false, true, nullptr, nullptr, ""))
         {
             fetch->perform();
         }
@@ -242,12 +473,16 @@ bool CloudAccess::nextPage()
 {
     if (current->data["pages"].get<int>() > 1)
     {
-        pageNumber    = (pageNumber % current->data["pages"].get<int>()) + 1;
-        current->data = grabPage(pageNumber);
+        pageNumber = (pageNumber % current->data["pages"].get<int>()) + 1;
+        current    = takePage(pageNumber);
         if (current->data.is_discarded() || current->data.size() == 0)
         {
             isGood = false;
         }
+        else
+        {
+            prefetchPages();
+        }
     }
     return isGood;
 }
@@ -256,12 +491,16 @@ bool CloudAccess::prevPage()
 {
     if (current->data["pages"].get<int>() > 1)
     {
-        pageNumber    = pageNumber - 1 == 0 ? current->data["pages"].get<int>() : pageNumber - 1;
-        current->data = grabPage(pageNumber);
+        pageNumber = pageNumber - 1 == 0 ? current->data["pages"].get<int>() : pageNumber - 1;
+        current    = takePage(pageNumber);
         if (current->data.is_discarded() || current->data.size() == 0)
         {
             isGood = false;
         }
+        else
+        {
+            prefetchPages();
+        }
     }
     return isGood;
 }
@@ -284,7 +523,7 @@ bool CloudAccess::pkm(std::shared_ptr<PKX> mon)
     }
 
     std::string writeData = "";
-    if (auto fetch = Fetch::init("https://flagbrew.org/gpss/share", false, true, &writeData, headers, ""))
+    if (auto fetch = Fetch::init(GPSS_URL "/gpss/share", false, true, &writeData, headers, ""))
     {
         auto mimeThing       = fetch->mimeInit();
         curl_mimepart* field = curl_mime_addpart(mimeThing.get());
@@ -301,6 +540,8 @@ bool CloudAccess::pkm(std::shared_ptr<PKX> mon)
             switch (status_code)
             {
                 case 201:
+                    // Every cached page may have moved
+                    clearCache();
                     refreshPages();
                     // falls through
                 case 200:
@@ -38,7 +38,6 @@ STDirectory::STDirectory(const std::string& root)
     if (dir == NULL)
     {
         mError = (Result)errno;
-        closedir(dir);
         return;
     }
     else
@@ -26,123 +26,244 @@
 
 #include "mysterygift.hpp"
 
-static nlohmann::json mysteryGiftSheet;
-static u8* mysteryGiftData;
+#ifdef PKSM_HOST
+#define MG_PATH ROMFS_PATH "/mg/"
+#else
+#define MG_PATH "romfs:/mg/"
+#endif
 
-void MysteryGift::init(Generation g)
+namespace
 {
-    std::string path = StringUtils::format("romfs:/mg/sheet%s.json.bz2", genToCstring(g));
-    FILE* f          = fopen(path.c_str(), "rb");
-    if (f != NULL)
+    // Layout of mg/events*.bin, as written by common/EventsGalleryPacker/packer.py
+    constexpr char MAGIC[8]        = {'P', 'K', 'S', 'M', 'M', 'G', 'D', 'B'};
+    constexpr u32 VERSION          = 1;
+    constexpr size_t HEADER_SIZE   = 28;
+    constexpr size_t CARD_SIZE     = 20;
+    constexpr size_t EVENT_SIZE    = 26;
+    constexpr size_t CHUNK_SIZE    = 12;
+    constexpr size_t MAX_RAW_CHUNK = 64 * 1024;
+
+    // Matches the order of validTypes in the packer
+    enum CardType : u8
     {
-        fseek(f, 0, SEEK_END);
-        size_t size          = ftell(f);
-        unsigned int destLen = 700 * 1024; // big enough
-        char* s              = new char[size];
-        char* d              = new char[destLen]();
-        rewind(f);
-        fread(s, 1, size, f);
-
-        int r = BZ2_bzBuffToBuffDecompress(d, &destLen, s, size, 0, 0);
-        if (r == BZ_OK)
-        {
-            mysteryGiftSheet = nlohmann::json::parse(d);
-        }
+        WC7_CARD,
+        WC6_CARD,
+        WC7_FULL,
+        WC6_FULL,
+        PGF_CARD,
+        WC4_CARD,
+        PGT_CARD
+    };
 
-        delete[] s;
-        delete[] d;
-    }
+    struct Card
+    {
+        u32 name;
+        u32 game;
+        u16 chunk;
+        u16 offset;
+        u16 size;
+        u8 type;
+        u8 lang;
+        s16 species;
+        s8 form;
+        s8 gender;
+    };
 
-    if (mysteryGiftSheet.is_discarded())
+    struct Chunk
     {
-        mysteryGiftSheet            = nlohmann::json::object();
-        mysteryGiftSheet["gen"]     = "BAD";
-        mysteryGiftSheet["matches"] = nlohmann::json::array();
-    }
+        u32 offset;
+        u32 size;
+        u32 rawSize;
+    };
+
+    FILE* database = nullptr;
+    Generation databaseGen;
+    std::vector<Card> cards;
+    std::vector<MysteryGift::eventData> events;
+    std::vector<Chunk> chunks;
+    std::vector<char> strings;
+    // The most recently decompressed chunk, since cards that are looked at together tend to be next to each other
+    std::vector<u8> chunkData;
+    size_t loadedChunk = SIZE_MAX;
 
-    path = StringUtils::format("romfs:/mg/data%s.bin.bz2", genToCstring(g));
-    f    = fopen(path.c_str(), "rb");
-    if (f != NULL)
+    bool readTables()
     {
-        fseek(f, 0, SEEK_END);
-        u32 size             = ftell(f);
-        unsigned int destLen = 800 * 1024;
-        char* s              = new char[size];
-        mysteryGiftData      = new u8[destLen]();
-        rewind(f);
-        fread(s, 1, size, f);
-
-        int r = BZ2_bzBuffToBuffDecompress((char*)mysteryGiftData, &destLen, s, size, 0, 0);
-        if (r != BZ_OK)
+        u8 header[HEADER_SIZE];
+        if (fread(header, 1, HEADER_SIZE, database) != HEADER_SIZE || memcmp(header, MAGIC, sizeof(MAGIC)) ||
+            *(u32*)(header + 0x8) != VERSION)
         {
-            // TODO
+            return false;
         }
+        u32 cardCount   = *(u32*)(header + 0xC);
+        u32 eventCount  = *(u32*)(header + 0x10);
+        u32 chunkCount  = *(u32*)(header + 0x14);
+        u32 stringsSize = *(u32*)(header + 0x18);
 
-        delete[] s;
-    }
-}
-
-std::unique_ptr<WCX> MysteryGift::wondercard(size_t index)
-{
-    std::string gen = mysteryGiftSheet["gen"];
-
-    auto entry = mysteryGiftSheet["wondercards"][index];
+        std::vector<u8> tables(cardCount * CARD_SIZE + eventCount * EVENT_SIZE + chunkCount * CHUNK_SIZE);
+        strings.resize(stringsSize + 1);
+        if (fread(tables.data(), 1, tables.size(), database) != tables.size() ||
+            fread(strings.data(), 1, stringsSize, database) != stringsSize)
+        {
+            return false;
+        }
+        strings.back() = '\0';
 
-    u32 offset = entry["offset"];
+        u8* data = tables.data();
+        cards.resize(cardCount);
+        for (auto& card : cards)
+        {
+            card.name    = std::min(*(u32*)(data + 0x0), stringsSize);
+            card.game    = std::min(*(u32*)(data + 0x4), stringsSize);
+            card.chunk   = *(u16*)(data + 0x8);
+            card.offset  = *(u16*)(data + 0xA);
+            card.size    = *(u16*)(data + 0xC);
+            card.type    = data[0xE];
+            card.lang    = data[0xF];
+            card.species = *(s16*)(data + 0x10);
+            card.form    = data[0x12];
+            card.gender  = data[0x13];
+            data += CARD_SIZE;
+        }
+        events.resize(eventCount);
+        for (auto& event : events)
+        {
+            event.id      = *(u16*)(data + 0x0);
+            event.species = *(s16*)(data + 0x2);
+            event.form    = data[0x4];
+            event.gender  = data[0x5];
+            for (size_t i = 0; i < 10; i++)
+            {
+                u16 card       = *(u16*)(data + 0x6 + i * 2);
+                event.cards[i] = card < cardCount ? card : MysteryGift::eventData::NO_CARD;
+            }
+            data += EVENT_SIZE;
+        }
+        chunks.resize(chunkCount);
+        for (auto& chunk : chunks)
+        {
+            chunk.offset  = *(u32*)(data + 0x0);
+            chunk.size    = *(u32*)(data + 0x4);
+            chunk.rawSize = std::min(*(u32*)(data + 0x8), (u32)MAX_RAW_CHUNK);
+            data += CHUNK_SIZE;
+        }
+        return true;
+    }
 
-    if (gen == "4")
+    u8* cardData(const Card& card)
     {
-        std::unique_ptr<WCX> wc = nullptr;
-        if (entry["type"] == "wc4")
+        if (card.chunk >= chunks.size())
         {
-            wc = std::make_unique<WC4>(mysteryGiftData + offset);
+            return nullptr;
         }
-        else
+        if (loadedChunk != card.chunk)
         {
-            wc = std::make_unique<PGT>(mysteryGiftData + offset);
+            const Chunk& chunk = chunks[card.chunk];
+            std::vector<char> compressed(chunk.size);
+            unsigned int rawSize = chunk.rawSize;
+            chunkData.resize(rawSize);
+            loadedChunk = SIZE_MAX;
+            if (fseek(database, chunk.offset, SEEK_SET) || fread(compressed.data(), 1, chunk.size, database) != chunk.size ||
+                BZ2_bzBuffToBuffDecompress((char*)chunkData.data(), &rawSize, compressed.data(), chunk.size, 0, 0) != BZ_OK)
+            {
+                return nullptr;
+            }
+            chunkData.resize(rawSize);
+            loadedChunk = card.chunk;
         }
-        return wc;
+        if ((size_t)card.offset + card.size > chunkData.size())
+        {
+            return nullptr;
+        }
+        return chunkData.data() + card.offset;
     }
-    else if (gen == "5")
+}
+
+Language MysteryGift::eventData::firstLanguage() const
+{
+    for (size_t i = 0; i < 10; i++)
     {
-        PGF* pgf = new PGF(mysteryGiftData + offset);
-        return std::unique_ptr<WCX>(pgf);
+        if (cards[i] != NO_CARD)
+        {
+            return Language(i + 1);
+        }
     }
-    else if (gen == "6")
+    return Language::UNUSED;
+}
+
+void MysteryGift::init(Generation g)
+{
+    exit();
+    databaseGen      = g;
+    std::string path = StringUtils::format(MG_PATH "events%s.bin", genToCstring(g));
+    database         = fopen(path.c_str(), "rb");
+    if (database && !readTables())
     {
-        WC6* wc6 = new WC6(mysteryGiftData + offset, entry["type"].get<std::string>().find("full") != std::string::npos);
-        return std::unique_ptr<WCX>(wc6);
+        exit();
     }
-    else if (gen == "7")
+}
+
+std::unique_ptr<WCX> MysteryGift::wondercard(size_t index)
+{
+    if (index >= cards.size())
     {
-        WC7* wc7 = new WC7(mysteryGiftData + offset, entry["type"].get<std::string>().find("full") != std::string::npos);
-        return std::unique_ptr<WCX>(wc7);
+        return nullptr;
     }
-    else if (gen == "LGPE")
+
+    const Card& card = cards[index];
+    u8* data         = cardData(card);
+    if (!data)
     {
-        WB7* wb7 = new WB7(mysteryGiftData + offset, entry["type"].get<std::string>().find("full") != std::string::npos);
-        return std::unique_ptr<WCX>(wb7);
+        return nullptr;
     }
-    else
+
+    switch (databaseGen)
     {
-        return nullptr;
+        case Generation::FOUR:
+            if (card.type == WC4_CARD)
+            {
+                return std::make_unique<WC4>(data);
+            }
+            return std::make_unique<PGT>(data);
+        case Generation::FIVE:
+            return std::make_unique<PGF>(data);
+        case Generation::SIX:
+            return std::make_unique<WC6>(data, card.type == WC6_FULL);
+        case Generation::SEVEN:
+            return std::make_unique<WC7>(data, card.type == WC7_FULL);
+        case Generation::LGPE:
+            return std::make_unique<WB7>(data, card.type == WC7_FULL);
+        default:
+            return nullptr;
     }
 }
 
 void MysteryGift::exit(void)
 {
-    delete[] mysteryGiftData;
-    mysteryGiftSheet.clear();
+    if (database)
+    {
+        fclose(database);
+        database = nullptr;
+    }
+    // Swapped out rather than cleared so that the memory actually goes away; shrink_to_fit does nothing without exceptions
+    std::vector<Card>().swap(cards);
+    std::vector<MysteryGift::eventData>().swap(events);
+    std::vector<Chunk>().swap(chunks);
+    std::vector<char>().swap(strings);
+    std::vector<u8>().swap(chunkData);
+    loadedChunk = SIZE_MAX;
 }
 
-std::vector<nlohmann::json> MysteryGift::wondercards()
+const std::vector<MysteryGift::eventData>& MysteryGift::wondercards()
 {
-    return mysteryGiftSheet["matches"];
+    return events;
 }
 
 MysteryGift::giftData MysteryGift::wondercardInfo(size_t index)
 {
-    nlohmann::json entry = mysteryGiftSheet["wondercards"][index];
-    giftData ret(entry["name"].get<std::string>(), entry["game"].get<std::string>(), entry["species"].get<int>(), entry["form"].get<int>());
-    return ret;
+    if (index >= cards.size())
+    {
+        return giftData();
+    }
+    const Card& card = cards[index];
+    return giftData(strings.data() + card.name, strings.data() + card.game, card.species, card.form);
 }
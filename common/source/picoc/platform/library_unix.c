@@ -32,6 +32,7 @@ struct LibraryFunction UnixFunctions[] =
     { pkx_box_size,         "int pkx_box_size(enum Generation gen);" },
     { pkx_party_size,       "int pkx_party_size(enum Generation gen);" },
     { pkx_generate,         "void pkx_generate(char* data, int species);" },
+    { pkx_generate_batch,   "void pkx_generate_batch(char* data, int* species, int count);" },
     { pkx_is_valid,         "int pkx_is_valid(char* data, enum Generation gen);" },
     { pkx_set_value,        "void pkx_set_value(char* data, enum Generation gen, enum PKX_Field field, ...);" },
     { pkx_get_value,        "unsigned int pkx_get_value(char* data, enum Generation gen, enum PKX_Field field, ...);" },
@@ -0,0 +1,125 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "crc.hpp"
+#include <array>
+
+// Both checksums are computed eight bytes at a time using slicing-by-8 lookup tables,
+// which are generated at compile time from the single byte tables
+namespace
+{
+    using SliceTable = std::array<std::array<u16, 256>, 8>;
+
+    constexpr SliceTable makeCcittTable()
+    {
+        SliceTable table{};
+        for (u32 i = 0; i < 256; i++)
+        {
+            u16 crc = i << 8;
+            for (u32 j = 0; j < 8; j++)
+            {
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+            }
+            table[0][i] = crc;
+        }
+        for (u32 i = 0; i < 256; i++)
+        {
+            for (u32 slice = 1; slice < 8; slice++)
+            {
+                u16 prev        = table[slice - 1][i];
+                table[slice][i] = (prev << 8) ^ table[0][prev >> 8];
+            }
+        }
+        return table;
+    }
+
+    constexpr SliceTable makeCrc16Table()
+    {
+        SliceTable table{};
+        for (u32 i = 0; i < 256; i++)
+        {
+            u16 crc = i;
+            for (u32 j = 0; j < 8; j++)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+            }
+            table[0][i] = crc;
+        }
+        for (u32 i = 0; i < 256; i++)
+        {
+            for (u32 slice = 1; slice < 8; slice++)
+            {
+                u16 prev        = table[slice - 1][i];
+                table[slice][i] = (prev >> 8) ^ table[0][prev & 0xFF];
+            }
+        }
+        return table;
+    }
+
+    constexpr SliceTable ccittTable = makeCcittTable();
+    constexpr SliceTable crc16Table = makeCrc16Table();
+}
+
+u16 CRC::ccitt16(const u8* buf, u32 len)
+{
+    u16 crc = 0xFFFF;
+    for (; len >= 8; len -= 8, buf += 8)
+    {
+        crc ^= (buf[0] << 8) | buf[1];
+        crc = ccittTable[7][crc >> 8] ^ ccittTable[6][crc & 0xFF] ^ ccittTable[5][buf[2]] ^ ccittTable[4][buf[3]] ^ ccittTable[3][buf[4]] ^
+              ccittTable[2][buf[5]] ^ ccittTable[1][buf[6]] ^ ccittTable[0][buf[7]];
+    }
+    for (; len > 0; len--, buf++)
+    {
+        crc = (crc << 8) ^ ccittTable[0][(crc >> 8) ^ *buf];
+    }
+    return crc;
+}
+
+u16 CRC::crc16(const u8* buf, u32 len, u16 crc)
+{
+    for (; len >= 8; len -= 8, buf += 8)
+    {
+        crc ^= buf[0] | (buf[1] << 8);
+        crc = crc16Table[7][crc & 0xFF] ^ crc16Table[6][crc >> 8] ^ crc16Table[5][buf[2]] ^ crc16Table[4][buf[3]] ^ crc16Table[3][buf[4]] ^
+              crc16Table[2][buf[5]] ^ crc16Table[1][buf[6]] ^ crc16Table[0][buf[7]];
+    }
+    for (; len > 0; len--, buf++)
+    {
+        crc = (crc >> 8) ^ crc16Table[0][(crc ^ *buf) & 0xFF];
+    }
+    return crc;
+}
+
+u64 CRC::fnv1a64(const u8* buf, u32 len)
+{
+    u64 hash = 0xCBF29CE484222325;
+    for (; len > 0; len--, buf++)
+    {
+        hash = (hash ^ *buf) * 0x100000001B3;
+    }
+    return hash;
+}
@@ -25,6 +25,8 @@
  */
 
 #include "fetch.hpp"
+#include "platform.h"
+#include <atomic>
 #include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -32,6 +34,90 @@
 
 #define SPEED_TOO_SLOW 300
 #define CALLS_TOO_SLOW 100
+// Idle handles kept around for reuse; each one keeps its own connections open on top of the shared ones
+#define POOL_SIZE 4
+
+namespace
+{
+#if defined(_3DS)
+    typedef LightLock Lock;
+    void lockInit(Lock* lock)
+    {
+        LightLock_Init(lock);
+    }
+    void lock(Lock* lock)
+    {
+        LightLock_Lock(lock);
+    }
+    void unlock(Lock* lock)
+    {
+        LightLock_Unlock(lock);
+    }
+#elif defined(__SWITCH__)
+    typedef Mutex Lock;
+    void lockInit(Lock* lock)
+    {
+        mutexInit(lock);
+    }
+    void lock(Lock* lock)
+    {
+        mutexLock(lock);
+    }
+    void unlock(Lock* lock)
+    {
+        mutexUnlock(lock);
+    }
+#endif
+
+    bool initialized = false;
+    CURLSH* share    = nullptr;
+    // One for each curl_lock_data the share can ask for, and one for the pool
+    Lock shareLocks[CURL_LOCK_DATA_LAST];
+    Lock poolLock;
+    std::vector<CURL*> pool;
+
+    std::atomic<u32> transfers   = 0;
+    std::atomic<u32> connections = 0;
+    std::atomic<u64> bytes       = 0;
+
+    void shareLock(CURL*, curl_lock_data data, curl_lock_access, void*)
+    {
+        lock(&shareLocks[data]);
+    }
+
+    void shareUnlock(CURL*, curl_lock_data data, void*)
+    {
+        unlock(&shareLocks[data]);
+    }
+
+    CURL* acquire()
+    {
+        CURL* ret = nullptr;
+        if (initialized)
+        {
+            lock(&poolLock);
+            if (!pool.empty())
+            {
+                ret = pool.back();
+                pool.pop_back();
+            }
+            unlock(&poolLock);
+        }
+        if (ret)
+        {
+            curl_easy_reset(ret);
+        }
+        else
+        {
+            ret = curl_easy_init();
+        }
+        if (ret && share)
+        {
+            curl_easy_setopt(ret, CURLOPT_SHARE, share);
+        }
+        return ret;
+    }
+}
 
 static size_t string_write_callback(char* ptr, size_t size, size_t nmemb, void* userdata)
 {
@@ -40,11 +126,87 @@ static size_t string_write_callback(char* ptr, size_t size, size_t nmemb, void*
     return size * nmemb;
 }
 
+Result Fetch::initialize(void)
+{
+    if (initialized)
+    {
+        return 0;
+    }
+    CURLcode res = curl_global_init(CURL_GLOBAL_ALL);
+    if (res != CURLE_OK)
+    {
+        return -res;
+    }
+    for (auto& dataLock : shareLocks)
+    {
+        lockInit(&dataLock);
+    }
+    lockInit(&poolLock);
+    if ((share = curl_share_init()))
+    {
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, shareLock);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, shareUnlock);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    }
+    initialized = true;
+    return 0;
+}
+
+void Fetch::exit(void)
+{
+    if (initialized)
+    {
+        // Handles that are still in use at this point belong to threads that should have been joined already
+        lock(&poolLock);
+        for (auto handle : pool)
+        {
+            curl_easy_cleanup(handle);
+        }
+        pool.clear();
+        unlock(&poolLock);
+        initialized = false;
+        if (share)
+        {
+            curl_share_cleanup(share);
+            share = nullptr;
+        }
+        curl_global_cleanup();
+    }
+}
+
+Fetch::Stats Fetch::stats(void)
+{
+    return {transfers, connections, bytes};
+}
+
+void Fetch::release(CURL* handle)
+{
+    if (handle)
+    {
+        if (initialized)
+        {
+            lock(&poolLock);
+            if (pool.size() < POOL_SIZE)
+            {
+                pool.push_back(handle);
+                handle = nullptr;
+            }
+            unlock(&poolLock);
+        }
+        if (handle)
+        {
+            curl_easy_cleanup(handle);
+        }
+    }
+}
+
 std::unique_ptr<Fetch> Fetch::init(
     const std::string& url, bool post, bool ssl, std::string* writeData, struct curl_slist* headers, const std::string& postdata)
 {
     auto fetch  = std::unique_ptr<Fetch>(new Fetch);
-    fetch->curl = std::unique_ptr<CURL, decltype(curl_easy_cleanup)*>(curl_easy_init(), &curl_easy_cleanup);
+    fetch->curl = std::unique_ptr<CURL, void (*)(CURL*)>(acquire(), &release);
     if (fetch->curl)
     {
         fetch->setopt(CURLOPT_URL, url.c_str());
@@ -76,81 +238,183 @@ std::unique_ptr<Fetch> Fetch::init(
     return fetch;
 }
 
+void Fetch::record()
+{
+    long newConnections = 0;
+    curl_off_t size     = 0;
+    getinfo(CURLINFO_NUM_CONNECTS, &newConnections);
+    getinfo(CURLINFO_SIZE_DOWNLOAD_T, &size);
+    transfers++;
+    connections += newConnections;
+    bytes += size;
+}
+
 CURLcode Fetch::perform()
 {
-    return curl_easy_perform(curl.get());
+    CURLcode ret = curl_easy_perform(curl.get());
+    record();
+    return ret;
+}
+
+std::vector<CURLcode> Fetch::performAll(const std::vector<std::unique_ptr<Fetch>>& fetches)
+{
+    std::vector<CURLcode> ret(fetches.size(), CURLE_FAILED_INIT);
+    CURLM* multi = curl_multi_init();
+    if (!multi)
+    {
+        return ret;
+    }
+    for (auto& fetch : fetches)
+    {
+        if (fetch && fetch->curl)
+        {
+            curl_multi_add_handle(multi, fetch->curl.get());
+        }
+    }
+
+    int running = 0;
+    do
+    {
+        if (curl_multi_perform(multi, &running) != CURLM_OK)
+        {
+            break;
+        }
+        if (running > 0)
+        {
+            curl_multi_wait(multi, nullptr, 0, 100, nullptr);
+        }
+        int left;
+        while (CURLMsg* message = curl_multi_info_read(multi, &left))
+        {
+            if (message->msg == CURLMSG_DONE)
+            {
+                for (size_t i = 0; i < fetches.size(); i++)
+                {
+                    if (fetches[i] && fetches[i]->curl.get() == message->easy_handle)
+                    {
+                        ret[i] = message->data.result;
+                    }
+                }
+            }
+        }
+    } while (running > 0);
+
+    for (auto& fetch : fetches)
+    {
+        if (fetch && fetch->curl)
+        {
+            curl_multi_remove_handle(multi, fetch->curl.get());
+            fetch->record();
+        }
+    }
+    curl_multi_cleanup(multi);
+    return ret;
 }
 
 struct callbackWrapper
 {
     curl_xferinfo_callback progress;
     void* progressInfo;
+    curl_off_t oldDlNow;
+    int timesTooSlow;
 };
 
 static int down_callback_wrap(void* wrapper, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
 {
-    callbackWrapper* data      = (callbackWrapper*)wrapper;
-    static curl_off_t oldDlNow = dlnow;
-    static int timesTooSlow    = 0;
-    if (oldDlNow + SPEED_TOO_SLOW >= dlnow)
+    callbackWrapper* data = (callbackWrapper*)wrapper;
+    if (data->oldDlNow + SPEED_TOO_SLOW >= dlnow)
     {
-        timesTooSlow++;
-        oldDlNow = dlnow;
+        data->timesTooSlow++;
+        data->oldDlNow = dlnow;
     }
-    if (timesTooSlow >= CALLS_TOO_SLOW)
+    if (data->timesTooSlow >= CALLS_TOO_SLOW)
     {
         return 1;
     }
     else
     {
-        if (timesTooSlow > 0)
+        if (data->timesTooSlow > 0)
         {
-            timesTooSlow--;
+            data->timesTooSlow--;
         }
-        oldDlNow = dlnow;
+        data->oldDlNow = dlnow;
         return data->progress(data->progressInfo, dltotal, dlnow, ultotal, ulnow);
     }
 }
 
-Result Fetch::download(
-    const std::string& url, const std::string& path, const std::string& postData, curl_xferinfo_callback progress, void* progressInfo)
+// Sets a transfer up to write into file, with the stall detection above if it reports progress
+static std::unique_ptr<Fetch> initDownload(const Fetch::Download& download, FILE* file, callbackWrapper* wrapper)
 {
-    FILE* file = fopen(path.c_str(), "wb");
-    if (!file)
-    {
-        return -errno;
-    }
-
-    bool doPost             = !postData.empty();
-    callbackWrapper wrapper = {progress, progressInfo};
-    if (auto fetch = Fetch::init(url, doPost, true, nullptr, nullptr, postData))
+    bool doPost = !download.postData.empty();
+    auto fetch  = Fetch::init(download.url, doPost, true, nullptr, nullptr, download.postData);
+    if (fetch)
     {
         fetch->setopt(CURLOPT_WRITEFUNCTION, fwrite);
         fetch->setopt(CURLOPT_WRITEDATA, file);
-        if (progress)
+        if (download.progress)
         {
+            *wrapper = {download.progress, download.progressInfo, 0, 0};
             fetch->setopt(CURLOPT_NOPROGRESS, 0L);
             fetch->setopt(CURLOPT_XFERINFOFUNCTION, down_callback_wrap);
-            fetch->setopt(CURLOPT_XFERINFODATA, &wrapper);
+            fetch->setopt(CURLOPT_XFERINFODATA, wrapper);
             fetch->setopt(CURLOPT_LOW_SPEED_LIMIT, 0L);
             fetch->setopt(CURLOPT_LOW_SPEED_TIME, 0L);
         }
-        CURLcode cres = fetch->perform();
+    }
+    return fetch;
+}
 
-        fclose(file);
+Result Fetch::download(
+    const std::string& url, const std::string& path, const std::string& postData, curl_xferinfo_callback progress, void* progressInfo)
+{
+    return download(std::vector<Download>{{url, path, postData, progress, progressInfo}})[0];
+}
 
-        if (cres != CURLE_OK)
+std::vector<Result> Fetch::download(const std::vector<Download>& downloads)
+{
+    std::vector<Result> ret(downloads.size(), 0);
+    std::vector<FILE*> files(downloads.size(), nullptr);
+    std::vector<callbackWrapper> wrappers(downloads.size());
+    std::vector<std::unique_ptr<Fetch>> fetches(downloads.size());
+    for (size_t i = 0; i < downloads.size(); i++)
+    {
+        if (!(files[i] = fopen(downloads[i].path.c_str(), "wb")))
         {
-            remove(path.c_str());
-            return -cres;
+            ret[i] = -errno;
         }
+        else if (!(fetches[i] = initDownload(downloads[i], files[i], &wrappers[i])))
+        {
+            ret[i] = -1;
+        }
+    }
+
+    std::vector<CURLcode> results;
+    if (fetches.size() == 1)
+    {
+        results.push_back(fetches[0] ? fetches[0]->perform() : CURLE_FAILED_INIT);
     }
     else
     {
-        return -1;
+        results = performAll(fetches);
     }
 
-    return 0;
+    for (size_t i = 0; i < downloads.size(); i++)
+    {
+        if (files[i])
+        {
+            fclose(files[i]);
+            if (fetches[i] && results[i] != CURLE_OK)
+            {
+                remove(downloads[i].path.c_str());
+                ret[i] = -results[i];
+            }
+            else if (!fetches[i])
+            {
+                remove(downloads[i].path.c_str());
+            }
+        }
+    }
+    return ret;
 }
 
 std::unique_ptr<curl_mime, decltype(curl_mime_free)*> Fetch::mimeInit()
@@ -27,14 +27,19 @@
 #include "utils.hpp"
 #include "g4text.h"
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <map>
 #include <queue>
+#include <utility>
 #include <vector>
 
 #if defined(_3DS)
 #include <3ds.h>
 #elif defined(__SWITCH__)
 #include <switch.h>
+#elif defined(PKSM_HOST)
+#include <host/utf.h>
 #endif
 
 std::string StringUtils::format(std::string fmt_str, ...)
@@ -48,75 +53,219 @@ std::string StringUtils::format(std::string fmt_str, ...)
     return std::string(formatted.get());
 }
 
-std::u16string StringUtils::UTF8toUTF16(const std::string& src)
+namespace
 {
-    std::u16string ret;
-    ret.reserve(src.size());
-    for (size_t i = 0; i < src.size(); i++)
+    // The character swaps of transString45 and transString67 as lookup tables. Only a handful of 256 character pages hold swapped characters,
+    // and page 0 of the table, which every other page points to, means "leave it as it is"
+    struct SwapTable
     {
-        u16 codepoint = 0xFFFD;
-        int iMod      = 0;
-        if (src[i] & 0x80 && src[i] & 0x40 && src[i] & 0x20 && !(src[i] & 0x10) && i + 2 < src.size())
-        {
-            codepoint = src[i] & 0x0F;
-            codepoint = codepoint << 6 | (src[i + 1] & 0x3F);
-            codepoint = codepoint << 6 | (src[i + 2] & 0x3F);
-            iMod      = 2;
-        }
-        else if (src[i] & 0x80 && src[i] & 0x40 && !(src[i] & 0x20) && i + 1 < src.size())
-        {
-            codepoint = src[i] & 0x1F;
-            codepoint = codepoint << 6 | (src[i + 1] & 0x3F);
-            iMod      = 1;
-        }
-        else if (!(src[i] & 0x80))
+        std::array<u8, 256> page;
+        std::array<std::array<char16_t, 256>, 4> values;
+
+        char16_t operator()(char16_t c) const { return page[c >> 8] ? values[page[c >> 8]][c & 0xFF] : c; }
+    };
+
+    template <size_t N>
+    constexpr SwapTable makeSwapTable(const std::pair<char16_t, char16_t> (&swaps)[N])
+    {
+        SwapTable ret{};
+        u8 nextPage = 1;
+        for (size_t i = 0; i < N * 2; i++)
         {
-            codepoint = src[i];
+            char16_t from = i < N ? swaps[i].first : swaps[i - N].second;
+            char16_t to   = i < N ? swaps[i].second : swaps[i - N].first;
+            if (ret.page[from >> 8] == 0)
+            {
+                ret.page[from >> 8] = nextPage;
+                for (size_t j = 0; j < 256; j++)
+                {
+                    ret.values[nextPage][j] = (from & 0xFF00) | j;
+                }
+                nextPage++;
+            }
+            ret.values[ret.page[from >> 8]][from & 0xFF] = to;
         }
+        return ret;
+    }
 
-        ret.push_back((char16_t)codepoint);
-        i += iMod;
+    constexpr std::pair<char16_t, char16_t> swaps45[] = {{u'\u2227', u'\uE0A9'}, {u'\u2228', u'\uE0AA'}, {u'\u2460', u'\uE081'},
+        {u'\u2461', u'\uE082'}, {u'\u2462', u'\uE083'}, {u'\u2463', u'\uE084'}, {u'\u2464', u'\uE085'}, {u'\u2465', u'\uE086'},
+        {u'\u2466', u'\uE087'}, {u'\u2469', u'\uE068'}, {u'\u246A', u'\uE069'}, {u'\u246B', u'\uE0AB'}, {u'\u246C', u'\uE08D'},
+        {u'\u246D', u'\uE08E'}, {u'\u246E', u'\uE08F'}, {u'\u246F', u'\uE090'}, {u'\u2470', u'\uE091'}, {u'\u2471', u'\uE092'},
+        {u'\u2472', u'\uE093'}, {u'\u2473', u'\uE094'}, {u'\u2474', u'\uE095'}, {u'\u2475', u'\uE096'}, {u'\u2476', u'\uE097'},
+        {u'\u2477', u'\uE098'}, {u'\u2478', u'\uE099'}, {u'\u2479', u'\uE09A'}, {u'\u247A', u'\uE09B'}, {u'\u247B', u'\uE09C'},
+        {u'\u247C', u'\uE09D'}, {u'\u247D', u'\uE09E'}, {u'\u247E', u'\uE09F'}, {u'\u247F', u'\uE0A0'}, {u'\u2480', u'\uE0A1'},
+        {u'\u2481', u'\uE0A2'}, {u'\u2482', u'\uE0A3'}, {u'\u2483', u'\uE0A4'}, {u'\u2484', u'\uE0A5'}, {u'\u2485', u'\uE06A'},
+        {u'\u2486', u'\uE0A7'}, {u'\u2487', u'\uE0A8'}};
+    constexpr std::pair<char16_t, char16_t> swaps67[] = {{u'\uE088', u'\u00D7'}, {u'\uE089', u'\u00F7'}, {u'\uE08A', u'\uE068'},
+        {u'\uE08B', u'\uE069'}, {u'\uE08C', u'\uE0AB'}, {u'\uE0A6', u'\uE06A'}};
+
+    constexpr SwapTable swap45 = makeSwapTable(swaps45);
+    constexpr SwapTable swap67 = makeSwapTable(swaps67);
+
+    // No swapped character is ASCII, so runs of ASCII are copied straight through. Eight bytes are checked per word, and on the UTF-16 side
+    // a non-ASCII unit or a NUL ends the run, since NUL may be the terminator
+    constexpr u64 ASCII8  = 0x8080808080808080;
+    constexpr u64 ASCII16 = 0xFF80FF80FF80FF80;
+
+    bool asciiRun16(const char16_t* data)
+    {
+        u64 words[2];
+        memcpy(words, data, sizeof(words));
+        u64 nul = ((words[0] - 0x0001000100010001) & ~words[0]) | ((words[1] - 0x0001000100010001) & ~words[1]);
+        return !((words[0] | words[1]) & ASCII16) && !(nul & 0x8000800080008000);
     }
-    return ret;
-}
 
-static std::string utf16DataToUtf8(const char16_t* data, size_t size, char16_t delim = 0)
-{
-    std::string ret;
-    ret.reserve(size);
-    char addChar[4] = {0};
-    for (size_t i = 0; i < size; i++)
+    bool asciiRun8(const char* data)
     {
-        if (data[i] == delim)
-        {
-            return ret;
-        }
-        else if (data[i] < 0x0080)
+        u64 words[2];
+        memcpy(words, data, sizeof(words));
+        return !((words[0] | words[1]) & ASCII8);
+    }
+
+    // Decodes UTF-8 the way PKSM always has: two and three byte sequences are taken as they are, anything else that isn't ASCII becomes
+    // U+FFFD, one per byte. Returns the number of code units written, at most outLen
+    size_t utf8ToUtf16(const char* src, size_t srcLen, const SwapTable* swap, char16_t* out, size_t outLen)
+    {
+        size_t i = 0, written = 0;
+        while (i < srcLen && written < outLen)
         {
-            addChar[0] = data[i];
-            addChar[1] = '\0';
+            if (i + 16 <= srcLen && written + 16 <= outLen && asciiRun8(src + i))
+            {
+                for (size_t j = 0; j < 16; j++)
+                {
+                    out[written + j] = (u8)src[i + j];
+                }
+                i += 16;
+                written += 16;
+                continue;
+            }
+
+            u8 lead            = src[i];
+            char16_t codepoint = 0xFFFD;
+            if ((lead & 0xF0) == 0xE0 && i + 2 < srcLen)
+            {
+                codepoint = (lead & 0x0F) << 12 | (src[i + 1] & 0x3F) << 6 | (src[i + 2] & 0x3F);
+                i += 3;
+            }
+            else if ((lead & 0xE0) == 0xC0 && i + 1 < srcLen)
+            {
+                codepoint = (lead & 0x1F) << 6 | (src[i + 1] & 0x3F);
+                i += 2;
+            }
+            else
+            {
+                if (!(lead & 0x80))
+                {
+                    codepoint = lead;
+                }
+                i++;
+            }
+            out[written++] = swap ? (*swap)(codepoint) : codepoint;
         }
-        else if (data[i] < 0x0800)
+        return written;
+    }
+
+    // Encodes up to len code units, stopping early at term. Returns the number of bytes written; a character that doesn't fit in outLen is left
+    // out along with everything after it
+    size_t utf16ToUtf8(const char16_t* data, size_t len, char16_t term, const SwapTable* swap, char* out, size_t outLen)
+    {
+        const bool asciiTerm = term != 0 && term < 0x80;
+        size_t written       = 0;
+        for (size_t i = 0; i < len; i++)
         {
-            addChar[0] = 0xC0 | ((data[i] >> 6) & 0x1F);
-            addChar[1] = 0x80 | (data[i] & 0x3F);
-            addChar[2] = '\0';
+            if (!asciiTerm && i + 8 <= len && written + 8 <= outLen && asciiRun16(data + i))
+            {
+                for (size_t j = 0; j < 8; j++)
+                {
+                    out[written + j] = data[i + j];
+                }
+                i += 7;
+                written += 8;
+                continue;
+            }
+
+            if (data[i] == term)
+            {
+                break;
+            }
+            char16_t codepoint = swap ? (*swap)(data[i]) : data[i];
+            if (codepoint == 0)
+            {
+                continue; // Only reachable with a non-zero terminator, and never written out
+            }
+            else if (codepoint < 0x0080)
+            {
+                if (written + 1 > outLen)
+                {
+                    break;
+                }
+                out[written++] = codepoint;
+            }
+            else if (codepoint < 0x0800)
+            {
+                if (written + 2 > outLen)
+                {
+                    break;
+                }
+                out[written++] = 0xC0 | ((codepoint >> 6) & 0x1F);
+                out[written++] = 0x80 | (codepoint & 0x3F);
+            }
+            else
+            {
+                if (written + 3 > outLen)
+                {
+                    break;
+                }
+                out[written++] = 0xE0 | ((codepoint >> 12) & 0x0F);
+                out[written++] = 0x80 | ((codepoint >> 6) & 0x3F);
+                out[written++] = 0x80 | (codepoint & 0x3F);
+            }
         }
-        else
+        return written;
+    }
+
+    std::string getUTF8(const u8* data, int ofs, int len, char16_t term, const SwapTable* swap)
+    {
+        std::string ret(len * 3, '\0');
+        ret.resize(utf16ToUtf8((const char16_t*)(data + ofs), len, term, swap, ret.data(), ret.size()));
+        return ret;
+    }
+
+    void setUTF8(u8* data, const std::string& v, int ofs, int len, char16_t terminator, char16_t padding, const SwapTable* swap)
+    {
+        char16_t* out = (char16_t*)(data + ofs);
+        int i         = utf8ToUtf16(v.data(), v.size(), swap, out, len - 1); // len includes terminator
+        out[i++]      = terminator;
+        for (; i < len; i++)
         {
-            addChar[0] = 0xE0 | ((data[i] >> 12) & 0x0F);
-            addChar[1] = 0x80 | ((data[i] >> 6) & 0x3F);
-            addChar[2] = 0x80 | (data[i] & 0x3F);
-            addChar[3] = '\0';
+            out[i] = padding;
         }
-        ret.append(addChar);
     }
+}
+
+std::u16string StringUtils::UTF8toUTF16(const std::string& src)
+{
+    std::u16string ret(src.size(), u'\0');
+    ret.resize(utf8ToUtf16(src.data(), src.size(), nullptr, ret.data(), ret.size()));
     return ret;
 }
 
+size_t StringUtils::UTF8toUTF16(const char* src, size_t srcLen, char16_t* out, size_t outLen)
+{
+    return utf8ToUtf16(src, srcLen, nullptr, out, outLen);
+}
+
 std::string StringUtils::UTF16toUTF8(const std::u16string& src)
 {
-    return utf16DataToUtf8(src.data(), src.size());
+    std::string ret(src.size() * 3, '\0');
+    ret.resize(utf16ToUtf8(src.data(), src.size(), 0, nullptr, ret.data(), ret.size()));
+    return ret;
+}
+
+size_t StringUtils::UTF16toUTF8(const char16_t* src, size_t srcLen, char* out, size_t outLen)
+{
+    return utf16ToUtf8(src, srcLen, 0, nullptr, out, outLen);
 }
 
 std::u16string StringUtils::getU16String(const u8* data, int ofs, int len, char16_t term)
@@ -137,7 +286,17 @@ std::u16string StringUtils::getU16String(const u8* data, int ofs, int len, char1
 
 std::string StringUtils::getString(const u8* data, int ofs, int len, char16_t term)
 {
-    return utf16DataToUtf8((char16_t*)(data + ofs), len, term);
+    return getUTF8(data, ofs, len, term, nullptr);
+}
+
+std::string StringUtils::getString45(const u8* data, int ofs, int len, char16_t term)
+{
+    return getUTF8(data, ofs, len, term, &swap45);
+}
+
+std::string StringUtils::getString67(const u8* data, int ofs, int len, char16_t term)
+{
+    return getUTF8(data, ofs, len, term, &swap67);
 }
 
 void StringUtils::setString(u8* data, const std::u16string& v, int ofs, int len, char16_t terminator, char16_t padding)
@@ -156,7 +315,17 @@ void StringUtils::setString(u8* data, const std::u16string& v, int ofs, int len,
 
 void StringUtils::setString(u8* data, const std::string& v, int ofs, int len, char16_t terminator, char16_t padding)
 {
-    setString(data, UTF8toUTF16(v), ofs, len, terminator, padding);
+    setUTF8(data, v, ofs, len, terminator, padding, nullptr);
+}
+
+void StringUtils::setString45(u8* data, const std::string& v, int ofs, int len, char16_t terminator, char16_t padding)
+{
+    setUTF8(data, v, ofs, len, terminator, padding, &swap45);
+}
+
+void StringUtils::setString67(u8* data, const std::string& v, int ofs, int len, char16_t terminator, char16_t padding)
+{
+    setUTF8(data, v, ofs, len, terminator, padding, &swap67);
 }
 
 std::string StringUtils::getString4(const u8* data, int ofs, int len)
@@ -171,8 +340,7 @@ std::string StringUtils::getString4(const u8* data, int ofs, int len)
         temp = *(u16*)(data + ofs + i);
         if (temp == 0xFFFF)
             break;
-        u16 index = std::distance(G4Values, std::find(G4Values, G4Values + G4TEXT_LENGTH, temp));
-        codepoint = G4Chars[index];
+        codepoint = G4Text::toChar(temp);
         if (codepoint == 0xFFFF)
             break;
         if (codepoint < 0x0080)
@@ -219,13 +387,11 @@ std::vector<u16> StringUtils::stringToG4(const std::string& v)
                 codepoint = codepoint << 6 | (v[charIndex + 1] & 0x3F);
                 charIndex += 1;
             }
-            size_t index = std::distance(G4Chars, std::find(G4Chars, G4Chars + G4TEXT_LENGTH, codepoint));
-            ret.push_back(index < G4TEXT_LENGTH ? G4Values[index] : 0x0000);
+            ret.push_back(G4Text::toValue(codepoint));
         }
         else
         {
-            size_t index = std::distance(G4Chars, std::find(G4Chars, G4Chars + G4TEXT_LENGTH, v[charIndex]));
-            ret.push_back(index < G4TEXT_LENGTH ? G4Values[index] : 0x0000);
+            ret.push_back(G4Text::toValue(v[charIndex]));
         }
     }
     if (ret.back() != 0xFFFF)
@@ -257,13 +423,11 @@ void StringUtils::setString4(u8* data, const std::string& v, int ofs, int len)
                 codepoint = codepoint << 6 | (v[charIndex + 1] & 0x3F);
                 charIndex += 1;
             }
-            size_t index     = std::distance(G4Chars, std::find(G4Chars, G4Chars + G4TEXT_LENGTH, codepoint));
-            output[outIndex] = (index < G4TEXT_LENGTH ? G4Values[index] : 0x0000);
+            output[outIndex] = G4Text::toValue(codepoint);
         }
         else
         {
-            size_t index     = std::distance(G4Chars, std::find(G4Chars, G4Chars + G4TEXT_LENGTH, v[charIndex]));
-            output[outIndex] = (index < G4TEXT_LENGTH ? G4Values[index] : 0x0000);
+            output[outIndex] = G4Text::toValue(v[charIndex]);
         }
     }
     output[outIndex >= len ? len - 1 : outIndex] = 0xFFFF;
@@ -304,257 +468,6 @@ std::string& StringUtils::toLower(std::string& in)
     return in;
 }
 
-static u32 swapCodepoints45(u32 codepoint)
-{
-    switch (codepoint)
-    {
-        case u'\u2227':
-            codepoint = u'\uE0A9';
-            break;
-        case u'\u2228':
-            codepoint = u'\uE0AA';
-            break;
-        case u'\u2460':
-            codepoint = u'\uE081';
-            break;
-        case u'\u2461':
-            codepoint = u'\uE082';
-            break;
-        case u'\u2462':
-            codepoint = u'\uE083';
-            break;
-        case u'\u2463':
-            codepoint = u'\uE084';
-            break;
-        case u'\u2464':
-            codepoint = u'\uE085';
-            break;
-        case u'\u2465':
-            codepoint = u'\uE086';
-            break;
-        case u'\u2466':
-            codepoint = u'\uE087';
-            break;
-        case u'\u2469':
-            codepoint = u'\uE068';
-            break;
-        case u'\u246A':
-            codepoint = u'\uE069';
-            break;
-        case u'\u246B':
-            codepoint = u'\uE0AB';
-            break;
-        case u'\u246C':
-            codepoint = u'\uE08D';
-            break;
-        case u'\u246D':
-            codepoint = u'\uE08E';
-            break;
-        case u'\u246E':
-            codepoint = u'\uE08F';
-            break;
-        case u'\u246F':
-            codepoint = u'\uE090';
-            break;
-        case u'\u2470':
-            codepoint = u'\uE091';
-            break;
-        case u'\u2471':
-            codepoint = u'\uE092';
-            break;
-        case u'\u2472':
-            codepoint = u'\uE093';
-            break;
-        case u'\u2473':
-            codepoint = u'\uE094';
-            break;
-        case u'\u2474':
-            codepoint = u'\uE095';
-            break;
-        case u'\u2475':
-            codepoint = u'\uE096';
-            break;
-        case u'\u2476':
-            codepoint = u'\uE097';
-            break;
-        case u'\u2477':
-            codepoint = u'\uE098';
-            break;
-        case u'\u2478':
-            codepoint = u'\uE099';
-            break;
-        case u'\u2479':
-            codepoint = u'\uE09A';
-            break;
-        case u'\u247A':
-            codepoint = u'\uE09B';
-            break;
-        case u'\u247B':
-            codepoint = u'\uE09C';
-            break;
-        case u'\u247C':
-            codepoint = u'\uE09D';
-            break;
-        case u'\u247D':
-            codepoint = u'\uE09E';
-            break;
-        case u'\u247E':
-            codepoint = u'\uE09F';
-            break;
-        case u'\u247F':
-            codepoint = u'\uE0A0';
-            break;
-        case u'\u2480':
-            codepoint = u'\uE0A1';
-            break;
-        case u'\u2481':
-            codepoint = u'\uE0A2';
-            break;
-        case u'\u2482':
-            codepoint = u'\uE0A3';
-            break;
-        case u'\u2483':
-            codepoint = u'\uE0A4';
-            break;
-        case u'\u2484':
-            codepoint = u'\uE0A5';
-            break;
-        case u'\u2485':
-            codepoint = u'\uE06A';
-            break;
-        case u'\u2486':
-            codepoint = u'\uE0A7';
-            break;
-        case u'\u2487':
-            codepoint = u'\uE0A8';
-            break;
-
-        case u'\uE0A9':
-            codepoint = u'\u2227';
-            break;
-        case u'\uE0AA':
-            codepoint = u'\u2228';
-            break;
-        case u'\uE081':
-            codepoint = u'\u2460';
-            break;
-        case u'\uE082':
-            codepoint = u'\u2461';
-            break;
-        case u'\uE083':
-            codepoint = u'\u2462';
-            break;
-        case u'\uE084':
-            codepoint = u'\u2463';
-            break;
-        case u'\uE085':
-            codepoint = u'\u2464';
-            break;
-        case u'\uE086':
-            codepoint = u'\u2465';
-            break;
-        case u'\uE087':
-            codepoint = u'\u2466';
-            break;
-        case u'\uE068':
-            codepoint = u'\u2469';
-            break;
-        case u'\uE069':
-            codepoint = u'\u246A';
-            break;
-        case u'\uE0AB':
-            codepoint = u'\u246B';
-            break;
-        case u'\uE08D':
-            codepoint = u'\u246C';
-            break;
-        case u'\uE08E':
-            codepoint = u'\u246D';
-            break;
-        case u'\uE08F':
-            codepoint = u'\u246E';
-            break;
-        case u'\uE090':
-            codepoint = u'\u246F';
-            break;
-        case u'\uE091':
-            codepoint = u'\u2470';
-            break;
-        case u'\uE092':
-            codepoint = u'\u2471';
-            break;
-        case u'\uE093':
-            codepoint = u'\u2472';
-            break;
-        case u'\uE094':
-            codepoint = u'\u2473';
-            break;
-        case u'\uE095':
-            codepoint = u'\u2474';
-            break;
-        case u'\uE096':
-            codepoint = u'\u2475';
-            break;
-        case u'\uE097':
-            codepoint = u'\u2476';
-            break;
-        case u'\uE098':
-            codepoint = u'\u2477';
-            break;
-        case u'\uE099':
-            codepoint = u'\u2478';
-            break;
-        case u'\uE09A':
-            codepoint = u'\u2479';
-            break;
-        case u'\uE09B':
-            codepoint = u'\u247A';
-            break;
-        case u'\uE09C':
-            codepoint = u'\u247B';
-            break;
-        case u'\uE09D':
-            codepoint = u'\u247C';
-            break;
-        case u'\uE09E':
-            codepoint = u'\u247D';
-            break;
-        case u'\uE09F':
-            codepoint = u'\u247E';
-            break;
-        case u'\uE0A0':
-            codepoint = u'\u247F';
-            break;
-        case u'\uE0A1':
-            codepoint = u'\u2480';
-            break;
-        case u'\uE0A2':
-            codepoint = u'\u2481';
-            break;
-        case u'\uE0A3':
-            codepoint = u'\u2482';
-            break;
-        case u'\uE0A4':
-            codepoint = u'\u2483';
-            break;
-        case u'\uE0A5':
-            codepoint = u'\u2484';
-            break;
-        case u'\uE06A':
-            codepoint = u'\u2485';
-            break;
-        case u'\uE0A7':
-            codepoint = u'\u2486';
-            break;
-        case u'\uE0A8':
-            codepoint = u'\u2487';
-            break;
-        default:
-            break;
-    }
-    return codepoint;
-}
-
 std::string StringUtils::transString45(const std::string& str)
 {
     std::string ret = str;
@@ -568,7 +481,7 @@ std::string StringUtils::transString45(const std::string& str)
         }
         else
         {
-            codepoint                   = swapCodepoints45(codepoint);
+            codepoint                   = codepoint < 0x10000 ? swap45(codepoint) : codepoint;
             char codepoints[4]          = {'\0'};
             ssize_t necessaryCodepoints = encode_utf8((u8*)codepoints, codepoint);
             if (necessaryCodepoints == -1)
@@ -587,56 +500,11 @@ std::u16string StringUtils::transString45(const std::u16string& str)
     std::u16string ret = str;
     for (auto& codepoint : ret)
     {
-        codepoint = swapCodepoints45(codepoint);
+        codepoint = swap45(codepoint);
     }
     return ret;
 }
 
-static u32 swapCodepoints67(u32 codepoint)
-{
-    switch (codepoint)
-    {
-        case u'\uE088':
-            codepoint = u'\u00D7';
-            break;
-        case u'\uE089':
-            codepoint = u'\u00F7';
-            break;
-        case u'\uE08A':
-            codepoint = u'\uE068';
-            break;
-        case u'\uE08B':
-            codepoint = u'\uE069';
-            break;
-        case u'\uE08C':
-            codepoint = u'\uE0AB';
-            break;
-        case u'\uE0A6':
-            codepoint = u'\uE06A';
-            break;
-
-        case u'\u00D7':
-            codepoint = u'\uE088';
-            break;
-        case u'\u00F7':
-            codepoint = u'\uE089';
-            break;
-        case u'\uE068':
-            codepoint = u'\uE08A';
-            break;
-        case u'\uE069':
-            codepoint = u'\uE08B';
-            break;
-        case u'\uE0AB':
-            codepoint = u'\uE08C';
-            break;
-        case u'\uE06A':
-            codepoint = u'\uE0A6';
-            break;
-    }
-    return codepoint;
-}
-
 std::string StringUtils::transString67(const std::string& str)
 {
     std::string ret = str;
@@ -650,7 +518,7 @@ std::string StringUtils::transString67(const std::string& str)
         }
         else
         {
-            codepoint                   = swapCodepoints67(codepoint);
+            codepoint                   = codepoint < 0x10000 ? swap67(codepoint) : codepoint;
             char codepoints[4]          = {'\0'};
             ssize_t necessaryCodepoints = encode_utf8((u8*)codepoints, codepoint);
             if (necessaryCodepoints == -1)
@@ -669,7 +537,7 @@ std::u16string StringUtils::transString67(const std::u16string& str)
     std::u16string ret = str;
     for (auto& codepoint : ret)
     {
-        codepoint = swapCodepoints67(codepoint);
+        codepoint = swap67(codepoint);
     }
     return ret;
 }
@@ -32,6 +32,7 @@
 #include "json.hpp"
 #include "types.h"
 #include <algorithm>
+#include <map>
 #include <stdio.h>
 #include <string>
 #include <unordered_map>
@@ -54,65 +55,117 @@ enum Language
     RU
 };
 
+// Names sorted by ID, for the tables whose IDs have gaps in them
+template <typename Key>
+struct SparseTable
+{
+    std::vector<Key> ids;
+    std::vector<std::string> names;
+
+    const std::string* find(Key id) const
+    {
+        auto i = std::lower_bound(ids.begin(), ids.end(), id);
+        return i != ids.end() && *i == id ? &names[i - ids.begin()] : nullptr;
+    }
+    std::map<Key, std::string> toMap() const
+    {
+        std::map<Key, std::string> ret;
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            ret.emplace_hint(ret.end(), ids[i], names[i]);
+        }
+        return ret;
+    }
+};
+
+// Tables are read from romfs the first time they're used rather than all at once, so a language nobody looks at costs nothing.
+// They come from <language>/strings.bin (see common/pack_i18n.py) when it exists, and from the text files otherwise
 class LanguageStrings
 {
 protected:
-    std::vector<std::string> abilities;
-    std::vector<std::string> balls;
-    std::vector<std::string> forms;
-    std::vector<std::string> hps;
-    std::vector<std::string> items;
-    std::vector<std::string> moves;
-    std::vector<std::string> natures;
-    std::vector<std::string> speciess;
-    std::vector<std::string> games;
-    std::map<u16, std::string> locations4;
-    std::map<u16, std::string> locations5;
-    std::map<u16, std::string> locations6;
-    std::map<u16, std::string> locations7;
-    std::map<u16, std::string> locationsLGPE;
-    std::map<u8, std::string> countries;
-    std::map<u8, std::map<u8, std::string>> subregions;
-    nlohmann::json gui;
+    // The packed file uses these as keys, so the order matters
+    enum Table : u8
+    {
+        ABILITIES,
+        BALLS,
+        FORMS,
+        HPS,
+        ITEMS,
+        MOVES,
+        NATURES,
+        SPECIES,
+        GAMES,
+        LOCATIONS4,
+        LOCATIONS5,
+        LOCATIONS6,
+        LOCATIONS7,
+        LOCATIONSLGPE,
+        COUNTRIES,
+        GUI
+    };
+    static constexpr u32 SUBREGION_KEY = 0x100;
 
-    static void load(Language lang, const std::string& name, std::vector<std::string>& array);
-    template <typename T>
-    static void load(Language lang, const std::string& name, std::map<T, std::string>& map)
+    struct PackedTable
     {
-        static constexpr const char* base = "romfs:/i18n/";
-        std::string path                  = io::exists(base + folder(lang) + name) ? base + folder(lang) + name : base + folder(Language::EN) + name;
+        u32 key;
+        u32 count;
+        u32 offset;
+        u32 size;
+    };
+
+    Language lang;
+    mutable u32 loaded = 0;
+    mutable std::vector<std::string> abilities;
+    mutable std::vector<std::string> balls;
+    mutable std::vector<std::string> forms;
+    mutable std::vector<std::string> hps;
+    mutable std::vector<std::string> items;
+    mutable std::vector<std::string> moves;
+    mutable std::vector<std::string> natures;
+    mutable std::vector<std::string> speciess;
+    mutable std::vector<std::string> games;
+    mutable SparseTable<u16> locations4;
+    mutable SparseTable<u16> locations5;
+    mutable SparseTable<u16> locations6;
+    mutable SparseTable<u16> locations7;
+    mutable SparseTable<u16> locationsLGPE;
+    mutable SparseTable<u8> countries;
+    mutable std::map<u8, SparseTable<u8>> subregions;
+    mutable nlohmann::json gui;
+    // The directory of strings.bin, read along with the first table
+    mutable std::vector<PackedTable> packed;
+    mutable bool packedRead = false;
 
-        std::string tmp;
-        FILE* values = fopen(path.c_str(), "rt");
-        if (values)
+    // Loads the table into storage on first use
+    template <typename T>
+    T& table(Table t, T& storage) const
+    {
+        if (!(loaded & BIT(t)))
         {
-            if (ferror(values))
+            if (!loadPacked(t, storage))
             {
-                fclose(values);
-                return;
+                load(lang, fileName(t), storage);
             }
-            char* data  = (char*)malloc(128);
-            size_t size = 0;
-            while (!feof(values) && !ferror(values))
-            {
-                size = std::max(size, (size_t)128);
-                if (__getline(&data, &size, values) >= 0)
-                {
-                    tmp = std::string(data);
-                    tmp = tmp.substr(0, tmp.find('\n'));
-                    // 0 automatically deduces the base: 0x prefix makes it hexadecimal, 0 prefix makes it octal
-                    T val    = std::stoi(tmp.substr(0, tmp.find('|')), 0, 0);
-                    map[val] = tmp.substr(0, tmp.find('\r')).substr(tmp.find('|') + 1);
-                }
-                else
-                {
-                    break;
-                }
-            }
-            fclose(values);
-            free(data);
+            loaded |= BIT(t);
         }
+        return storage;
     }
+    // nullptr if the country doesn't exist
+    const SparseTable<u8>* subregionTable(u8 country) const;
+    const SparseTable<u16>* locationTable(Generation g) const;
+
+    std::string packedPath() const;
+    void readPackedDirectory() const;
+    bool readPacked(u32 key, std::vector<u16>* ids, std::vector<std::string>& names) const;
+    bool loadPacked(u32 key, std::vector<std::string>& array) const { return readPacked(key, nullptr, array); }
+    template <typename Key>
+    bool loadPacked(u32 key, SparseTable<Key>& table) const;
+    bool loadPacked(u32, nlohmann::json&) const { return false; }
+
+    static const char* fileName(Table t);
+    static void load(Language lang, const std::string& name, std::vector<std::string>& array);
+    template <typename Key>
+    static void load(Language lang, const std::string& name, SparseTable<Key>& table);
     static void load(Language lang, const std::string& name, nlohmann::json& json);
 
 public:
@@ -121,9 +174,10 @@ public:
 
     const std::vector<std::string>& rawItems() const;
     const std::vector<std::string>& rawMoves() const;
-    const std::map<u16, std::string>& locations(Generation g) const;
-    const std::map<u8, std::string>& rawCountries() const;
-    const std::map<u8, std::string>& rawSubregions(u8 country) const;
+    // These three build a map each time, so they're for the selection lists rather than lookups
+    std::map<u16, std::string> locations(Generation g) const;
+    std::map<u8, std::string> rawCountries() const;
+    std::map<u8, std::string> rawSubregions(u8 country) const;
     size_t numGameStrings() const;
 
     const std::string& ability(u8 v) const;
@@ -0,0 +1,86 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#ifndef COMPILEDPKFILTER_HPP
+#define COMPILEDPKFILTER_HPP
+
+#include "PKFilter.hpp"
+#include "types.h"
+#include <array>
+#include <vector>
+
+// A PKFilter reduced, for each generation, to the list of its enabled checks with the field offsets and inversions resolved up front.
+// Matching works directly on decrypted box-format data and gives the same answers as PKX::operator==(const PKFilter&)
+class CompiledPKFilter
+{
+public:
+    explicit CompiledPKFilter(const PKFilter& filter);
+
+    // True if no check is enabled, in which case everything matches
+    bool empty(void) const { return noChecks; }
+    bool match(Generation gen, const u8* pkm) const;
+    // Bit i of the result is set if the Pokemon at base + i * stride matches. count must be at most 32
+    u32 match(Generation gen, const u8* base, u32 stride, u32 count) const;
+
+private:
+    enum class Kind : u8
+    {
+        EQUAL,     // (field >> shift) & mask == value
+        AT_LEAST,  // (field >> shift) & mask >= value
+        SHINY,     // value is the wanted shininess; shift is the generation's shiny value shift
+        TSV,       // shift is the generation's shiny value shift
+        NATURE4,   // Generation 4 derives the nature from the PID
+        BALL4,     // Generation 4 keeps two ball fields; the larger one is shown
+        LEVEL      // Derived from experience, so this one goes through the PKX class
+    };
+
+    struct Clause
+    {
+        Kind kind;
+        u8 offset;
+        u8 width;
+        u8 shift;
+        u32 mask;
+        u32 value;
+        bool inverse;
+    };
+
+    struct Program
+    {
+        std::vector<Clause> clauses;
+        // A check that can never pass for this generation (relearn moves before Generation 6, or the generation check itself)
+        bool never = false;
+    };
+
+    static Program compile(const PKFilter& filter, Generation gen);
+    static bool passes(const Clause& clause, Generation gen, const u8* pkm);
+    const Program* program(Generation gen) const;
+
+    std::array<Program, 5> programs;
+    bool noChecks = true;
+};
+
+#endif
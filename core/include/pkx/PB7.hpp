@@ -96,7 +96,7 @@ public:
     u8 ev(u8 ev) const override;
     void ev(u8 ev, u8 v) override;
     // Stubbed; data no longer exists
-    u8 contest(u8 contest) const { return 0; };
+    u8 contest(u8 contest) const { return (void)contest, 0; };
     void contest(u8 contest, u8 v) { (void)contest, (void)v; };
     // Replaced by
     u8 awakened(u8 stat) const;
@@ -187,7 +187,8 @@ public:
     int partyLevel() const override;
     void partyLevel(u8 v) override;
 
-    std::shared_ptr<PKX> next(void) const override;
+    std::shared_ptr<PKX> next(const Sav& save) const override;
+    bool next(const Sav& save, u8* out) const override;
 
     inline u8 baseHP(void) const override { return PersonalDPPtHGSS::baseHP(formSpecies()); }
     inline u8 baseAtk(void) const override { return PersonalDPPtHGSS::baseAtk(formSpecies()); }
@@ -239,8 +239,10 @@ public:
     int partyLevel() const override;
     void partyLevel(u8 v) override;
 
-    std::shared_ptr<PKX> next(void) const override;
-    std::shared_ptr<PKX> previous(void) const override;
+    std::shared_ptr<PKX> next(const Sav& save) const override;
+    bool next(const Sav& save, u8* out) const override;
+    std::shared_ptr<PKX> previous(const Sav& save) const override;
+    bool previous(const Sav& save, u8* out) const override;
 
     inline u8 baseHP(void) const override { return PersonalXYORAS::baseHP(formSpecies()); }
     inline u8 baseAtk(void) const override { return PersonalXYORAS::baseAtk(formSpecies()); }
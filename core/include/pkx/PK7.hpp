@@ -229,7 +229,8 @@ public:
     int partyLevel() const override;
     void partyLevel(u8 v) override;
 
-    std::shared_ptr<PKX> previous(void) const override;
+    std::shared_ptr<PKX> previous(const Sav& save) const override;
+    bool previous(const Sav& save, u8* out) const override;
 
     inline u8 baseHP(void) const override { return PersonalSMUSUM::baseHP(formSpecies()); }
     inline u8 baseAtk(void) const override { return PersonalSMUSUM::baseAtk(formSpecies()); }
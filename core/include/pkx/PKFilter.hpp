@@ -28,8 +28,10 @@
 #define PKFILTER_HPP
 
 #include "generation.hpp"
+#include "types.h"
 #include <bitset>
 #include <string>
+#include <vector>
 
 #define MAKE_DEFN(name, type)                                                                                                                        \
 public:                                                                                                                                              \
@@ -34,19 +34,21 @@
 
 #include "Item.hpp"
 #include "PKFilter.hpp"
+#include "PKXCrypt.hpp"
 #include "generation.hpp"
 #include "personal.hpp"
 #include "random.hpp"
 #include "types.h"
 #include "utils.hpp"
 
+class Sav;
+
 class PKX
 {
 protected:
     u32 expTable(u8 row, u8 col) const;
     u8 blockPosition(u8 index) const;
     u8 blockPositionInvert(u8 index) const;
-    u32 seedStep(u32 seed);
     virtual void reorderMoves(void);
 
     virtual void crypt(void)         = 0;
@@ -56,8 +58,38 @@ protected:
 
     u8* data;
 
+    // Values worked out from other fields, kept from the first time they're asked for until a setter changes one of their inputs.
+    // Anything that can change data behind the setters' backs (decrypt, encrypt, rawData) drops all of them
+    struct Derived
+    {
+        enum Flag : u16
+        {
+            STATS       = 0x3F, // One bit per stat
+            LEVEL       = 1 << 6,
+            HPTYPE      = 1 << 7,
+            FORMSPECIES = 1 << 8,
+            BASESTATS   = 1 << 9,
+            ALL         = 0x3FF
+        };
+        u16 valid = 0;
+        u16 formSpecies;
+        u16 stats[6];
+        u8 baseStats[6];
+        u8 level;
+        u8 hpType;
+    };
+    mutable Derived derived;
+    void invalidate(u16 flags = Derived::ALL) const { derived.valid &= ~flags; }
+    u8 levelFromExperience(u32 exp, u8 type) const;
+    // In the order stat() takes: HP, Atk, Def, Spe, SpA, SpD
+    u8 baseStat(u8 stat) const;
+
 public:
-    virtual u8* rawData(void) { return data; }
+    virtual u8* rawData(void)
+    {
+        invalidate();
+        return data;
+    }
     void decrypt(void);
     void encrypt(void);
     virtual std::shared_ptr<PKX> clone(void) const = 0;
@@ -74,7 +106,8 @@ public:
     int genNumber(void) const;
     void fixMoves(void);
 
-    static u32 getRandomPID(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, u32 oldPid, Generation gen);
+    // Shiny or not for the trainer with the given IDs, so that nothing has to reroll until shininess comes out right
+    static u32 getRandomPID(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, bool shiny, u16 tid, u16 sid, Generation gen);
 
     // BLOCK A
     virtual u32 encryptionConstant(void) const = 0;
@@ -179,6 +212,8 @@ public:
     virtual u8 currentFriendship(void) const = 0;
     virtual void currentFriendship(u8 v)     = 0;
     virtual void refreshChecksum(void)       = 0;
+    // Whether the stored checksum matches the data, which it won't for a slot holding garbage
+    bool checksumValid(void) const;
     virtual u8 hpType(void) const            = 0;
     virtual void hpType(u8 v)                = 0;
     virtual u16 TSV(void) const              = 0;
@@ -215,8 +250,19 @@ public:
     virtual int partyLevel(void) const           = 0;
     virtual void partyLevel(u8 v)                = 0;
 
-    virtual std::shared_ptr<PKX> previous(void) const { return std::shared_ptr<PKX>(const_cast<PKX*>(this)); }
-    virtual std::shared_ptr<PKX> next(void) const { return std::shared_ptr<PKX>(const_cast<PKX*>(this)); }
+    // save is the one the converted Pokemon is headed for; it provides the handler's trainer data and the highest legal move
+    virtual std::shared_ptr<PKX> previous(const Sav&) const { return std::shared_ptr<PKX>(const_cast<PKX*>(this)); }
+    virtual std::shared_ptr<PKX> next(const Sav&) const { return std::shared_ptr<PKX>(const_cast<PKX*>(this)); }
+    // Same, but write the converted box data to out, which has to hold the other generation's box size, without making a new PKX.
+    // False if there's no generation to convert to
+    virtual bool previous(const Sav&, u8*) const { return false; }
+    virtual bool next(const Sav&, u8*) const { return false; }
+    // Converts decrypted box data from one generation to another one step at a time, like Sav::transfer, but every step works
+    // directly on buffers on the stack, so nothing is allocated. out has to hold the box size of to. False if there's no way from
+    // one to the other, like between LGPE and the rest
+    static bool convert(const Sav& save, Generation from, const u8* in, Generation to, u8* out);
+    // Box data size of each generation
+    static u32 boxSize(Generation gen);
 
     u32 getLength(void) const { return length; }
     static u8 genFromBytes(u8* data, size_t length, bool ekx = false);
@@ -0,0 +1,50 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#ifndef PKXCRYPT_HPP
+#define PKXCRYPT_HPP
+
+#include "generation.hpp"
+#include "types.h"
+
+namespace PKXCrypt
+{
+    // XORs len bytes (len must be even) with the keystream of the 0x41C64E6D/0x6073 LCG: every little endian
+    // u16 is XORed with the upper half of the next state, starting from the state after seed
+    void xorKeystream(u8* data, u32 len, u32 seed);
+
+    // Order of the four data blocks for a shuffle value, and the shuffle value that undoes it
+    u8 blockPosition(u8 index);
+    u8 blockPositionInvert(u8 index);
+
+    // Decrypt or encrypt, in place, count box-format Pokemon of the given generation that start every stride bytes
+    // from base. Nothing is allocated, so callers may split a range across threads, e.g. one box each.
+    // encryptRange refreshes checksums like PKX::encrypt and returns whether any stored checksum changed
+    void decryptRange(Generation gen, u8* base, u32 stride, u32 count);
+    bool encryptRange(Generation gen, u8* base, u32 stride, u32 count);
+}
+
+#endif
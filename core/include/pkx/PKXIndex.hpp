@@ -0,0 +1,99 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#ifndef PKXINDEX_HPP
+#define PKXINDEX_HPP
+
+#include "PKX.hpp"
+#include <array>
+#include <string>
+#include <vector>
+
+// Structure-of-arrays copy of the sortable and filterable attributes of every slot of a save or bank, indexed by box * 30 + slot.
+// Computed attributes like stats and hidden power are evaluated once per slot instead of once per comparison
+class PKXIndex
+{
+public:
+    enum class Column : u8
+    {
+        SPECIES,
+        FORM,
+        LEVEL,
+        NATURE,
+        HPIV,
+        ATKIV,
+        DEFIV,
+        SPEIV,
+        SATKIV,
+        SDEFIV,
+        HP,
+        ATK,
+        DEF,
+        SPE,
+        SATK,
+        SDEF,
+        TSV,
+        BALL,
+        LANGUAGE,
+        SHINY,
+        TYPE1,
+        TYPE2,
+        TID,
+        HIDDENPOWER,
+        FRIENDSHIP,
+        COLUMN_COUNT
+    };
+
+    static constexpr Column ivColumn(u8 stat) { return Column(u8(Column::HPIV) + stat); }
+    static constexpr Column statColumn(u8 stat) { return Column(u8(Column::HP) + stat); }
+
+    // Empties the index and makes room for the given number of slots
+    void reset(size_t slots);
+    // Refreshes one row from a Pokemon that was just written to it
+    void set(size_t index, const PKX& pkm);
+    // Marks a row as holding no Pokemon
+    void clear(size_t index);
+
+    size_t size(void) const { return occupied.size(); }
+    bool present(size_t index) const { return occupied[index]; }
+    u16 value(Column column, size_t index) const { return columns[size_t(column)][index]; }
+    const std::vector<u16>& column(Column column) const { return columns[size_t(column)]; }
+    u32 otHash(size_t index) const { return otHashes[index]; }
+    const std::string& nickname(size_t index) const { return nicknames[index]; }
+    const std::string& otName(size_t index) const { return otNames[index]; }
+
+    // Indices of all occupied rows, in slot order
+    std::vector<u32> occupiedRows(void) const;
+
+private:
+    std::array<std::vector<u16>, size_t(Column::COLUMN_COUNT)> columns;
+    std::vector<u8> occupied;
+    std::vector<u32> otHashes;
+    std::vector<std::string> nicknames;
+    std::vector<std::string> otNames;
+};
+
+#endif
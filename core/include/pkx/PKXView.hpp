@@ -0,0 +1,58 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#ifndef PKXVIEW_HPP
+#define PKXVIEW_HPP
+
+#include "PB7.hpp"
+#include "PK4.hpp"
+#include "PK5.hpp"
+#include "PK6.hpp"
+#include "PK7.hpp"
+#include <variant>
+
+// Non-owning, read-only PKX over decrypted box-format bytes that live somewhere else (a save or a bank).
+// The PKX object is built in place, so making a view never touches the heap
+class PKXView
+{
+public:
+    PKXView() = default;
+    PKXView(Generation gen, const u8* data);
+    PKXView(const PKXView&) = delete;
+    PKXView& operator=(const PKXView&) = delete;
+
+    // False for an empty bank slot or an unknown generation
+    explicit operator bool() const { return pkm.index() != 0; }
+    const PKX& operator*() const { return *get(); }
+    const PKX* operator->() const { return get(); }
+
+private:
+    const PKX* get(void) const;
+
+    std::variant<std::monostate, PK4, PK5, PK6, PK7, PB7> pkm;
+};
+
+#endif
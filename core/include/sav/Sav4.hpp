@@ -50,9 +50,14 @@ protected:
     std::vector<u8> getDexFormValues(u32 v, u8 bitsPerForm, u8 readCt);
     void setForms(std::vector<u8> forms, u16 species);
     u32 setDexFormValues(std::vector<u8> forms, u8 bitsPerForm, u8 readCt);
+    std::pair<u32, u32> boxStorage(void) const override;
+    // Where the checksum of blocks()[block] is stored
+    u32 checksumOffset(size_t block) const;
 
 public:
     void resign(void) override;
+    std::vector<Block> blocks(void) const override;
+    bool blockValid(size_t block) const override;
 
     u16 TID(void) const override;
     void TID(u16 v) override;
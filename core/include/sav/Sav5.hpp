@@ -36,6 +36,7 @@ class Sav5 : public Sav
 {
 protected:
     int PCLayout, Trainer1, Trainer2, BattleSubway, PokeDexLanguageFlags;
+    std::pair<u32, u32> boxStorage(void) const override { return {boxOffset(0, 0), boxOffset(maxBoxes() - 1, 29) + 136}; }
 
 private:
     int dexFormIndex(int species, int formct) const;
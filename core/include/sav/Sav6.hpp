@@ -36,6 +36,7 @@ class Sav6 : public Sav
 {
 protected:
     int TrainerCard, Trainer2, PlayTime, LastViewedBox, PokeDexLanguageFlags, EncounterCount, PCLayout;
+    std::pair<u32, u32> boxStorage(void) const override { return {boxOffset(0, 0), boxOffset(maxBoxes() - 1, 29) + 232}; }
 
 private:
     int dexFormIndex(int species, int formct) const;
@@ -43,13 +43,14 @@ protected:
 
     virtual int dexFormIndex(int species, int formct, int start) const = 0;
     virtual int dexFormCount(int species) const                        = 0;
+    std::pair<u32, u32> boxStorage(void) const override { return {boxOffset(0, 0), boxOffset(maxBoxes() - 1, 29) + 232}; }
 
 private:
     void setDexFlags(int index, int gender, int shiny, int baseSpecies);
     bool sanitizeFormsToIterate(int species, int& fs, int& fe, int formIn) const;
 
 public:
-    u16 check16(u8* buf, u32 blockID, u32 len) const;
+    u16 check16(const u8* buf, u32 blockID, u32 len) const;
     virtual void resign(void) = 0;
 
     u16 TID(void) const override;
@@ -32,6 +32,8 @@
 class SavB2W2 : public Sav5
 {
 private:
+    static constexpr u8 blockCount = 74;
+
     static constexpr u16 lengths[74] = {0x03e0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0,
         0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x09ec, 0x0534, 0x00b0, 0x00a8, 0x1338,
         0x07c4, 0x0d54, 0x0094, 0x0658, 0x0a94, 0x01ac, 0x03ec, 0x005c, 0x01e0, 0x00a8, 0x0460, 0x1400, 0x02a4, 0x00e0, 0x034c, 0x04e0, 0x00f8,
@@ -60,10 +62,12 @@ private:
         0x25F90, 0x25FA2};
 
 public:
-    SavB2W2(u8* dt);
+    SavB2W2(std::unique_ptr<u8[]> dt);
     virtual ~SavB2W2();
 
     void resign(void) override;
+    std::vector<Block> blocks(void) const override;
+    bool blockValid(size_t block) const override;
 
     std::map<Pouch, std::vector<int>> validItems(void) const override;
 };
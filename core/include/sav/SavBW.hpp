@@ -32,6 +32,8 @@
 class SavBW : public Sav5
 {
 private:
+    static constexpr u8 blockCount = 70;
+
     static constexpr u16 lengths[70] = {0x03E0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0,
         0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x09C0, 0x0534, 0x0068, 0x009C, 0x1338,
         0x07C4, 0x0D54, 0x002C, 0x0658, 0x0A94, 0x01AC, 0x03EC, 0x005C, 0x01E0, 0x00A8, 0x0460, 0x1400, 0x02A4, 0x02DC, 0x034C, 0x03EC, 0x00F8,
@@ -57,10 +59,12 @@ private:
         0x23F72, 0x23F74, 0x23F76, 0x23F78, 0x23F7A, 0x23F7C, 0x23F7E, 0x23F80, 0x23F82, 0x23F84, 0x23F86, 0x23F88, 0x23F9A};
 
 public:
-    SavBW(u8* dt);
+    SavBW(std::unique_ptr<u8[]> dt);
     virtual ~SavBW();
 
     void resign(void) override;
+    std::vector<Block> blocks(void) const override;
+    bool blockValid(size_t block) const override;
 
     std::map<Pouch, std::vector<int>> validItems(void) const override;
 };
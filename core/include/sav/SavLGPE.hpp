@@ -32,6 +32,9 @@
 class SavLGPE : public Sav
 {
 protected:
+    static constexpr u8 blockCount = 21;
+    static constexpr u32 csoff     = 0xB861A;
+
     static constexpr u32 chkofs[21] = {0x00000, 0x00E00, 0x01000, 0x01200, 0x02A00, 0x04C00, 0x05600, 0x05800, 0x05A00, 0x05C00, 0x45400, 0x45600,
         0x46600, 0x47800, 0x47A00, 0x4DC00, 0x4DE00, 0x4E000, 0x4E200, 0xB7A00, 0xB7C00};
 
@@ -45,13 +48,16 @@ protected:
     int dexFormCount(int species) const;
     void setDexFlags(int index, int gender, int shiny, int baseSpecies);
     bool sanitizeFormsToIterate(int species, int& fs, int& fe, int formIn) const;
+    std::pair<u32, u32> boxStorage(void) const override { return {0x5C00, 0x5C00 + 1000 * 260}; }
 
 public:
-    SavLGPE(u8* dt);
+    SavLGPE(std::unique_ptr<u8[]> dt, size_t length);
     ~SavLGPE();
 
-    u16 check16(u8* buf, u32 blockID, u32 len) const;
+    u16 check16(const u8* buf, u32 blockID, u32 len) const;
     void resign(void) override;
+    std::vector<Block> blocks(void) const override;
+    bool blockValid(size_t block) const override;
 
     u16 boxedPkm(void) const;
     void boxedPkm(u16 v);
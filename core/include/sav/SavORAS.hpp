@@ -32,6 +32,9 @@
 class SavORAS : public Sav6
 {
 protected:
+    static constexpr u8 blockCount = 58;
+    static constexpr u32 csoff     = 0x75E1A;
+
     static constexpr u32 chkofs[58] = {0x00000, 0x00400, 0x01000, 0x01200, 0x01400, 0x01600, 0x01800, 0x01A00, 0x01C00, 0x01E00, 0x02000, 0x04200,
         0x04400, 0x04A00, 0x05000, 0x0A000, 0x0F000, 0x14000, 0x14200, 0x14A00, 0x15000, 0x16200, 0x16A00, 0x16C00, 0x16E00, 0x17400, 0x17600,
         0x17A00, 0x18200, 0x18400, 0x18600, 0x18800, 0x18A00, 0x18C00, 0x19400, 0x19A00, 0x19E00, 0x1BA00, 0x1BC00, 0x1C000, 0x1C400, 0x1CC00,
@@ -45,10 +48,12 @@ protected:
         0x0E058};
 
 public:
-    SavORAS(u8* dt);
+    SavORAS(std::unique_ptr<u8[]> dt);
     virtual ~SavORAS(){};
 
     void resign(void) override;
+    std::vector<Block> blocks(void) const override;
+    bool blockValid(size_t block) const override;
 
     std::map<Pouch, std::vector<int>> validItems(void) const override;
 };
@@ -32,6 +32,9 @@
 class SavSUMO : public Sav7
 {
 protected:
+    static constexpr u8 blockCount = 37;
+    static constexpr u32 csoff     = 0x6BC1A;
+
     static constexpr u32 chkofs[37] = {0x00000, 0x00E00, 0x01000, 0x01200, 0x01400, 0x01C00, 0x02A00, 0x03A00, 0x03E00, 0x04000, 0x04200, 0x04400,
         0x04600, 0x04800, 0x04E00, 0x3B400, 0x40C00, 0x40E00, 0x42000, 0x43C00, 0x4A200, 0x50800, 0x54200, 0x54400, 0x54600, 0x64C00, 0x65000,
         0x65C00, 0x69C00, 0x6A000, 0x6A800, 0x6AA00, 0x6B200, 0x6B400, 0x6B600, 0x6B800, 0x6BA00};
@@ -60,10 +63,12 @@ protected:
     int dexFormCount(int species) const override;
 
 public:
-    SavSUMO(u8* dt);
+    SavSUMO(std::unique_ptr<u8[]> dt);
     virtual ~SavSUMO(){};
 
     void resign(void) override;
+    std::vector<Block> blocks(void) const override;
+    bool blockValid(size_t block) const override;
 
     std::map<Pouch, std::vector<int>> validItems(void) const override;
 };
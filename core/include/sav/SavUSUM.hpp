@@ -32,6 +32,9 @@
 class SavUSUM : public Sav7
 {
 protected:
+    static constexpr u8 blockCount = 39;
+    static constexpr u32 csoff     = 0x6CA1A;
+
     static constexpr u32 chkofs[39] = {0x00000, 0x01000, 0x01200, 0x01400, 0x01600, 0x01E00, 0x02C00, 0x03C00, 0x04000, 0x04400, 0x04600, 0x04800,
         0x04A00, 0x04C00, 0x05200, 0x3B800, 0x41000, 0x41200, 0x42600, 0x44200, 0x4A800, 0x50E00, 0x54800, 0x54A00, 0x54C00, 0x65200, 0x65600,
         0x66200, 0x6A200, 0x6A600, 0x6AE00, 0x6B000, 0x6B800, 0x6BA00, 0x6BC00, 0x6BE00, 0x6C000, 0x6C200, 0x6C600};
@@ -61,10 +64,12 @@ protected:
     int dexFormCount(int species) const override;
 
 public:
-    SavUSUM(u8* dt);
+    SavUSUM(std::unique_ptr<u8[]> dt);
     virtual ~SavUSUM(){};
 
     void resign(void) override;
+    std::vector<Block> blocks(void) const override;
+    bool blockValid(size_t block) const override;
 
     std::map<Pouch, std::vector<int>> validItems(void) const override;
 };
@@ -32,6 +32,9 @@
 class SavXY : public Sav6
 {
 protected:
+    static constexpr u8 blockCount = 55;
+    static constexpr u32 csoff     = 0x6541A;
+
     static constexpr u32 chkofs[55] = {0x00000, 0x00400, 0x01000, 0x01200, 0x01400, 0x01600, 0x01800, 0x01A00, 0x01C00, 0x01E00, 0x02000, 0x04200,
         0x04400, 0x04A00, 0x05000, 0x0A000, 0x0F000, 0x14000, 0x14200, 0x14A00, 0x15000, 0x15800, 0x16000, 0x16200, 0x16400, 0x16A00, 0x16C00,
         0x17000, 0x17800, 0x17A00, 0x17C00, 0x17E00, 0x18000, 0x18200, 0x18A00, 0x19000, 0x19400, 0x1B000, 0x1B200, 0x1B400, 0x1B800, 0x1BC00,
@@ -43,10 +46,12 @@ protected:
         0x00308, 0x00618, 0x0025C, 0x00834, 0x00318, 0x007D0, 0x00C48, 0x00078, 0x00200, 0x00C84, 0x00628, 0x34AD0, 0x0E058};
 
 public:
-    SavXY(u8* dt);
+    SavXY(std::unique_ptr<u8[]> dt);
     virtual ~SavXY(){};
 
     void resign(void) override;
+    std::vector<Block> blocks(void) const override;
+    bool blockValid(size_t block) const override;
 
     std::map<Pouch, std::vector<int>> validItems(void) const override;
 };
@@ -26,14 +26,43 @@
 
 #include "LanguageStrings.hpp"
 #include "utils.hpp"
+#include <array>
+#include <string.h>
+#include <string_view>
 
-static nlohmann::json& formJson()
+#ifdef PKSM_HOST
+#define I18N_PATH ROMFS_PATH "/i18n/"
+#else
+#define I18N_PATH "romfs:/i18n/"
+#endif
+
+namespace
 {
-    static nlohmann::json forms;
-    static bool first = true;
-    if (first)
+    // forms.json flattened into arrays. For each species and generation there's a run of indices into forms.txt, one per form
+    struct FormTable
+    {
+        // Generations FOUR through LGPE, then every other value
+        static constexpr size_t GENERATIONS = 6;
+        struct Run
+        {
+            u16 start;
+            u16 count;
+        };
+
+        std::vector<std::array<Run, GENERATIONS>> runs;
+        std::vector<u16> names;
+
+        static size_t slot(Generation generation)
+        {
+            return std::min((size_t)generation, GENERATIONS - 1);
+        }
+    };
+
+    FormTable buildFormTable()
     {
-        FILE* in = fopen("romfs:/i18n/forms.json", "rt");
+        FormTable ret;
+        nlohmann::json forms;
+        FILE* in = fopen(I18N_PATH "forms.json", "rt");
         if (in)
         {
             if (!ferror(in))
@@ -42,9 +71,60 @@ static nlohmann::json& formJson()
             }
             fclose(in);
         }
-        first = false;
+        if (!forms.is_object())
+        {
+            return ret;
+        }
+
+        auto addRun = [&ret](u16 species, size_t slot, const std::vector<u16>& names) {
+            if (species >= ret.runs.size())
+            {
+                ret.runs.resize(species + 1, {});
+            }
+            ret.runs[species][slot] = {(u16)ret.names.size(), (u16)names.size()};
+            ret.names.insert(ret.names.end(), names.begin(), names.end());
+        };
+
+        // Megas have their normal form and form 146, "Mega", in every generation unless they're listed on their own
+        if (forms.contains("megas"))
+        {
+            for (u16 species : forms["megas"].get<std::vector<u16>>())
+            {
+                for (size_t slot = 0; slot < FormTable::GENERATIONS; slot++)
+                {
+                    addRun(species, slot, {0, 146});
+                }
+            }
+        }
+        for (auto i = forms.begin(); i != forms.end(); i++)
+        {
+            if (i.key() == "megas")
+            {
+                continue;
+            }
+            u16 species = strtol(i.key().c_str(), nullptr, 10);
+            for (size_t slot = 0; slot < FormTable::GENERATIONS; slot++)
+            {
+                std::vector<u16> names;
+                if (!i->is_object())
+                {
+                    names = i->get<std::vector<u16>>();
+                }
+                else if (slot < FormTable::GENERATIONS - 1 && i->contains(genToString(Generation(slot))))
+                {
+                    names = (*i)[genToString(Generation(slot))].get<std::vector<u16>>();
+                }
+                addRun(species, slot, names);
+            }
+        }
+        return ret;
+    }
+
+    const FormTable& formTable()
+    {
+        static const FormTable table = buildFormTable();
+        return table;
     }
-    return forms;
 }
 
 std::string LanguageStrings::folder(Language lang)
@@ -80,38 +160,26 @@ std::string LanguageStrings::folder(Language lang)
     return "en";
 }
 
-LanguageStrings::LanguageStrings(Language lang)
-{
-    load(lang, "/abilities.txt", abilities);
-    load(lang, "/balls.txt", balls);
-    load(lang, "/forms.txt", forms);
-    load(lang, "/hp.txt", hps);
-    load(lang, "/items.txt", items);
-    load(lang, "/moves.txt", moves);
-    load(lang, "/natures.txt", natures);
-    load(lang, "/species.txt", speciess);
-    load(lang, "/games.txt", games);
-    load(lang, "/locations4.txt", locations4);
-    load(lang, "/locations5.txt", locations5);
-    load(lang, "/locations6.txt", locations6);
-    load(lang, "/locations7.txt", locations7);
-    load(lang, "/locationsLGPE.txt", locationsLGPE);
-    countries = {};
-    load(lang, "/countries.txt", countries);
-    for (auto i = countries.begin(); i != countries.end(); i++)
-    {
-        subregions[i->first] = {};
-        load(lang, StringUtils::format("/subregions/%03i.txt", (int)i->first), subregions[i->first]);
-    }
-    load(lang, "/gui.json", gui);
+LanguageStrings::LanguageStrings(Language lang) : lang(lang) {}
+
+const char* LanguageStrings::fileName(Table t)
+{
+    static constexpr const char* names[] = {"/abilities.txt", "/balls.txt", "/forms.txt", "/hp.txt", "/items.txt", "/moves.txt", "/natures.txt",
+        "/species.txt", "/games.txt", "/locations4.txt", "/locations5.txt", "/locations6.txt", "/locations7.txt", "/locationsLGPE.txt",
+        "/countries.txt", "/gui.json"};
+    return names[t];
 }
 
-void LanguageStrings::load(Language lang, const std::string& name, std::vector<std::string>& array)
+static std::string path(Language lang, const std::string& name)
 {
-    static const std::string base = "romfs:/i18n/";
-    std::string path              = io::exists(base + folder(lang) + name) ? base + folder(lang) + name : base + folder(Language::EN) + name;
+    std::string ret = I18N_PATH + LanguageStrings::folder(lang) + name;
+    return io::exists(ret) ? ret : I18N_PATH + LanguageStrings::folder(Language::EN) + name;
+}
 
-    std::string tmp;
+// Calls lineFunc with every line of the file, without its line ending
+template <typename F>
+static void forEachLine(const std::string& path, F lineFunc)
+{
     FILE* values = fopen(path.c_str(), "rt");
     if (values)
     {
@@ -121,32 +189,51 @@ void LanguageStrings::load(Language lang, const std::string& name, std::vector<s
             return;
         }
         char* data  = (char*)malloc(128);
-        size_t size = 0;
-        while (!feof(values) && !ferror(values))
+        size_t size = 128;
+        while (__getline(&data, &size, values) >= 0)
         {
-            size = std::max(size, (size_t)128);
-            if (__getline(&data, &size, values) >= 0)
-            {
-                tmp = std::string(data);
-                tmp = tmp.substr(0, tmp.find('\n'));
-                array.emplace_back(tmp.substr(0, tmp.find('\r')));
-            }
-            else
-            {
-                break;
-            }
+            lineFunc(data, strcspn(data, "\r\n"));
         }
         fclose(values);
         free(data);
     }
 }
 
-void LanguageStrings::load(Language lang, const std::string& name, nlohmann::json& json)
+void LanguageStrings::load(Language lang, const std::string& name, std::vector<std::string>& array)
 {
-    static const std::string base = "romfs:/i18n/";
-    std::string path              = io::exists(base + folder(lang) + name) ? base + folder(lang) + name : base + folder(Language::EN) + name;
+    forEachLine(path(lang, name), [&array](const char* line, size_t length) { array.emplace_back(line, length); });
+}
 
-    FILE* values = fopen(path.c_str(), "rt");
+template <typename Key>
+void LanguageStrings::load(Language lang, const std::string& name, SparseTable<Key>& table)
+{
+    std::vector<std::pair<Key, std::string>> entries;
+    forEachLine(path(lang, name), [&entries](const char* line, size_t length) {
+        // 0 automatically deduces the base: 0x prefix makes it hexadecimal, 0 prefix makes it octal
+        Key val           = strtol(line, nullptr, 0);
+        const char* value = (const char*)memchr(line, '|', length);
+        value             = value ? value + 1 : line;
+        entries.emplace_back(val, std::string(value, line + length));
+    });
+
+    // The files are already sorted, but if an ID appears twice the later line wins
+    std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    table.ids.reserve(entries.size());
+    table.names.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (i + 1 < entries.size() && entries[i + 1].first == entries[i].first)
+        {
+            continue;
+        }
+        table.ids.emplace_back(entries[i].first);
+        table.names.emplace_back(std::move(entries[i].second));
+    }
+}
+
+void LanguageStrings::load(Language lang, const std::string& name, nlohmann::json& json)
+{
+    FILE* values = fopen(path(lang, name).c_str(), "rt");
     if (values)
     {
         json = nlohmann::json::parse(values, nullptr, false);
@@ -154,62 +241,159 @@ void LanguageStrings::load(Language lang, const std::string& name, nlohmann::jso
     }
 }
 
-const std::string& LanguageStrings::ability(u8 v) const
+std::string LanguageStrings::packedPath() const
 {
-    return v < abilities.size() ? abilities.at(v) : localize("INVALID_ABILITY");
+    return I18N_PATH + folder(lang) + "/strings.bin";
 }
 
-const std::string& LanguageStrings::ball(u8 v) const
+void LanguageStrings::readPackedDirectory() const
 {
-    return v < balls.size() ? balls.at(v) : localize("INVALID_BALL");
-}
+    static constexpr std::string_view MAGIC = "PKSMI18N";
+    static constexpr u32 VERSION            = 1;
 
-const std::string& LanguageStrings::form(u16 species, u8 form, Generation generation) const
-{
-    std::string sSpecies = std::to_string((int)species);
-    if (!formJson().contains(sSpecies))
+    packedRead = true;
+    FILE* in   = fopen(packedPath().c_str(), "rb");
+    if (in)
     {
-        // Not sure how the json sorts it, so just do a linear search. Aren't that many (only 44) anyways
-        for (int i : formJson()["megas"])
+        char magic[MAGIC.size()];
+        u32 header[2];
+        if (fread(magic, 1, sizeof(magic), in) == sizeof(magic) && !memcmp(magic, MAGIC.data(), sizeof(magic)) &&
+            fread(header, sizeof(u32), 2, in) == 2 && header[0] == VERSION)
         {
-            if (i == species)
+            packed.resize(header[1]);
+            if (fread(packed.data(), sizeof(PackedTable), packed.size(), in) != packed.size())
             {
-                if (form == 1)
-                {
-                    return forms.at(146);
-                }
-                else if (form == 0)
-                {
-                    return forms.at(0);
-                }
-                else
-                {
-                    return localize("INVALID_FORM");
-                }
+                packed.clear();
             }
         }
+        fclose(in);
+    }
+}
+
+bool LanguageStrings::readPacked(u32 key, std::vector<u16>* ids, std::vector<std::string>& names) const
+{
+    if (!packedRead)
+    {
+        readPackedDirectory();
     }
-    else
+    auto table = std::lower_bound(packed.begin(), packed.end(), key, [](const PackedTable& table, u32 key) { return table.key < key; });
+    if (table == packed.end() || table->key != key)
     {
-        std::vector<int> formIndices;
-        if (formJson()[sSpecies].is_object())
-        {
-            if (formJson()[sSpecies].find(genToString(generation)) != formJson()[sSpecies].end())
-            {
-                formIndices = formJson()[sSpecies][genToString(generation)].get<std::vector<int>>();
-            }
-        }
-        else
+        return false;
+    }
+
+    // IDs are padded to keep the string ends aligned
+    const size_t endsOffset    = (table->count * sizeof(u16) + 3) & ~3;
+    const size_t stringsOffset = endsOffset + table->count * sizeof(u32);
+    if (table->size < stringsOffset)
+    {
+        return false;
+    }
+
+    // One read for the whole table
+    std::vector<u8> data(table->size);
+    FILE* in = fopen(packedPath().c_str(), "rb");
+    if (!in)
+    {
+        return false;
+    }
+    bool ok = fseek(in, table->offset, SEEK_SET) == 0 && fread(data.data(), 1, data.size(), in) == data.size();
+    fclose(in);
+    if (!ok)
+    {
+        return false;
+    }
+
+    const u16* tableIds = (const u16*)data.data();
+    const u32* ends     = (const u32*)(data.data() + endsOffset);
+    const char* strings = (const char*)(data.data() + stringsOffset);
+    const u32 maxEnd    = table->size - stringsOffset;
+    if (ids)
+    {
+        ids->assign(tableIds, tableIds + table->count);
+    }
+    names.reserve(table->count);
+    u32 start = 0;
+    for (u32 i = 0; i < table->count; i++)
+    {
+        u32 end = std::clamp(ends[i], start, maxEnd);
+        names.emplace_back(strings + start, end - start);
+        start = end;
+    }
+    return true;
+}
+
+template <typename Key>
+bool LanguageStrings::loadPacked(u32 key, SparseTable<Key>& table) const
+{
+    std::vector<u16> ids;
+    if (!readPacked(key, &ids, table.names))
+    {
+        return false;
+    }
+    table.ids.assign(ids.begin(), ids.end());
+    return true;
+}
+
+const SparseTable<u8>* LanguageStrings::subregionTable(u8 country) const
+{
+    if (!table(COUNTRIES, countries).find(country))
+    {
+        return nullptr;
+    }
+    auto i = subregions.find(country);
+    if (i == subregions.end())
+    {
+        i = subregions.emplace(country, SparseTable<u8>{}).first;
+        if (!loadPacked(SUBREGION_KEY + country, i->second))
         {
-            formIndices = formJson()[sSpecies].get<std::vector<int>>();
+            load(lang, StringUtils::format("/subregions/%03i.txt", (int)country), i->second);
         }
+    }
+    return &i->second;
+}
+
+const SparseTable<u16>* LanguageStrings::locationTable(Generation g) const
+{
+    switch (g)
+    {
+        case Generation::FOUR:
+            return &table(LOCATIONS4, locations4);
+        case Generation::FIVE:
+            return &table(LOCATIONS5, locations5);
+        case Generation::SIX:
+            return &table(LOCATIONS6, locations6);
+        case Generation::SEVEN:
+            return &table(LOCATIONS7, locations7);
+        case Generation::LGPE:
+            return &table(LOCATIONSLGPE, locationsLGPE);
+        default:
+            return nullptr;
+    }
+}
+
+const std::string& LanguageStrings::ability(u8 v) const
+{
+    return v < table(ABILITIES, abilities).size() ? abilities.at(v) : localize("INVALID_ABILITY");
+}
+
+const std::string& LanguageStrings::ball(u8 v) const
+{
+    return v < table(BALLS, balls).size() ? balls.at(v) : localize("INVALID_BALL");
+}
 
-        if (form < formIndices.size())
+const std::string& LanguageStrings::form(u16 species, u8 form, Generation generation) const
+{
+    const FormTable& formTable = ::formTable();
+    if (species < formTable.runs.size())
+    {
+        const FormTable::Run& run = formTable.runs[species][FormTable::slot(generation)];
+        if (form < run.count)
         {
-            size_t formNameIndex = formIndices[form];
-            if (formNameIndex < forms.size())
+            u16 name = formTable.names[run.start + form];
+            if (name < table(FORMS, forms).size())
             {
-                return forms.at(formNameIndex);
+                return forms[name];
             }
         }
     }
@@ -218,57 +402,57 @@ const std::string& LanguageStrings::form(u16 species, u8 form, Generation genera
 
 const std::string& LanguageStrings::hp(u8 v) const
 {
-    return v < hps.size() ? hps.at(v) : localize("INVALID_HP");
+    return v < table(HPS, hps).size() ? hps.at(v) : localize("INVALID_HP");
 }
 
 const std::string& LanguageStrings::item(u16 v) const
 {
-    return v < items.size() ? items.at(v) : localize("INVALID_ITEM");
+    return v < table(ITEMS, items).size() ? items.at(v) : localize("INVALID_ITEM");
 }
 
 const std::string& LanguageStrings::move(u16 v) const
 {
-    return v < moves.size() ? moves.at(v) : localize("INVALID_MOVE");
+    return v < table(MOVES, moves).size() ? moves.at(v) : localize("INVALID_MOVE");
 }
 
 const std::string& LanguageStrings::nature(u8 v) const
 {
-    return v < natures.size() ? natures.at(v) : localize("INVALID_NATURE");
+    return v < table(NATURES, natures).size() ? natures.at(v) : localize("INVALID_NATURE");
 }
 
 const std::string& LanguageStrings::species(u16 v) const
 {
-    return v < speciess.size() ? speciess.at(v) : localize("INVALID_SPECIES");
+    return v < table(SPECIES, speciess).size() ? speciess.at(v) : localize("INVALID_SPECIES");
 }
 
 const std::string& LanguageStrings::localize(const std::string& v) const
 {
-    if (!gui.contains(v))
+    nlohmann::json& gui = table(GUI, this->gui);
+    auto i              = gui.find(v);
+    if (i == gui.end())
     {
-        const_cast<nlohmann::json&>(gui)[v] = "MISSING: " + v;
+        i = gui.emplace(v, "MISSING: " + v).first;
     }
-    return gui.at(v).get_ref<const std::string&>();
+    return i->get_ref<const std::string&>();
 }
 
 const std::vector<std::string>& LanguageStrings::rawItems() const
 {
-    return items;
+    return table(ITEMS, items);
 }
 
 const std::vector<std::string>& LanguageStrings::rawMoves() const
 {
-    return moves;
+    return table(MOVES, moves);
 }
 
 const std::string& LanguageStrings::subregion(u8 country, u8 v) const
 {
-    auto i = subregions.find(country);
-    if (i != subregions.end())
+    if (auto subregions = subregionTable(country))
     {
-        auto j = i->second.find(v);
-        if (j != i->second.end())
+        if (const std::string* name = subregions->find(v))
         {
-            return j->second;
+            return *name;
         }
         return localize("INVALID_SUBREGION");
     }
@@ -277,101 +461,50 @@ const std::string& LanguageStrings::subregion(u8 country, u8 v) const
 
 const std::string& LanguageStrings::country(u8 v) const
 {
-    auto i = countries.find(v);
-    if (i != countries.end())
+    if (const std::string* name = table(COUNTRIES, countries).find(v))
     {
-        return i->second;
+        return *name;
     }
     return localize("INVALID_COUNTRY");
 }
 
 const std::string& LanguageStrings::location(u16 v, Generation generation) const
 {
-    std::map<u16, std::string>::const_iterator i;
-    switch (generation)
+    auto locations = locationTable(generation);
+    if (const std::string* name = locations ? locations->find(v) : nullptr)
     {
-        case Generation::FOUR:
-            if ((i = locations4.find(v)) != locations4.end())
-            {
-                return i->second;
-            }
-            break;
-        case Generation::FIVE:
-            if ((i = locations5.find(v)) != locations5.end())
-            {
-                return i->second;
-            }
-            break;
-        case Generation::SIX:
-            if ((i = locations6.find(v)) != locations6.end())
-            {
-                return i->second;
-            }
-            break;
-        case Generation::SEVEN:
-            if ((i = locations7.find(v)) != locations7.end())
-            {
-                return i->second;
-            }
-            break;
-        case Generation::LGPE:
-            if ((i = locationsLGPE.find(v)) != locationsLGPE.end())
-            {
-                return i->second;
-            }
-            break;
-        default:
-            break;
+        return *name;
     }
     return localize("INVALID_LOCATION");
 }
 
 const std::string& LanguageStrings::game(u8 v) const
 {
-    if (v < games.size() && games.at(v) != "")
+    if (v < table(GAMES, games).size() && games.at(v) != "")
     {
         return games.at(v);
     }
     return localize("INVALID_GAME");
 }
 
-const std::map<u16, std::string>& LanguageStrings::locations(Generation g) const
+std::map<u16, std::string> LanguageStrings::locations(Generation g) const
 {
-    static std::map<u16, std::string> emptyMap;
-    switch (g)
-    {
-        case Generation::FOUR:
-            return locations4;
-        case Generation::FIVE:
-            return locations5;
-        case Generation::SIX:
-            return locations6;
-        case Generation::SEVEN:
-            return locations7;
-        case Generation::LGPE:
-            return locationsLGPE;
-        default:
-            return emptyMap;
-    }
+    auto locations = locationTable(g);
+    return locations ? locations->toMap() : std::map<u16, std::string>{};
 }
 
 size_t LanguageStrings::numGameStrings() const
 {
-    return games.size();
+    return table(GAMES, games).size();
 }
 
-const std::map<u8, std::string>& LanguageStrings::rawCountries() const
+std::map<u8, std::string> LanguageStrings::rawCountries() const
 {
-    return countries;
+    return table(COUNTRIES, countries).toMap();
 }
 
-const std::map<u8, std::string>& LanguageStrings::rawSubregions(u8 country) const
+std::map<u8, std::string> LanguageStrings::rawSubregions(u8 country) const
 {
-    static std::map<u8, std::string> emptyMap;
-    auto i = subregions.find(country);
-    if (i == subregions.end())
-    {
-        return emptyMap;
-    }
-    return i->second;
+    auto subregions = subregionTable(country);
+    return subregions ? subregions->toMap() : std::map<u8, std::string>{};
 }
@@ -26,344 +26,107 @@
 
 #include "i18n.hpp"
 
-static LanguageStrings* jp = nullptr;
-static LanguageStrings* en = nullptr;
-static LanguageStrings* fr = nullptr;
-static LanguageStrings* it = nullptr;
-static LanguageStrings* de = nullptr;
-static LanguageStrings* es = nullptr;
-static LanguageStrings* ko = nullptr;
-static LanguageStrings* zh = nullptr;
-static LanguageStrings* tw = nullptr;
-static LanguageStrings* nl = nullptr;
-static LanguageStrings* pt = nullptr;
-static LanguageStrings* ru = nullptr;
+// Indexed by Language. Nothing is loaded until a language is first asked for
+static LanguageStrings* languages[Language::RU + 1] = {nullptr};
 
-static const std::string emptyString                = "";
-static const std::vector<std::string> emptyVector   = {};
-static const std::map<u16, std::string> emptyU16Map = {};
-static const std::map<u8, std::string> emptyU8Map   = {};
+static const std::string emptyString              = "";
+static const std::vector<std::string> emptyVector = {};
+
+static LanguageStrings* get(u8 lang)
+{
+    if (lang < Language::JP || lang > Language::RU || lang == Language::UNUSED)
+    {
+        return nullptr;
+    }
+    if (!languages[lang])
+    {
+        // Languages without their own folder are read from the English one, so they can share its tables
+        if (lang != Language::EN && LanguageStrings::folder(Language(lang)) == LanguageStrings::folder(Language::EN))
+        {
+            languages[lang] = get(Language::EN);
+        }
+        else
+        {
+            languages[lang] = new LanguageStrings(Language(lang));
+        }
+    }
+    return languages[lang];
+}
 
 void i18n::init(void)
 {
-    jp = new LanguageStrings(Language::JP);
-    en = new LanguageStrings(Language::EN);
-    fr = new LanguageStrings(Language::FR);
-    it = new LanguageStrings(Language::IT);
-    de = new LanguageStrings(Language::DE);
-    es = new LanguageStrings(Language::ES);
-    ko = new LanguageStrings(Language::KO);
-    zh = new LanguageStrings(Language::ZH);
-    tw = new LanguageStrings(Language::TW);
-    nl = new LanguageStrings(Language::NL);
-    pt = new LanguageStrings(Language::PT);
-    ru = new LanguageStrings(Language::RU);
+    // Only the UI language is needed to start up
+    get(Configuration::getInstance().language());
 }
 
 void i18n::exit(void)
 {
-    delete jp;
-    delete en;
-    delete fr;
-    delete it;
-    delete de;
-    delete es;
-    delete ko;
-    delete zh;
-    delete tw;
-    delete nl;
-    delete pt;
-    delete ru;
+    for (auto& language : languages)
+    {
+        if (language == languages[Language::EN] && &language != &languages[Language::EN])
+        {
+            language = nullptr;
+        }
+    }
+    for (auto& language : languages)
+    {
+        delete language;
+        language = nullptr;
+    }
 }
 
 const std::string& i18n::ability(u8 lang, u8 val)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->ability(val);
-        case Language::EN:
-            return en->ability(val);
-        case Language::ES:
-            return es->ability(val);
-        case Language::FR:
-            return fr->ability(val);
-        case Language::IT:
-            return it->ability(val);
-        case Language::JP:
-            return jp->ability(val);
-        case Language::KO:
-            return ko->ability(val);
-        case Language::NL:
-            return nl->ability(val);
-        case Language::PT:
-            return pt->ability(val);
-        case Language::ZH:
-            return zh->ability(val);
-        case Language::TW:
-            return tw->ability(val);
-        case Language::RU:
-            return ru->ability(val);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->ability(val) : emptyString;
 }
 
 const std::string& i18n::ball(u8 lang, u8 val)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->ball(val);
-        case Language::EN:
-            return en->ball(val);
-        case Language::ES:
-            return es->ball(val);
-        case Language::FR:
-            return fr->ball(val);
-        case Language::IT:
-            return it->ball(val);
-        case Language::JP:
-            return jp->ball(val);
-        case Language::KO:
-            return ko->ball(val);
-        case Language::NL:
-            return nl->ball(val);
-        case Language::PT:
-            return pt->ball(val);
-        case Language::ZH:
-            return zh->ball(val);
-        case Language::TW:
-            return tw->ball(val);
-        case Language::RU:
-            return ru->ball(val);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->ball(val) : emptyString;
 }
 
 const std::string& i18n::form(u8 lang, u16 species, u8 form, Generation generation)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->form(species, form, generation);
-        case Language::EN:
-            return en->form(species, form, generation);
-        case Language::ES:
-            return es->form(species, form, generation);
-        case Language::FR:
-            return fr->form(species, form, generation);
-        case Language::IT:
-            return it->form(species, form, generation);
-        case Language::JP:
-            return jp->form(species, form, generation);
-        case Language::KO:
-            return ko->form(species, form, generation);
-        case Language::NL:
-            return nl->form(species, form, generation);
-        case Language::PT:
-            return pt->form(species, form, generation);
-        case Language::ZH:
-            return zh->form(species, form, generation);
-        case Language::TW:
-            return tw->form(species, form, generation);
-        case Language::RU:
-            return ru->form(species, form, generation);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->form(species, form, generation) : emptyString;
 }
 
 const std::string& i18n::hp(u8 lang, u8 val)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->hp(val);
-        case Language::EN:
-            return en->hp(val);
-        case Language::ES:
-            return es->hp(val);
-        case Language::FR:
-            return fr->hp(val);
-        case Language::IT:
-            return it->hp(val);
-        case Language::JP:
-            return jp->hp(val);
-        case Language::KO:
-            return ko->hp(val);
-        case Language::NL:
-            return nl->hp(val);
-        case Language::PT:
-            return pt->hp(val);
-        case Language::ZH:
-            return zh->hp(val);
-        case Language::TW:
-            return tw->hp(val);
-        case Language::RU:
-            return ru->hp(val);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->hp(val) : emptyString;
 }
 
 const std::string& i18n::item(u8 lang, u16 val)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->item(val);
-        case Language::EN:
-            return en->item(val);
-        case Language::ES:
-            return es->item(val);
-        case Language::FR:
-            return fr->item(val);
-        case Language::IT:
-            return it->item(val);
-        case Language::JP:
-            return jp->item(val);
-        case Language::KO:
-            return ko->item(val);
-        case Language::NL:
-            return nl->item(val);
-        case Language::PT:
-            return pt->item(val);
-        case Language::ZH:
-            return zh->item(val);
-        case Language::TW:
-            return tw->item(val);
-        case Language::RU:
-            return ru->item(val);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->item(val) : emptyString;
 }
 
 const std::string& i18n::move(u8 lang, u16 val)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->move(val);
-        case Language::EN:
-            return en->move(val);
-        case Language::ES:
-            return es->move(val);
-        case Language::FR:
-            return fr->move(val);
-        case Language::IT:
-            return it->move(val);
-        case Language::JP:
-            return jp->move(val);
-        case Language::KO:
-            return ko->move(val);
-        case Language::NL:
-            return nl->move(val);
-        case Language::PT:
-            return pt->move(val);
-        case Language::ZH:
-            return zh->move(val);
-        case Language::TW:
-            return tw->move(val);
-        case Language::RU:
-            return ru->move(val);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->move(val) : emptyString;
 }
 
 const std::string& i18n::nature(u8 lang, u8 val)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->nature(val);
-        case Language::EN:
-            return en->nature(val);
-        case Language::ES:
-            return es->nature(val);
-        case Language::FR:
-            return fr->nature(val);
-        case Language::IT:
-            return it->nature(val);
-        case Language::JP:
-            return jp->nature(val);
-        case Language::KO:
-            return ko->nature(val);
-        case Language::NL:
-            return nl->nature(val);
-        case Language::PT:
-            return pt->nature(val);
-        case Language::ZH:
-            return zh->nature(val);
-        case Language::TW:
-            return tw->nature(val);
-        case Language::RU:
-            return ru->nature(val);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->nature(val) : emptyString;
 }
 
 const std::string& i18n::species(u8 lang, u16 val)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->species(val);
-        case Language::EN:
-            return en->species(val);
-        case Language::ES:
-            return es->species(val);
-        case Language::FR:
-            return fr->species(val);
-        case Language::IT:
-            return it->species(val);
-        case Language::JP:
-            return jp->species(val);
-        case Language::KO:
-            return ko->species(val);
-        case Language::NL:
-            return nl->species(val);
-        case Language::PT:
-            return pt->species(val);
-        case Language::ZH:
-            return zh->species(val);
-        case Language::TW:
-            return tw->species(val);
-        case Language::RU:
-            return ru->species(val);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->species(val) : emptyString;
 }
 
 const std::string& i18n::localize(Language lang, const std::string& val)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->localize(val);
-        case Language::EN:
-            return en->localize(val);
-        case Language::ES:
-            return es->localize(val);
-        case Language::FR:
-            return fr->localize(val);
-        case Language::IT:
-            return it->localize(val);
-        case Language::JP:
-            return jp->localize(val);
-        case Language::KO:
-            return ko->localize(val);
-        case Language::NL:
-            return nl->localize(val);
-        case Language::PT:
-            return pt->localize(val);
-        case Language::ZH:
-            return zh->localize(val);
-        case Language::TW:
-            return tw->localize(val);
-        case Language::RU:
-            return ru->localize(val);
-        default:
-            return emptyString;
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->localize(val) : emptyString;
 }
 
 const std::string& i18n::localize(const std::string& index)
@@ -450,98 +213,20 @@ Language i18n::langFromString(const std::string& value)
 
 const std::vector<std::string>& i18n::rawItems(u8 lang)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->rawItems();
-        case Language::EN:
-            return en->rawItems();
-        case Language::ES:
-            return es->rawItems();
-        case Language::FR:
-            return fr->rawItems();
-        case Language::IT:
-            return it->rawItems();
-        case Language::JP:
-            return jp->rawItems();
-        case Language::KO:
-            return ko->rawItems();
-        case Language::NL:
-            return nl->rawItems();
-        case Language::PT:
-            return pt->rawItems();
-        case Language::ZH:
-            return zh->rawItems();
-        case Language::TW:
-            return tw->rawItems();
-        case Language::RU:
-            return ru->rawItems();
-    }
-    return emptyVector;
+    auto strings = get(lang);
+    return strings ? strings->rawItems() : emptyVector;
 }
 
 const std::vector<std::string>& i18n::rawMoves(u8 lang)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->rawMoves();
-        case Language::EN:
-            return en->rawMoves();
-        case Language::ES:
-            return es->rawMoves();
-        case Language::FR:
-            return fr->rawMoves();
-        case Language::IT:
-            return it->rawMoves();
-        case Language::JP:
-            return jp->rawMoves();
-        case Language::KO:
-            return ko->rawMoves();
-        case Language::NL:
-            return nl->rawMoves();
-        case Language::PT:
-            return pt->rawMoves();
-        case Language::ZH:
-            return zh->rawMoves();
-        case Language::TW:
-            return tw->rawMoves();
-        case Language::RU:
-            return ru->rawMoves();
-    }
-    return emptyVector;
+    auto strings = get(lang);
+    return strings ? strings->rawMoves() : emptyVector;
 }
 
 const std::string& i18n::location(u8 lang, u16 v, Generation generation)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->location(v, generation);
-        case Language::EN:
-            return en->location(v, generation);
-        case Language::ES:
-            return es->location(v, generation);
-        case Language::FR:
-            return fr->location(v, generation);
-        case Language::IT:
-            return it->location(v, generation);
-        case Language::JP:
-            return jp->location(v, generation);
-        case Language::KO:
-            return ko->location(v, generation);
-        case Language::NL:
-            return nl->location(v, generation);
-        case Language::PT:
-            return pt->location(v, generation);
-        case Language::ZH:
-            return zh->location(v, generation);
-        case Language::TW:
-            return tw->location(v, generation);
-        case Language::RU:
-            return ru->location(v, generation);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->location(v, generation) : emptyString;
 }
 
 const std::string& i18n::location(u8 lang, u16 v, u8 originGame)
@@ -578,224 +263,42 @@ const std::string& i18n::location(u8 lang, u16 v, u8 originGame)
 
 const std::string& i18n::game(u8 lang, u8 v)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->game(v);
-        case Language::EN:
-            return en->game(v);
-        case Language::ES:
-            return es->game(v);
-        case Language::FR:
-            return fr->game(v);
-        case Language::IT:
-            return it->game(v);
-        case Language::JP:
-            return jp->game(v);
-        case Language::KO:
-            return ko->game(v);
-        case Language::NL:
-            return nl->game(v);
-        case Language::PT:
-            return pt->game(v);
-        case Language::ZH:
-            return zh->game(v);
-        case Language::TW:
-            return tw->game(v);
-        case Language::RU:
-            return ru->game(v);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->game(v) : emptyString;
 }
 
-const std::map<u16, std::string>& i18n::locations(u8 lang, Generation g)
+std::map<u16, std::string> i18n::locations(u8 lang, Generation g)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->locations(g);
-        case Language::EN:
-            return en->locations(g);
-        case Language::ES:
-            return es->locations(g);
-        case Language::FR:
-            return fr->locations(g);
-        case Language::IT:
-            return it->locations(g);
-        case Language::JP:
-            return jp->locations(g);
-        case Language::KO:
-            return ko->locations(g);
-        case Language::NL:
-            return nl->locations(g);
-        case Language::PT:
-            return pt->locations(g);
-        case Language::ZH:
-            return zh->locations(g);
-        case Language::TW:
-            return tw->locations(g);
-        case Language::RU:
-            return ru->locations(g);
-    }
-    return emptyU16Map;
+    auto strings = get(lang);
+    return strings ? strings->locations(g) : std::map<u16, std::string>{};
 }
 
 size_t i18n::numGameStrings(u8 lang)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->numGameStrings();
-        case Language::EN:
-            return en->numGameStrings();
-        case Language::ES:
-            return es->numGameStrings();
-        case Language::FR:
-            return fr->numGameStrings();
-        case Language::IT:
-            return it->numGameStrings();
-        case Language::JP:
-            return jp->numGameStrings();
-        case Language::KO:
-            return ko->numGameStrings();
-        case Language::NL:
-            return nl->numGameStrings();
-        case Language::PT:
-            return pt->numGameStrings();
-        case Language::ZH:
-            return zh->numGameStrings();
-        case Language::TW:
-            return tw->numGameStrings();
-        case Language::RU:
-            return ru->numGameStrings();
-    }
-    return 0;
+    auto strings = get(lang);
+    return strings ? strings->numGameStrings() : 0;
 }
 
 const std::string& i18n::subregion(u8 lang, u8 country, u8 value)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->subregion(country, value);
-        case Language::EN:
-            return en->subregion(country, value);
-        case Language::ES:
-            return es->subregion(country, value);
-        case Language::FR:
-            return fr->subregion(country, value);
-        case Language::IT:
-            return it->subregion(country, value);
-        case Language::JP:
-            return jp->subregion(country, value);
-        case Language::KO:
-            return ko->subregion(country, value);
-        case Language::NL:
-            return nl->subregion(country, value);
-        case Language::PT:
-            return pt->subregion(country, value);
-        case Language::ZH:
-            return zh->subregion(country, value);
-        case Language::TW:
-            return tw->subregion(country, value);
-        case Language::RU:
-            return ru->subregion(country, value);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->subregion(country, value) : emptyString;
 }
 
 const std::string& i18n::country(u8 lang, u8 value)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->country(value);
-        case Language::EN:
-            return en->country(value);
-        case Language::ES:
-            return es->country(value);
-        case Language::FR:
-            return fr->country(value);
-        case Language::IT:
-            return it->country(value);
-        case Language::JP:
-            return jp->country(value);
-        case Language::KO:
-            return ko->country(value);
-        case Language::NL:
-            return nl->country(value);
-        case Language::PT:
-            return pt->country(value);
-        case Language::ZH:
-            return zh->country(value);
-        case Language::TW:
-            return tw->country(value);
-        case Language::RU:
-            return ru->country(value);
-    }
-    return emptyString;
+    auto strings = get(lang);
+    return strings ? strings->country(value) : emptyString;
 }
 
-const std::map<u8, std::string>& i18n::rawCountries(u8 lang)
+std::map<u8, std::string> i18n::rawCountries(u8 lang)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->rawCountries();
-        case Language::EN:
-            return en->rawCountries();
-        case Language::ES:
-            return es->rawCountries();
-        case Language::FR:
-            return fr->rawCountries();
-        case Language::IT:
-            return it->rawCountries();
-        case Language::JP:
-            return jp->rawCountries();
-        case Language::KO:
-            return ko->rawCountries();
-        case Language::NL:
-            return nl->rawCountries();
-        case Language::PT:
-            return pt->rawCountries();
-        case Language::ZH:
-            return zh->rawCountries();
-        case Language::TW:
-            return tw->rawCountries();
-        case Language::RU:
-            return ru->rawCountries();
-    }
-    return emptyU8Map;
+    auto strings = get(lang);
+    return strings ? strings->rawCountries() : std::map<u8, std::string>{};
 }
 
-const std::map<u8, std::string>& i18n::rawSubregions(u8 lang, u8 country)
+std::map<u8, std::string> i18n::rawSubregions(u8 lang, u8 country)
 {
-    switch (lang)
-    {
-        case Language::DE:
-            return de->rawSubregions(country);
-        case Language::EN:
-            return en->rawSubregions(country);
-        case Language::ES:
-            return es->rawSubregions(country);
-        case Language::FR:
-            return fr->rawSubregions(country);
-        case Language::IT:
-            return it->rawSubregions(country);
-        case Language::JP:
-            return jp->rawSubregions(country);
-        case Language::KO:
-            return ko->rawSubregions(country);
-        case Language::NL:
-            return nl->rawSubregions(country);
-        case Language::PT:
-            return pt->rawSubregions(country);
-        case Language::ZH:
-            return zh->rawSubregions(country);
-        case Language::TW:
-            return tw->rawSubregions(country);
-        case Language::RU:
-            return ru->rawSubregions(country);
-    }
-    return emptyU8Map;
+    auto strings = get(lang);
+    return strings ? strings->rawSubregions(country) : std::map<u8, std::string>{};
 }
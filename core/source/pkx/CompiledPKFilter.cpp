@@ -0,0 +1,249 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "CompiledPKFilter.hpp"
+#include "PKXView.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    struct Layout
+    {
+        u8 ability, language, nature, formGender, ivs, moves, relearnMoves, ball, pid, shinyShift;
+    };
+
+    // clang-format off
+    constexpr Layout layouts[5] = {
+        // ability language nature formGender ivs   moves relearn ball  pid   shinyShift
+        {0x15,   0x17,    0x00,  0x40,      0x38, 0x28, 0x00,   0x83, 0x00, 3}, // FOUR (nature and ball are special cased)
+        {0x15,   0x17,    0x41,  0x40,      0x38, 0x28, 0x00,   0x83, 0x00, 3}, // FIVE
+        {0x14,   0xE3,    0x1C,  0x1D,      0x74, 0x5A, 0x6A,   0xDC, 0x18, 4}, // SIX
+        {0x14,   0xE3,    0x1C,  0x1D,      0x74, 0x5A, 0x6A,   0xDC, 0x18, 4}, // SEVEN
+        {0x14,   0xE3,    0x1C,  0x1D,      0x74, 0x5A, 0x6A,   0xDC, 0x18, 4}, // LGPE
+    };
+    // clang-format on
+
+    u32 load(const u8* pkm, u8 offset, u8 width)
+    {
+        u32 ret = 0;
+        std::memcpy(&ret, pkm + offset, width);
+        return ret;
+    }
+}
+
+CompiledPKFilter::CompiledPKFilter(const PKFilter& filter)
+{
+    for (size_t i = 0; i < programs.size(); i++)
+    {
+        programs[i] = compile(filter, Generation(i));
+        if (programs[i].never || !programs[i].clauses.empty())
+        {
+            noChecks = false;
+        }
+    }
+}
+
+CompiledPKFilter::Program CompiledPKFilter::compile(const PKFilter& filter, Generation gen)
+{
+    Program ret;
+    const Layout& layout = layouts[size_t(gen)];
+    auto equal           = [&ret](u8 offset, u8 width, u8 shift, u32 mask, u32 value, bool inverse) {
+        ret.clauses.push_back({Kind::EQUAL, offset, width, shift, mask, value, inverse});
+    };
+
+    if (filter.generationEnabled() && (filter.generationInversed() != (gen != filter.generation())))
+    {
+        ret.never = true;
+        return ret;
+    }
+    // Cheap and selective checks go first so that a batch usually runs out of candidates early
+    if (filter.speciesEnabled())
+    {
+        equal(0x08, 2, 0, 0xFFFF, filter.species(), filter.speciesInversed());
+    }
+    if (filter.alternativeFormEnabled())
+    {
+        equal(layout.formGender, 1, 3, 0x1F, filter.alternativeForm(), filter.alternativeFormInversed());
+    }
+    if (filter.heldItemEnabled())
+    {
+        equal(0x0A, 2, 0, 0xFFFF, filter.heldItem(), filter.heldItemInversed());
+    }
+    if (filter.abilityEnabled())
+    {
+        equal(layout.ability, 1, 0, 0xFF, filter.ability(), filter.abilityInversed());
+    }
+    if (filter.natureEnabled())
+    {
+        if (gen == Generation::FOUR)
+        {
+            ret.clauses.push_back({Kind::NATURE4, 0, 4, 0, 0, filter.nature(), filter.natureInversed()});
+        }
+        else
+        {
+            equal(layout.nature, 1, 0, 0xFF, filter.nature(), filter.natureInversed());
+        }
+    }
+    if (filter.genderEnabled())
+    {
+        equal(layout.formGender, 1, 1, 0x3, filter.gender(), filter.genderInversed());
+    }
+    if (filter.ballEnabled())
+    {
+        if (gen == Generation::FOUR)
+        {
+            ret.clauses.push_back({Kind::BALL4, 0, 1, 0, 0, filter.ball(), filter.ballInversed()});
+        }
+        else
+        {
+            equal(layout.ball, 1, 0, 0xFF, filter.ball(), filter.ballInversed());
+        }
+    }
+    if (filter.languageEnabled())
+    {
+        equal(layout.language, 1, 0, 0xFF, filter.language(), filter.languageInversed());
+    }
+    if (filter.eggEnabled())
+    {
+        equal(layout.ivs, 4, 30, 0x1, filter.egg(), filter.eggInversed());
+    }
+    for (u8 i = 0; i < 4; i++)
+    {
+        if (filter.moveEnabled(i))
+        {
+            equal(layout.moves + i * 2, 2, 0, 0xFFFF, filter.move(i), filter.moveInversed(i));
+        }
+        if (filter.relearnMoveEnabled(i))
+        {
+            if (layout.relearnMoves == 0)
+            {
+                ret.never = true;
+                return ret;
+            }
+            equal(layout.relearnMoves + i * 2, 2, 0, 0xFFFF, filter.relearnMove(i), filter.relearnMoveInversed(i));
+        }
+    }
+    for (u8 i = 0; i < 6; i++)
+    {
+        if (filter.ivEnabled(i))
+        {
+            ret.clauses.push_back({Kind::AT_LEAST, layout.ivs, 4, u8(5 * i), 0x1F, filter.iv(i), filter.ivInversed(i)});
+        }
+    }
+    if (filter.shinyEnabled())
+    {
+        ret.clauses.push_back({Kind::SHINY, layout.pid, 4, layout.shinyShift, 0, filter.shiny(), filter.shinyInversed()});
+    }
+    if (filter.TSVEnabled())
+    {
+        ret.clauses.push_back({Kind::TSV, 0x0C, 4, layout.shinyShift, 0, filter.TSV(), filter.TSVInversed()});
+    }
+    if (filter.levelEnabled())
+    {
+        ret.clauses.push_back({Kind::LEVEL, 0, 0, 0, 0, filter.level(), filter.levelInversed()});
+    }
+    return ret;
+}
+
+bool CompiledPKFilter::passes(const Clause& clause, Generation gen, const u8* pkm)
+{
+    bool result;
+    switch (clause.kind)
+    {
+        case Kind::EQUAL:
+            result = ((load(pkm, clause.offset, clause.width) >> clause.shift) & clause.mask) == clause.value;
+            break;
+        case Kind::AT_LEAST:
+            result = ((load(pkm, clause.offset, clause.width) >> clause.shift) & clause.mask) >= clause.value;
+            break;
+        case Kind::SHINY:
+        {
+            u32 pid = load(pkm, clause.offset, 4);
+            u32 ids = load(pkm, 0x0C, 4);
+            result  = ((((ids >> 16) ^ (ids & 0xFFFF)) >> clause.shift) == (((pid >> 16) ^ (pid & 0xFFFF)) >> clause.shift)) == bool(clause.value);
+            break;
+        }
+        case Kind::TSV:
+        {
+            u32 ids = load(pkm, clause.offset, 4);
+            result  = (((ids >> 16) ^ (ids & 0xFFFF)) >> clause.shift) == clause.value;
+            break;
+        }
+        case Kind::NATURE4:
+            result = load(pkm, 0, 4) % 25 == clause.value;
+            break;
+        case Kind::BALL4:
+            result = std::max(pkm[0x83], pkm[0x86]) == clause.value;
+            break;
+        case Kind::LEVEL:
+        default:
+            result = PKXView(gen, pkm)->level() == clause.value;
+            break;
+    }
+    return result != clause.inverse;
+}
+
+const CompiledPKFilter::Program* CompiledPKFilter::program(Generation gen) const
+{
+    return size_t(gen) < programs.size() ? &programs[size_t(gen)] : nullptr;
+}
+
+bool CompiledPKFilter::match(Generation gen, const u8* pkm) const
+{
+    return match(gen, pkm, 0, 1) != 0;
+}
+
+u32 CompiledPKFilter::match(Generation gen, const u8* base, u32 stride, u32 count) const
+{
+    u32 ret = count >= 32 ? 0xFFFFFFFF : (1u << count) - 1;
+    if (noChecks)
+    {
+        return ret;
+    }
+    const Program* prog = program(gen);
+    if (!prog || prog->never)
+    {
+        return 0;
+    }
+    // Clause by clause over the whole batch, only looking at slots that are still candidates
+    for (const Clause& clause : prog->clauses)
+    {
+        for (u32 candidates = ret; candidates; candidates &= candidates - 1)
+        {
+            u32 i = __builtin_ctz(candidates);
+            if (!passes(clause, gen, base + stride * i))
+            {
+                ret &= ~(1u << i);
+            }
+        }
+        if (ret == 0)
+        {
+            break;
+        }
+    }
+    return ret;
+}
@@ -44,21 +44,10 @@ void PB7::shuffleArray(u8 sv)
 
 void PB7::crypt(void)
 {
-    u32 seed = encryptionConstant();
-    for (int i = 0x08; i < 232; i += 2)
+    PKXCrypt::xorKeystream(data + 8, 232 - 8, encryptionConstant());
+    if (length > 232)
     {
-        u16 temp = *(u16*)(data + i);
-        seed     = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
-    }
-    seed = encryptionConstant();
-    for (u32 i = 232; i < length; i += 2)
-    {
-        u16 temp = *(u16*)(data + i);
-        seed     = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
+        PKXCrypt::xorKeystream(data + 232, length - 232, encryptionConstant());
     }
 }
 
@@ -124,6 +113,7 @@ u16 PB7::species(void) const
 }
 void PB7::species(u16 v)
 {
+    invalidate();
     *(u16*)(data + 0x08) = v;
 }
 
@@ -160,6 +150,7 @@ u32 PB7::experience(void) const
 }
 void PB7::experience(u32 v)
 {
+    invalidate(Derived::LEVEL | Derived::STATS);
     *(u32*)(data + 0x10) = v;
 }
 
@@ -220,6 +211,7 @@ u8 PB7::nature(void) const
 }
 void PB7::nature(u8 v)
 {
+    invalidate(Derived::STATS);
     data[0x1C] = v;
 }
 
@@ -247,6 +239,7 @@ u8 PB7::alternativeForm(void) const
 }
 void PB7::alternativeForm(u8 v)
 {
+    invalidate();
     data[0x1D] = u8((data[0x1D] & 0x07) | (v << 3));
 }
 
@@ -256,6 +249,7 @@ u8 PB7::ev(u8 ev) const
 }
 void PB7::ev(u8 ev, u8 v)
 {
+    invalidate(1 << ev);
     data[0x1E + ev] = v;
 }
 
@@ -265,6 +259,7 @@ u8 PB7::awakened(u8 stat) const
 }
 void PB7::awakened(u8 stat, u8 v)
 {
+    invalidate(1 << stat);
     data[0x24 + stat] = v;
 }
 
@@ -366,6 +361,7 @@ u8 PB7::iv(u8 stat) const
 
 void PB7::iv(u8 stat, u8 v)
 {
+    invalidate(Derived::HPTYPE | 1 << stat);
     u32 buffer = *(u32*)(data + 0x74);
     buffer &= ~(0x1F << 5 * stat);
     buffer |= v << (5 * stat);
@@ -675,6 +671,7 @@ bool PB7::hyperTrain(u8 num) const
 }
 void PB7::hyperTrain(u8 num, bool v)
 {
+    invalidate(Derived::STATS);
     data[0xDE] = (u8)((data[0xDE] & ~(1 << num)) | (v ? 1 << num : 0));
 }
 
@@ -759,7 +756,12 @@ void PB7::refreshChecksum(void)
 
 u8 PB7::hpType(void) const
 {
-    return 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+    if (!(derived.valid & Derived::HPTYPE))
+    {
+        derived.hpType = 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+        derived.valid |= Derived::HPTYPE;
+    }
+    return derived.hpType;
 }
 void PB7::hpType(u8 v)
 {
@@ -799,11 +801,12 @@ u16 PB7::PSV(void) const
 
 u8 PB7::level(void) const
 {
-    u8 i      = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100)
-        ;
-    return i;
+    if (!(derived.valid & Derived::LEVEL))
+    {
+        derived.level = levelFromExperience(experience(), expType());
+        derived.valid |= Derived::LEVEL;
+    }
+    return derived.level;
 }
 
 void PB7::level(u8 v)
@@ -817,24 +820,19 @@ bool PB7::shiny(void) const
 }
 void PB7::shiny(bool v)
 {
-    if (v)
+    if (shiny() != v)
     {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
-    {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), v, TID(), SID(), generation()));
     }
 }
 
 u16 PB7::formSpecies(void) const
 {
+    if (derived.valid & Derived::FORMSPECIES)
+    {
+        return derived.formSpecies;
+    }
+
     u16 tmpSpecies = species();
     u8 form        = alternativeForm();
     u8 formcount   = PersonalLGPE::formCount(tmpSpecies);
@@ -853,26 +851,20 @@ u16 PB7::formSpecies(void) const
         }
     }
 
+    derived.formSpecies = tmpSpecies;
+    derived.valid |= Derived::FORMSPECIES;
     return tmpSpecies;
 }
 
 u16 PB7::stat(const u8 stat) const
 {
-    u16 calc;
-    u8 mult = 10, basestat = 0;
+    if (derived.valid & (1 << stat))
+    {
+        return derived.stats[stat];
+    }
 
-    if (stat == 0)
-        basestat = baseHP();
-    else if (stat == 1)
-        basestat = baseAtk();
-    else if (stat == 2)
-        basestat = baseDef();
-    else if (stat == 3)
-        basestat = baseSpe();
-    else if (stat == 4)
-        basestat = baseSpa();
-    else if (stat == 5)
-        basestat = baseSpd();
+    u16 calc;
+    u8 mult = 10, basestat = baseStat(stat);
 
     if (stat == 0)
         calc = 10 + ((2 * basestat) + ((((data[0xDE] >> hyperTrainLookup[stat]) & 1) == 1) ? 31 : iv(stat)) + ev(stat) / 4 + 100) * level() / 100;
@@ -882,7 +874,9 @@ u16 PB7::stat(const u8 stat) const
         mult++;
     if (nature() % 5 + 1 == stat)
         mult--;
-    return calc * mult / 10 + awakened(stat);
+    derived.stats[stat] = calc * mult / 10 + awakened(stat);
+    derived.valid |= 1 << stat;
+    return derived.stats[stat];
 }
 
 int PB7::partyCurrHP(void) const
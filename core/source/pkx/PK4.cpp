@@ -44,21 +44,10 @@ void PK4::shuffleArray(u8 sv)
 
 void PK4::crypt(void)
 {
-    u32 seed = checksum();
-
-    for (int i = 0x08; i < 136; i += 2)
-    {
-        seed = seedStep(seed);
-        data[i] ^= (seed >> 16);
-        data[i + 1] ^= (seed >> 24);
-    }
-
-    seed = PID();
-    for (u32 i = 136; i < length; i += 2)
+    PKXCrypt::xorKeystream(data + 8, 136 - 8, checksum());
+    if (length > 136)
     {
-        seed = seedStep(seed);
-        data[i] ^= (seed >> 16);
-        data[i + 1] ^= (seed >> 24);
+        PKXCrypt::xorKeystream(data + 136, length - 136, PID());
     }
 }
 
@@ -120,24 +109,11 @@ void PK4::currentHandler(u8 v)
 
 u8 PK4::abilityNumber(void) const
 {
-    return 1 << ((PID() >> 16) & 1);
+    return 1 << (PID() & 1);
 }
 void PK4::abilityNumber(u8 v)
 {
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, PID(), generation()));
-        } while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, PID(), generation()));
-        } while (shiny());
-    }
+    PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, shiny(), TID(), SID(), generation()));
 }
 
 u32 PK4::PID(void) const
@@ -146,6 +122,7 @@ u32 PK4::PID(void) const
 }
 void PK4::PID(u32 v)
 {
+    invalidate(Derived::STATS);
     *(u32*)(data) = v;
 }
 
@@ -173,6 +150,7 @@ u16 PK4::species(void) const
 }
 void PK4::species(u16 v)
 {
+    invalidate();
     *(u16*)(data + 0x08) = v;
 }
 
@@ -209,6 +187,7 @@ u32 PK4::experience(void) const
 }
 void PK4::experience(u32 v)
 {
+    invalidate(Derived::LEVEL | Derived::STATS);
     *(u32*)(data + 0x10) = v;
 }
 
@@ -269,6 +248,7 @@ u8 PK4::ev(u8 ev) const
 }
 void PK4::ev(u8 ev, u8 v)
 {
+    invalidate(1 << ev);
     data[0x18 + ev] = v;
 }
 
@@ -328,6 +308,7 @@ u8 PK4::iv(u8 stat) const
 
 void PK4::iv(u8 stat, u8 v)
 {
+    invalidate(Derived::HPTYPE | 1 << stat);
     u32 buffer = *(u32*)(data + 0x38);
     buffer &= ~(0x1F << 5 * stat);
     buffer |= v << (5 * stat);
@@ -368,20 +349,7 @@ u8 PK4::gender(void) const
 void PK4::gender(u8 g)
 {
     data[0x40] = u8((data[0x40] & ~0x06) | (g << 1));
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        } while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        } while (shiny());
-    }
+    PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), shiny(), TID(), SID(), generation()));
 }
 
 u8 PK4::alternativeForm(void) const
@@ -390,6 +358,7 @@ u8 PK4::alternativeForm(void) const
 }
 void PK4::alternativeForm(u8 v)
 {
+    invalidate();
     data[0x40] = u8((data[0x40] & 0x07) | (v << 3));
 }
 
@@ -399,20 +368,8 @@ u8 PK4::nature(void) const
 }
 void PK4::nature(u8 v)
 {
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), v, alternativeForm(), abilityNumber(), PID(), generation()));
-        } while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), v, alternativeForm(), abilityNumber(), PID(), generation()));
-        } while (shiny());
-    }
+    invalidate(Derived::STATS);
+    PID(PKX::getRandomPID(species(), gender(), version(), v, alternativeForm(), abilityNumber(), shiny(), TID(), SID(), generation()));
 }
 
 u8 PK4::shinyLeaf(void) const
@@ -653,7 +610,12 @@ void PK4::refreshChecksum(void)
 
 u8 PK4::hpType(void) const
 {
-    return 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+    if (!(derived.valid & Derived::HPTYPE))
+    {
+        derived.hpType = 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+        derived.valid |= Derived::HPTYPE;
+    }
+    return derived.hpType;
 }
 void PK4::hpType(u8 v)
 {
@@ -693,11 +655,12 @@ u16 PK4::PSV(void) const
 
 u8 PK4::level(void) const
 {
-    u8 i      = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100)
-        ;
-    return i;
+    if (!(derived.valid & Derived::LEVEL))
+    {
+        derived.level = levelFromExperience(experience(), expType());
+        derived.valid |= Derived::LEVEL;
+    }
+    return derived.level;
 }
 
 void PK4::level(u8 v)
@@ -711,24 +674,19 @@ bool PK4::shiny(void) const
 }
 void PK4::shiny(bool v)
 {
-    if (v)
-    {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
+    if (shiny() != v)
     {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), v, TID(), SID(), generation()));
     }
 }
 
 u16 PK4::formSpecies(void) const
 {
+    if (derived.valid & Derived::FORMSPECIES)
+    {
+        return derived.formSpecies;
+    }
+
     u16 tmpSpecies = species();
     u8 form        = alternativeForm();
     u8 formcount   = PersonalDPPtHGSS::formCount(tmpSpecies);
@@ -747,26 +705,20 @@ u16 PK4::formSpecies(void) const
         }
     }
 
+    derived.formSpecies = tmpSpecies;
+    derived.valid |= Derived::FORMSPECIES;
     return tmpSpecies;
 }
 
 u16 PK4::stat(const u8 stat) const
 {
-    u16 calc;
-    u8 mult = 10, basestat = 0;
+    if (derived.valid & (1 << stat))
+    {
+        return derived.stats[stat];
+    }
 
-    if (stat == 0)
-        basestat = baseHP();
-    else if (stat == 1)
-        basestat = baseAtk();
-    else if (stat == 2)
-        basestat = baseDef();
-    else if (stat == 3)
-        basestat = baseSpe();
-    else if (stat == 4)
-        basestat = baseSpa();
-    else if (stat == 5)
-        basestat = baseSpd();
+    u16 calc;
+    u8 mult = 10, basestat = baseStat(stat);
 
     if (stat == 0)
         calc = 10 + (2 * basestat + iv(stat) + ev(stat) / 4 + 100) * level() / 100;
@@ -776,52 +728,53 @@ u16 PK4::stat(const u8 stat) const
         mult++;
     if (nature() % 5 + 1 == stat)
         mult--;
-    return calc * mult / 10;
+    derived.stats[stat] = calc * mult / 10;
+    derived.valid |= 1 << stat;
+    return derived.stats[stat];
 }
 
-std::shared_ptr<PKX> PK4::next(void) const
+bool PK4::next(const Sav&, u8* out) const
 {
-    u8 dt[136];
-    std::copy(data, data + 136, dt);
+    std::copy(data, data + 136, out);
 
     // Clear HGSS data
-    *(u16*)(dt + 0x86) = 0;
+    *(u16*)(out + 0x86) = 0;
 
     // Clear PtHGSS met data
-    *(u32*)(dt + 0x44) = 0;
+    *(u32*)(out + 0x44) = 0;
 
-    std::shared_ptr<PKX> pk5 = std::make_shared<PK5>(dt);
+    PK5 pk5(out, false, false, true);
 
     time_t t              = time(NULL);
     struct tm* timeStruct = gmtime((const time_t*)&t);
 
-    pk5->otFriendship(70);
-    pk5->metYear(timeStruct->tm_year - 100);
-    pk5->metMonth(timeStruct->tm_mon + 1);
-    pk5->metDay(timeStruct->tm_mday);
+    pk5.otFriendship(70);
+    pk5.metYear(timeStruct->tm_year - 100);
+    pk5.metMonth(timeStruct->tm_mon + 1);
+    pk5.metDay(timeStruct->tm_mday);
 
     // Force normal Arceus form
-    if (pk5->species() == 493)
+    if (pk5.species() == 493)
     {
-        pk5->alternativeForm(0);
+        pk5.alternativeForm(0);
     }
 
-    pk5->heldItem(0);
+    pk5.heldItem(0);
 
-    pk5->nature(nature());
+    pk5.nature(nature());
 
     // Check met location
-    pk5->metLocation(pk5->gen4() && pk5->fatefulEncounter() && std::find(beasts, beasts + 4, pk5->species()) != beasts + 4
-                         ? (pk5->species() == 251 ? 30010 : 30012) // Celebi : Beast
-                         : 30001);                                 // Pokétransfer (not Crown)
+    pk5.metLocation(pk5.gen4() && pk5.fatefulEncounter() && std::find(beasts, beasts + 4, pk5.species()) != beasts + 4
+                        ? (pk5.species() == 251 ? 30010 : 30012) // Celebi : Beast
+                        : 30001);                                 // Pokétransfer (not Crown)
 
-    pk5->ball(ball());
+    pk5.ball(ball());
 
-    pk5->nickname(nickname());
-    pk5->otName(otName());
+    pk5.nickname(nickname());
+    pk5.otName(otName());
 
     // Check level
-    pk5->metLevel(pk5->level());
+    pk5.metLevel(pk5.level());
 
     // Remove HM
     u16 moves[4] = {move(0), move(1), move(2), move(3)};
@@ -832,12 +785,19 @@ std::shared_ptr<PKX> PK4::next(void) const
         {
             moves[i] = 0;
         }
-        pk5->move(i, moves[i]);
+        pk5.move(i, moves[i]);
     }
-    pk5->fixMoves();
+    pk5.fixMoves();
+
+    pk5.refreshChecksum();
+    return true;
+}
 
-    pk5->refreshChecksum();
-    return pk5;
+std::shared_ptr<PKX> PK4::next(const Sav& save) const
+{
+    u8 dt[136];
+    next(save, dt);
+    return std::make_shared<PK5>(dt);
 }
 
 int PK4::partyCurrHP(void) const
@@ -25,7 +25,7 @@
  */
 
 #include "PK5.hpp"
-#include "loader.hpp"
+#include "Sav.hpp"
 #include "random.hpp"
 
 void PK5::shuffleArray(u8 sv)
@@ -45,21 +45,10 @@ void PK5::shuffleArray(u8 sv)
 
 void PK5::crypt(void)
 {
-    u32 seed = checksum();
-
-    for (int i = 0x08; i < 136; i += 2)
-    {
-        seed = seedStep(seed);
-        data[i] ^= (seed >> 16);
-        data[i + 1] ^= (seed >> 24);
-    }
-
-    seed = PID();
-    for (u32 i = 136; i < length; i += 2)
+    PKXCrypt::xorKeystream(data + 8, 136 - 8, checksum());
+    if (length > 136)
     {
-        seed = seedStep(seed);
-        data[i] ^= (seed >> 16);
-        data[i + 1] ^= (seed >> 24);
+        PKXCrypt::xorKeystream(data + 136, length - 136, PID());
     }
 }
 
@@ -125,20 +114,7 @@ u8 PK5::abilityNumber(void) const
 }
 void PK5::abilityNumber(u8 v)
 {
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, PID(), generation()));
-        } while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, PID(), generation()));
-        } while (shiny());
-    }
+    PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, shiny(), TID(), SID(), generation()));
 }
 
 u32 PK5::PID(void) const
@@ -174,6 +150,7 @@ u16 PK5::species(void) const
 }
 void PK5::species(u16 v)
 {
+    invalidate();
     *(u16*)(data + 0x08) = v;
 }
 
@@ -210,6 +187,7 @@ u32 PK5::experience(void) const
 }
 void PK5::experience(u32 v)
 {
+    invalidate(Derived::LEVEL | Derived::STATS);
     *(u32*)(data + 0x10) = v;
 }
 
@@ -270,6 +248,7 @@ u8 PK5::ev(u8 ev) const
 }
 void PK5::ev(u8 ev, u8 v)
 {
+    invalidate(1 << ev);
     data[0x18 + ev] = v;
 }
 
@@ -329,6 +308,7 @@ u8 PK5::iv(u8 stat) const
 
 void PK5::iv(u8 stat, u8 v)
 {
+    invalidate(Derived::HPTYPE | 1 << stat);
     u32 buffer = *(u32*)(data + 0x38);
     buffer &= ~(0x1F << 5 * stat);
     buffer |= v << (5 * stat);
@@ -369,20 +349,7 @@ u8 PK5::gender(void) const
 void PK5::gender(u8 g)
 {
     data[0x40] = u8((data[0x40] & ~0x06) | (g << 1));
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        } while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        } while (shiny());
-    }
+    PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), shiny(), TID(), SID(), generation()));
 }
 
 u8 PK5::alternativeForm(void) const
@@ -391,6 +358,7 @@ u8 PK5::alternativeForm(void) const
 }
 void PK5::alternativeForm(u8 v)
 {
+    invalidate();
     data[0x40] = u8((data[0x40] & 0x07) | (v << 3));
 }
 
@@ -400,6 +368,7 @@ u8 PK5::nature(void) const
 }
 void PK5::nature(u8 v)
 {
+    invalidate(Derived::STATS);
     data[0x41] = v;
 }
 
@@ -423,11 +392,11 @@ void PK5::nPokemon(bool v)
 
 std::string PK5::nickname(void) const
 {
-    return StringUtils::transString45(StringUtils::getString(data, 0x48, 11, u'\uFFFF'));
+    return StringUtils::getString45(data, 0x48, 11, u'\uFFFF');
 }
 void PK5::nickname(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString45(v), 0x48, 11, u'\uFFFF', 0);
+    StringUtils::setString45(data, v, 0x48, 11, u'\uFFFF', 0);
 }
 
 u8 PK5::version(void) const
@@ -441,11 +410,11 @@ void PK5::version(u8 v)
 
 std::string PK5::otName(void) const
 {
-    return StringUtils::transString45(StringUtils::getString(data, 0x68, 8, u'\uFFFF'));
+    return StringUtils::getString45(data, 0x68, 8, u'\uFFFF');
 }
 void PK5::otName(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString45(v), 0x68, 8, u'\uFFFF', 0);
+    StringUtils::setString45(data, v, 0x68, 8, u'\uFFFF', 0);
 }
 
 u8 PK5::eggYear(void) const
@@ -595,7 +564,12 @@ void PK5::refreshChecksum(void)
 
 u8 PK5::hpType(void) const
 {
-    return 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+    if (!(derived.valid & Derived::HPTYPE))
+    {
+        derived.hpType = 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+        derived.valid |= Derived::HPTYPE;
+    }
+    return derived.hpType;
 }
 void PK5::hpType(u8 v)
 {
@@ -635,11 +609,12 @@ u16 PK5::PSV(void) const
 
 u8 PK5::level(void) const
 {
-    u8 i      = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100)
-        ;
-    return i;
+    if (!(derived.valid & Derived::LEVEL))
+    {
+        derived.level = levelFromExperience(experience(), expType());
+        derived.valid |= Derived::LEVEL;
+    }
+    return derived.level;
 }
 
 void PK5::level(u8 v)
@@ -653,24 +628,19 @@ bool PK5::shiny(void) const
 }
 void PK5::shiny(bool v)
 {
-    if (v)
+    if (shiny() != v)
     {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
-    {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), v, TID(), SID(), generation()));
     }
 }
 
 u16 PK5::formSpecies(void) const
 {
+    if (derived.valid & Derived::FORMSPECIES)
+    {
+        return derived.formSpecies;
+    }
+
     u16 tmpSpecies = species();
     u8 form        = alternativeForm();
     u8 formcount   = PersonalBWB2W2::formCount(tmpSpecies);
@@ -689,26 +659,20 @@ u16 PK5::formSpecies(void) const
         }
     }
 
+    derived.formSpecies = tmpSpecies;
+    derived.valid |= Derived::FORMSPECIES;
     return tmpSpecies;
 }
 
 u16 PK5::stat(const u8 stat) const
 {
-    u16 calc;
-    u8 mult = 10, basestat = 0;
+    if (derived.valid & (1 << stat))
+    {
+        return derived.stats[stat];
+    }
 
-    if (stat == 0)
-        basestat = baseHP();
-    else if (stat == 1)
-        basestat = baseAtk();
-    else if (stat == 2)
-        basestat = baseDef();
-    else if (stat == 3)
-        basestat = baseSpe();
-    else if (stat == 4)
-        basestat = baseSpa();
-    else if (stat == 5)
-        basestat = baseSpd();
+    u16 calc;
+    u8 mult = 10, basestat = baseStat(stat);
 
     if (stat == 0)
         calc = 10 + (2 * basestat + iv(stat) + ev(stat) / 4 + 100) * level() / 100;
@@ -718,7 +682,9 @@ u16 PK5::stat(const u8 stat) const
         mult++;
     if (nature() % 5 + 1 == stat)
         mult--;
-    return calc * mult / 10;
+    derived.stats[stat] = calc * mult / 10;
+    derived.valid |= 1 << stat;
+    return derived.stats[stat];
 }
 
 static void fixString(std::u16string& fixString)
@@ -804,18 +770,18 @@ static void fixString(std::u16string& fixString)
     }
 }
 
-std::shared_ptr<PKX> PK5::next(void) const
+bool PK5::next(const Sav& save, u8* out) const
 {
-    u8 dt[232] = {0};
-    PK6* pk6   = new PK6(dt);
+    std::fill_n(out, 232, 0);
+    PK6 pk6(out, false, false, true);
 
-    pk6->encryptionConstant(PID());
-    pk6->species(species());
-    pk6->TID(TID());
-    pk6->SID(SID());
-    pk6->experience(experience());
-    pk6->PID(PID());
-    pk6->ability(ability());
+    pk6.encryptionConstant(PID());
+    pk6.species(species());
+    pk6.TID(TID());
+    pk6.SID(SID());
+    pk6.experience(experience());
+    pk6.PID(PID());
+    pk6.ability(ability());
 
     u8 pkmAbilities[3] = {abilities(0), abilities(1), abilities(2)};
     u8 abilVal         = std::distance(pkmAbilities, std::find(pkmAbilities, pkmAbilities + 3, ability()));
@@ -825,71 +791,74 @@ std::shared_ptr<PKX> PK5::next(void) const
     }
     if (abilVal <= 3)
     {
-        pk6->abilityNumber(1 << abilVal);
+        pk6.abilityNumber(1 << abilVal);
     }
     else // Shouldn't happen
     {
         if (hiddenAbility())
         {
-            pk6->abilityNumber(4);
+            pk6.abilityNumber(4);
         }
         else
         {
-            pk6->abilityNumber(gen5() ? ((PID() >> 16) & 1) : 1 << (PID() & 1));
+            pk6.abilityNumber(gen5() ? ((PID() >> 16) & 1) : 1 << (PID() & 1));
         }
     }
 
-    pk6->markValue(markValue());
-    pk6->language(language());
+    pk6.markValue(markValue());
+    pk6.language(language());
 
     for (int i = 0; i < 6; i++)
     {
         // EV Cap
-        pk6->ev(i, ev(i) > 252 ? 252 : ev(i));
-        pk6->iv(i, iv(i));
-        pk6->contest(i, contest(i));
+        pk6.ev(i, ev(i) > 252 ? 252 : ev(i));
+        pk6.iv(i, iv(i));
+        pk6.contest(i, contest(i));
     }
 
     for (int i = 0; i < 4; i++)
     {
-        pk6->move(i, move(i));
-        pk6->PPUp(i, PPUp(i));
-        pk6->PP(i, PP(i));
+        pk6.move(i, move(i));
+        pk6.PPUp(i, PPUp(i));
+        pk6.PP(i, PP(i));
     }
 
-    pk6->egg(egg());
-    pk6->nicknamed(nicknamed());
+    pk6.egg(egg());
+    pk6.nicknamed(nicknamed());
 
-    pk6->fatefulEncounter(fatefulEncounter());
-    pk6->gender(gender());
-    pk6->alternativeForm(alternativeForm());
-    pk6->nature(nature());
+    pk6.fatefulEncounter(fatefulEncounter());
+    pk6.gender(gender());
+    pk6.alternativeForm(alternativeForm());
+    pk6.nature(nature());
 
-    pk6->nickname(i18n::species(pk6->language(), pk6->species()));
-    if (nicknamed())
-        pk6->nickname(nickname());
+    // Names are fixed up for Gen 6 on the way, instead of being written, read back and written again
+    std::u16string toFix = StringUtils::UTF8toUTF16(nicknamed() ? nickname() : i18n::species(pk6.language(), pk6.species()));
+    fixString(toFix);
+    pk6.nickname(StringUtils::UTF16toUTF8(toFix));
 
-    pk6->version(version());
+    pk6.version(version());
 
-    pk6->otName(otName());
+    toFix = StringUtils::UTF8toUTF16(otName());
+    fixString(toFix);
+    pk6.otName(StringUtils::UTF16toUTF8(toFix));
 
-    pk6->metYear(metYear());
-    pk6->metMonth(metMonth());
-    pk6->metDay(metDay());
-    pk6->eggYear(eggYear());
-    pk6->eggMonth(eggMonth());
-    pk6->eggDay(eggDay());
+    pk6.metYear(metYear());
+    pk6.metMonth(metMonth());
+    pk6.metDay(metDay());
+    pk6.eggYear(eggYear());
+    pk6.eggMonth(eggMonth());
+    pk6.eggDay(eggDay());
 
-    pk6->metLocation(metLocation());
-    pk6->eggLocation(eggLocation());
+    pk6.metLocation(metLocation());
+    pk6.eggLocation(eggLocation());
 
-    pk6->pkrsStrain(pkrsStrain());
-    pk6->pkrsDays(pkrsDays());
-    pk6->ball(ball());
+    pk6.pkrsStrain(pkrsStrain());
+    pk6.pkrsDays(pkrsDays());
+    pk6.ball(ball());
 
-    pk6->metLevel(metLevel());
-    pk6->otGender(otGender());
-    pk6->encounterType(encounterType());
+    pk6.metLevel(metLevel());
+    pk6.otGender(otGender());
+    pk6.encounterType(encounterType());
 
     // Ribbon
     u8 contestRibbon = 0;
@@ -924,113 +893,118 @@ std::shared_ptr<PKX> PK5::next(void) const
         if (((data[0x24] >> i) & 1) == 1)
             battleRibbon++;
 
-    pk6->ribbonContestCount(contestRibbon);
-    pk6->ribbonBattleCount(battleRibbon);
-
-    pk6->ribbon(0, 1, ribbon(6, 4)); // Hoenn Champion
-    pk6->ribbon(0, 2, ribbon(0, 0)); // Sinnoh Champ
-    pk6->ribbon(0, 7, ribbon(7, 0)); // Effort Ribbon
-
-    pk6->ribbon(1, 0, ribbon(0, 7)); // Alert
-    pk6->ribbon(1, 1, ribbon(1, 0)); // Shock
-    pk6->ribbon(1, 2, ribbon(1, 1)); // Downcast
-    pk6->ribbon(1, 3, ribbon(1, 2)); // Careless
-    pk6->ribbon(1, 4, ribbon(1, 3)); // Relax
-    pk6->ribbon(1, 5, ribbon(1, 4)); // Snooze
-    pk6->ribbon(1, 6, ribbon(1, 5)); // Smile
-    pk6->ribbon(1, 7, ribbon(1, 6)); // Gorgeous
-
-    pk6->ribbon(2, 0, ribbon(1, 7)); // Royal
-    pk6->ribbon(2, 1, ribbon(2, 0)); // Gorgeous Royal
-    pk6->ribbon(2, 2, ribbon(6, 7)); // Artist
-    pk6->ribbon(2, 3, ribbon(2, 1)); // Footprint
-    pk6->ribbon(2, 4, ribbon(2, 2)); // Record
-    pk6->ribbon(2, 5, ribbon(2, 4)); // Legend
-    pk6->ribbon(2, 6, ribbon(7, 4)); // Country
-    pk6->ribbon(2, 7, ribbon(7, 5)); // National
-
-    pk6->ribbon(3, 0, ribbon(7, 6)); // Earth
-    pk6->ribbon(3, 1, ribbon(7, 7)); // World
-    pk6->ribbon(3, 2, ribbon(3, 2)); // Classic
-    pk6->ribbon(3, 3, ribbon(3, 3)); // Premier
-    pk6->ribbon(3, 4, ribbon(2, 3)); // Event
-    pk6->ribbon(3, 5, ribbon(2, 6)); // Birthday
-    pk6->ribbon(3, 6, ribbon(2, 7)); // Special
-    pk6->ribbon(3, 7, ribbon(3, 0)); // Souvenir
-
-    pk6->ribbon(4, 0, ribbon(3, 1)); // Wishing Ribbon
-    pk6->ribbon(4, 1, ribbon(7, 1)); // Battle Champion
-    pk6->ribbon(4, 2, ribbon(7, 2)); // Regional Champion
-    pk6->ribbon(4, 3, ribbon(7, 3)); // National Champion
-    pk6->ribbon(4, 4, ribbon(2, 5)); // World Champion
-
-    pk6->region(TitleLoader::save->subRegion());
-    pk6->country(TitleLoader::save->country());
-    pk6->consoleRegion(TitleLoader::save->consoleRegion());
-
-    pk6->currentHandler(1);
-    pk6->htName(TitleLoader::save->otName());
-    pk6->htGender(TitleLoader::save->gender());
-    pk6->geoRegion(0, TitleLoader::save->subRegion());
-    pk6->geoCountry(0, TitleLoader::save->country());
-    pk6->htIntensity(1);
-    pk6->htMemory(4);
-    pk6->htFeeling(randomNumbers() % 10);
-    pk6->otFriendship(pk6->baseFriendship());
-    pk6->htFriendship(pk6->baseFriendship());
+    pk6.ribbonContestCount(contestRibbon);
+    pk6.ribbonBattleCount(battleRibbon);
+
+    pk6.ribbon(0, 1, ribbon(6, 4)); // Hoenn Champion
+    pk6.ribbon(0, 2, ribbon(0, 0)); // Sinnoh Champ
+    pk6.ribbon(0, 7, ribbon(7, 0)); // Effort Ribbon
+
+    pk6.ribbon(1, 0, ribbon(0, 7)); // Alert
+    pk6.ribbon(1, 1, ribbon(1, 0)); // Shock
+    pk6.ribbon(1, 2, ribbon(1, 1)); // Downcast
+    pk6.ribbon(1, 3, ribbon(1, 2)); // Careless
+    pk6.ribbon(1, 4, ribbon(1, 3)); // Relax
+    pk6.ribbon(1, 5, ribbon(1, 4)); // Snooze
+    pk6.ribbon(1, 6, ribbon(1, 5)); // Smile
+    pk6.ribbon(1, 7, ribbon(1, 6)); // Gorgeous
+
+    pk6.ribbon(2, 0, ribbon(1, 7)); // Royal
+    pk6.ribbon(2, 1, ribbon(2, 0)); // Gorgeous Royal
+    pk6.ribbon(2, 2, ribbon(6, 7)); // Artist
+    pk6.ribbon(2, 3, ribbon(2, 1)); // Footprint
+    pk6.ribbon(2, 4, ribbon(2, 2)); // Record
+    pk6.ribbon(2, 5, ribbon(2, 4)); // Legend
+    pk6.ribbon(2, 6, ribbon(7, 4)); // Country
+    pk6.ribbon(2, 7, ribbon(7, 5)); // National
+
+    pk6.ribbon(3, 0, ribbon(7, 6)); // Earth
+    pk6.ribbon(3, 1, ribbon(7, 7)); // World
+    pk6.ribbon(3, 2, ribbon(3, 2)); // Classic
+    pk6.ribbon(3, 3, ribbon(3, 3)); // Premier
+    pk6.ribbon(3, 4, ribbon(2, 3)); // Event
+    pk6.ribbon(3, 5, ribbon(2, 6)); // Birthday
+    pk6.ribbon(3, 6, ribbon(2, 7)); // Special
+    pk6.ribbon(3, 7, ribbon(3, 0)); // Souvenir
+
+    pk6.ribbon(4, 0, ribbon(3, 1)); // Wishing Ribbon
+    pk6.ribbon(4, 1, ribbon(7, 1)); // Battle Champion
+    pk6.ribbon(4, 2, ribbon(7, 2)); // Regional Champion
+    pk6.ribbon(4, 3, ribbon(7, 3)); // National Champion
+    pk6.ribbon(4, 4, ribbon(2, 5)); // World Champion
+
+    pk6.region(save.subRegion());
+    pk6.country(save.country());
+    pk6.consoleRegion(save.consoleRegion());
+
+    pk6.currentHandler(1);
+    pk6.htName(save.otName());
+    pk6.htGender(save.gender());
+    pk6.geoRegion(0, save.subRegion());
+    pk6.geoCountry(0, save.country());
+    pk6.htIntensity(1);
+    pk6.htMemory(4);
+    pk6.htFeeling(randomNumbers() % 10);
+    pk6.otFriendship(pk6.baseFriendship());
+    pk6.htFriendship(pk6.baseFriendship());
 
     u32 shiny = 0;
     shiny     = (PID() >> 16) ^ (PID() & 0xFFFF) ^ TID() ^ SID();
     if (shiny >= 8 && shiny < 16) // Illegal shiny transfer
-        pk6->PID(pk6->PID() ^ 0x80000000);
-
-    pk6->fixMoves();
+        pk6.PID(pk6.PID() ^ 0x80000000);
 
-    std::u16string toFix = StringUtils::UTF8toUTF16(pk6->otName());
-    fixString(toFix);
-    pk6->otName(StringUtils::UTF16toUTF8(toFix));
+    pk6.fixMoves();
 
-    toFix = StringUtils::UTF8toUTF16(pk6->nickname());
-    fixString(toFix);
-    pk6->nickname(StringUtils::UTF16toUTF8(toFix));
+    pk6.refreshChecksum();
+    return true;
+}
 
-    pk6->refreshChecksum();
-    return std::shared_ptr<PKX>(pk6);
+std::shared_ptr<PKX> PK5::next(const Sav& save) const
+{
+    u8 dt[232];
+    next(save, dt);
+    return std::make_shared<PK6>(dt);
 }
 
-std::shared_ptr<PKX> PK5::previous(void) const
+bool PK5::previous(const Sav& save, u8* out) const
 {
-    u8 dt[136];
-    std::copy(data, data + 136, dt);
+    std::copy(data, data + 136, out);
 
     // Clear nature field
-    dt[0x41] = 0;
+    out[0x41] = 0;
 
-    std::shared_ptr<PKX> pk4 = std::make_shared<PK4>(dt);
+    PK4 pk4(out, false, false, true);
 
     // Force normal Arceus form
-    if (pk4->species() == 493)
+    if (pk4.species() == 493)
     {
-        pk4->alternativeForm(0);
+        pk4.alternativeForm(0);
     }
 
-    pk4->nickname(nickname());
-    pk4->otName(otName());
-    pk4->heldItem(0);
-    pk4->otFriendship(70);
-    pk4->ball(ball());
+    pk4.nickname(nickname());
+    pk4.otName(otName());
+    pk4.heldItem(0);
+    pk4.otFriendship(70);
+    pk4.ball(ball());
     // met location ???
     for (int i = 0; i < 4; i++)
     {
-        if (pk4->move(i) > TitleLoader::save->maxMove())
+        if (pk4.move(i) > save.maxMove())
         {
-            pk4->move(i, 0);
+            pk4.move(i, 0);
         }
     }
-    pk4->fixMoves();
+    pk4.fixMoves();
+
+    pk4.refreshChecksum();
+    return true;
+}
 
-    pk4->refreshChecksum();
-    return pk4;
+std::shared_ptr<PKX> PK5::previous(const Sav& save) const
+{
+    u8 dt[136];
+    previous(save, dt);
+    return std::make_shared<PK4>(dt);
 }
 
 int PK5::partyCurrHP(void) const
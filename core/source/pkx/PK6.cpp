@@ -25,7 +25,7 @@
  */
 
 #include "PK6.hpp"
-#include "loader.hpp"
+#include "Sav.hpp"
 #include "random.hpp"
 
 void PK6::shuffleArray(u8 sv)
@@ -45,21 +45,10 @@ void PK6::shuffleArray(u8 sv)
 
 void PK6::crypt(void)
 {
-    u32 seed = encryptionConstant();
-    for (int i = 0x08; i < 232; i += 2)
+    PKXCrypt::xorKeystream(data + 8, 232 - 8, encryptionConstant());
+    if (length > 232)
     {
-        u16 temp = *(u16*)(data + i);
-        seed     = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
-    }
-    seed = encryptionConstant();
-    for (u32 i = 232; i < length; i += 2)
-    {
-        u16 temp = *(u16*)(data + i);
-        seed     = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
+        PKXCrypt::xorKeystream(data + 232, length - 232, encryptionConstant());
     }
 }
 
@@ -135,6 +124,7 @@ u16 PK6::species(void) const
 }
 void PK6::species(u16 v)
 {
+    invalidate();
     *(u16*)(data + 0x08) = v;
 }
 
@@ -171,6 +161,7 @@ u32 PK6::experience(void) const
 }
 void PK6::experience(u32 v)
 {
+    invalidate(Derived::LEVEL | Derived::STATS);
     *(u32*)(data + 0x10) = v;
 }
 
@@ -240,6 +231,7 @@ u8 PK6::nature(void) const
 }
 void PK6::nature(u8 v)
 {
+    invalidate(Derived::STATS);
     data[0x1C] = v;
 }
 
@@ -267,6 +259,7 @@ u8 PK6::alternativeForm(void) const
 }
 void PK6::alternativeForm(u8 v)
 {
+    invalidate();
     data[0x1D] = u8((data[0x1D] & 0x07) | (v << 3));
 }
 
@@ -276,6 +269,7 @@ u8 PK6::ev(u8 ev) const
 }
 void PK6::ev(u8 ev, u8 v)
 {
+    invalidate(1 << ev);
     data[0x1E + ev] = v;
 }
 
@@ -353,11 +347,11 @@ void PK6::ribbonBattleCount(u8 v)
 
 std::string PK6::nickname(void) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, 0x40, 12));
+    return StringUtils::getString67(data, 0x40, 12);
 }
 void PK6::nickname(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString67(v), 0x40, 12);
+    StringUtils::setString67(data, v, 0x40, 12);
 }
 
 u16 PK6::move(u8 m) const
@@ -422,6 +416,7 @@ u8 PK6::iv(u8 stat) const
 
 void PK6::iv(u8 stat, u8 v)
 {
+    invalidate(Derived::HPTYPE | 1 << stat);
     u32 buffer = *(u32*)(data + 0x74);
     buffer &= ~(0x1F << 5 * stat);
     buffer |= v << (5 * stat);
@@ -448,11 +443,11 @@ void PK6::nicknamed(bool v)
 
 std::string PK6::htName(void) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, 0x78, 12));
+    return StringUtils::getString67(data, 0x78, 12);
 }
 void PK6::htName(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString67(v), 0x78, 12);
+    StringUtils::setString67(data, v, 0x78, 12);
 }
 
 u8 PK6::htGender(void) const
@@ -565,11 +560,11 @@ void PK6::enjoyment(u8 v)
 
 std::string PK6::otName(void) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, 0xB0, 13));
+    return StringUtils::getString67(data, 0xB0, 13);
 }
 void PK6::otName(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString67(v), 0xB0, 12);
+    StringUtils::setString67(data, v, 0xB0, 12);
 }
 
 u8 PK6::otFriendship(void) const
@@ -815,7 +810,12 @@ void PK6::refreshChecksum(void)
 
 u8 PK6::hpType(void) const
 {
-    return 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+    if (!(derived.valid & Derived::HPTYPE))
+    {
+        derived.hpType = 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+        derived.valid |= Derived::HPTYPE;
+    }
+    return derived.hpType;
 }
 void PK6::hpType(u8 v)
 {
@@ -855,11 +855,12 @@ u16 PK6::PSV(void) const
 
 u8 PK6::level(void) const
 {
-    u8 i      = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100)
-        ;
-    return i;
+    if (!(derived.valid & Derived::LEVEL))
+    {
+        derived.level = levelFromExperience(experience(), expType());
+        derived.valid |= Derived::LEVEL;
+    }
+    return derived.level;
 }
 
 void PK6::level(u8 v)
@@ -873,24 +874,19 @@ bool PK6::shiny(void) const
 }
 void PK6::shiny(bool v)
 {
-    if (v)
+    if (shiny() != v)
     {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
-    {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), v, TID(), SID(), generation()));
     }
 }
 
 u16 PK6::formSpecies(void) const
 {
+    if (derived.valid & Derived::FORMSPECIES)
+    {
+        return derived.formSpecies;
+    }
+
     u16 tmpSpecies = species();
     u8 form        = alternativeForm();
     u8 formcount   = PersonalXYORAS::formCount(tmpSpecies);
@@ -909,26 +905,20 @@ u16 PK6::formSpecies(void) const
         }
     }
 
+    derived.formSpecies = tmpSpecies;
+    derived.valid |= Derived::FORMSPECIES;
     return tmpSpecies;
 }
 
 u16 PK6::stat(const u8 stat) const
 {
-    u16 calc;
-    u8 mult = 10, basestat = 0;
+    if (derived.valid & (1 << stat))
+    {
+        return derived.stats[stat];
+    }
 
-    if (stat == 0)
-        basestat = baseHP();
-    else if (stat == 1)
-        basestat = baseAtk();
-    else if (stat == 2)
-        basestat = baseDef();
-    else if (stat == 3)
-        basestat = baseSpe();
-    else if (stat == 4)
-        basestat = baseSpa();
-    else if (stat == 5)
-        basestat = baseSpd();
+    u16 calc;
+    u8 mult = 10, basestat = baseStat(stat);
 
     if (stat == 0)
         calc = 10 + (2 * basestat + iv(stat) + ev(stat) / 4 + 100) * level() / 100;
@@ -938,30 +928,31 @@ u16 PK6::stat(const u8 stat) const
         mult++;
     if (nature() % 5 + 1 == stat)
         mult--;
-    return calc * mult / 10;
+    derived.stats[stat] = calc * mult / 10;
+    derived.valid |= 1 << stat;
+    return derived.stats[stat];
 }
 
-std::shared_ptr<PKX> PK6::next(void) const
+bool PK6::next(const Sav& save, u8* out) const
 {
-    u8 dt[232];
-    std::copy(data, data + 232, dt);
+    std::copy(data, data + 232, out);
 
     // markvalue field moved, clear old gen 6 data
-    dt[0x2A] = 0;
+    out[0x2A] = 0;
 
     // Bank Data clearing
     for (int i = 0x94; i < 0x9E; i++)
-        dt[i] = 0; // Geolocations
+        out[i] = 0; // Geolocations
     for (int i = 0xAA; i < 0xB0; i++)
-        dt[i] = 0; // Amie fullness/enjoyment
+        out[i] = 0; // Amie fullness/enjoyment
     for (int i = 0xE4; i < 0xE8; i++)
-        dt[i] = 0;    // unused
-    dt[0x72] &= 0xFC; // low 2 bits of super training
-    dt[0xDE] = 0;     // gen 4 encounter type
+        out[i] = 0;    // unused
+    out[0x72] &= 0xFC; // low 2 bits of super training
+    out[0xDE] = 0;     // gen 4 encounter type
 
-    PK7* pk7 = new PK7(dt);
+    PK7 pk7(out, false, false, true);
 
-    pk7->markValue(markValue());
+    pk7.markValue(markValue());
 
     switch (abilityNumber())
     {
@@ -971,138 +962,152 @@ std::shared_ptr<PKX> PK6::next(void) const
             u8 index = abilityNumber() >> 1;
             if (abilities(index) == ability())
             {
-                pk7->ability(abilities(index));
+                pk7.ability(abilities(index));
             }
     }
 
-    pk7->htMemory(4);
-    pk7->htTextVar(0);
-    pk7->htIntensity(1);
-    pk7->htFeeling(randomNumbers() % 10);
-    pk7->geoCountry(0, TitleLoader::save->country());
-    pk7->geoRegion(0, TitleLoader::save->subRegion());
+    pk7.htMemory(4);
+    pk7.htTextVar(0);
+    pk7.htIntensity(1);
+    pk7.htFeeling(randomNumbers() % 10);
+    pk7.geoCountry(0, save.country());
+    pk7.geoRegion(0, save.subRegion());
 
-    pk7->currentHandler(1);
+    pk7.currentHandler(1);
 
-    pk7->refreshChecksum();
-    return std::shared_ptr<PKX>(pk7);
+    pk7.refreshChecksum();
+    return true;
 }
 
-std::shared_ptr<PKX> PK6::previous(void) const
+std::shared_ptr<PKX> PK6::next(const Sav& save) const
 {
-    u8 dt[232] = {0};
-    PK5* pk5   = new PK5(dt);
+    u8 dt[232];
+    next(save, dt);
+    return std::make_shared<PK7>(dt);
+}
+
+bool PK6::previous(const Sav& save, u8* out) const
+{
+    std::fill_n(out, 136, 0);
+    PK5 pk5(out, false, false, true);
 
-    pk5->species(species());
-    pk5->TID(TID());
-    pk5->SID(SID());
-    pk5->experience(experience());
-    pk5->PID(PID());
-    pk5->ability(ability());
+    pk5.species(species());
+    pk5.TID(TID());
+    pk5.SID(SID());
+    pk5.experience(experience());
+    pk5.PID(PID());
+    pk5.ability(ability());
 
-    pk5->markValue(markValue());
-    pk5->language(language());
+    pk5.markValue(markValue());
+    pk5.language(language());
 
     for (int i = 0; i < 6; i++)
     {
         // EV Cap
-        pk5->ev(i, ev(i) > 252 ? 252 : ev(i));
-        pk5->iv(i, iv(i));
-        pk5->contest(i, contest(i));
+        pk5.ev(i, ev(i) > 252 ? 252 : ev(i));
+        pk5.iv(i, iv(i));
+        pk5.contest(i, contest(i));
     }
 
     for (int i = 0; i < 4; i++)
     {
-        pk5->move(i, move(i));
-        pk5->PPUp(i, PPUp(i));
-        pk5->PP(i, PP(i));
+        pk5.move(i, move(i));
+        pk5.PPUp(i, PPUp(i));
+        pk5.PP(i, PP(i));
     }
 
-    pk5->egg(egg());
-    pk5->nicknamed(nicknamed());
-
-    pk5->fatefulEncounter(fatefulEncounter());
-    pk5->gender(gender());
-    pk5->alternativeForm(alternativeForm());
-    pk5->nature(nature());
-
-    pk5->version(version());
-
-    pk5->nickname(nickname().substr(0, 11));
-    pk5->otName(otName().substr(0, 7));
-
-    pk5->metYear(metYear());
-    pk5->metMonth(metMonth());
-    pk5->metDay(metDay());
-    pk5->eggYear(eggYear());
-    pk5->eggMonth(eggMonth());
-    pk5->eggDay(eggDay());
-
-    pk5->metLocation(metLocation());
-    pk5->eggLocation(eggLocation());
-
-    pk5->pkrsStrain(pkrsStrain());
-    pk5->pkrsDays(pkrsDays());
-    pk5->ball(ball());
-
-    pk5->metLevel(metLevel());
-    pk5->otGender(otGender());
-    pk5->encounterType(encounterType());
-
-    pk5->ribbon(6, 4, ribbon(0, 1)); // Hoenn Champion
-    pk5->ribbon(0, 0, ribbon(0, 2)); // Sinnoh Champ
-    pk5->ribbon(7, 0, ribbon(0, 7)); // Effort Ribbon
-
-    pk5->ribbon(0, 7, ribbon(1, 0)); // Alert
-    pk5->ribbon(1, 0, ribbon(1, 1)); // Shock
-    pk5->ribbon(1, 1, ribbon(1, 2)); // Downcast
-    pk5->ribbon(1, 2, ribbon(1, 3)); // Careless
-    pk5->ribbon(1, 3, ribbon(1, 4)); // Relax
-    pk5->ribbon(1, 4, ribbon(1, 5)); // Snooze
-    pk5->ribbon(1, 5, ribbon(1, 6)); // Smile
-    pk5->ribbon(1, 6, ribbon(1, 7)); // Gorgeous
-
-    pk5->ribbon(1, 7, ribbon(2, 0)); // Royal
-    pk5->ribbon(2, 0, ribbon(2, 1)); // Gorgeous Royal
-    pk5->ribbon(6, 7, ribbon(2, 2)); // Artist
-    pk5->ribbon(2, 1, ribbon(2, 3)); // Footprint
-    pk5->ribbon(2, 2, ribbon(2, 4)); // Record
-    pk5->ribbon(2, 4, ribbon(2, 5)); // Legend
-    pk5->ribbon(7, 4, ribbon(2, 6)); // Country
-    pk5->ribbon(7, 5, ribbon(2, 7)); // National
-
-    pk5->ribbon(7, 6, ribbon(3, 0)); // Earth
-    pk5->ribbon(7, 7, ribbon(3, 1)); // World
-    pk5->ribbon(3, 2, ribbon(3, 2)); // Classic
-    pk5->ribbon(3, 3, ribbon(3, 3)); // Premier
-    pk5->ribbon(2, 3, ribbon(3, 4)); // Event
-    pk5->ribbon(2, 6, ribbon(3, 5)); // Birthday
-    pk5->ribbon(2, 7, ribbon(3, 6)); // Special
-    pk5->ribbon(3, 0, ribbon(3, 7)); // Souvenir
-
-    pk5->ribbon(3, 1, ribbon(4, 0)); // Wishing Ribbon
-    pk5->ribbon(7, 1, ribbon(4, 1)); // Battle Champion
-    pk5->ribbon(7, 2, ribbon(4, 2)); // Regional Champion
-    pk5->ribbon(7, 3, ribbon(4, 3)); // National Champion
-    pk5->ribbon(2, 5, ribbon(4, 4)); // World Champion
-
-    pk5->otFriendship(pk5->baseFriendship());
+    pk5.egg(egg());
+    pk5.nicknamed(nicknamed());
+
+    pk5.fatefulEncounter(fatefulEncounter());
+    pk5.gender(gender());
+    pk5.alternativeForm(alternativeForm());
+    pk5.nature(nature());
+
+    pk5.version(version());
+
+    pk5.nickname(nickname().substr(0, 11));
+    pk5.otName(otName().substr(0, 7));
+
+    pk5.metYear(metYear());
+    pk5.metMonth(metMonth());
+    pk5.metDay(metDay());
+    pk5.eggYear(eggYear());
+    pk5.eggMonth(eggMonth());
+    pk5.eggDay(eggDay());
+
+    pk5.metLocation(metLocation());
+    pk5.eggLocation(eggLocation());
+
+    pk5.pkrsStrain(pkrsStrain());
+    pk5.pkrsDays(pkrsDays());
+    pk5.ball(ball());
+
+    pk5.metLevel(metLevel());
+    pk5.otGender(otGender());
+    pk5.encounterType(encounterType());
+
+    pk5.ribbon(6, 4, ribbon(0, 1)); // Hoenn Champion
+    pk5.ribbon(0, 0, ribbon(0, 2)); // Sinnoh Champ
+    pk5.ribbon(7, 0, ribbon(0, 7)); // Effort Ribbon
+
+    pk5.ribbon(0, 7, ribbon(1, 0)); // Alert
+    pk5.ribbon(1, 0, ribbon(1, 1)); // Shock
+    pk5.ribbon(1, 1, ribbon(1, 2)); // Downcast
+    pk5.ribbon(1, 2, ribbon(1, 3)); // Careless
+    pk5.ribbon(1, 3, ribbon(1, 4)); // Relax
+    pk5.ribbon(1, 4, ribbon(1, 5)); // Snooze
+    pk5.ribbon(1, 5, ribbon(1, 6)); // Smile
+    pk5.ribbon(1, 6, ribbon(1, 7)); // Gorgeous
+
+    pk5.ribbon(1, 7, ribbon(2, 0)); // Royal
+    pk5.ribbon(2, 0, ribbon(2, 1)); // Gorgeous Royal
+    pk5.ribbon(6, 7, ribbon(2, 2)); // Artist
+    pk5.ribbon(2, 1, ribbon(2, 3)); // Footprint
+    pk5.ribbon(2, 2, ribbon(2, 4)); // Record
+    pk5.ribbon(2, 4, ribbon(2, 5)); // Legend
+    pk5.ribbon(7, 4, ribbon(2, 6)); // Country
+    pk5.ribbon(7, 5, ribbon(2, 7)); // National
+
+    pk5.ribbon(7, 6, ribbon(3, 0)); // Earth
+    pk5.ribbon(7, 7, ribbon(3, 1)); // World
+    pk5.ribbon(3, 2, ribbon(3, 2)); // Classic
+    pk5.ribbon(3, 3, ribbon(3, 3)); // Premier
+    pk5.ribbon(2, 3, ribbon(3, 4)); // Event
+    pk5.ribbon(2, 6, ribbon(3, 5)); // Birthday
+    pk5.ribbon(2, 7, ribbon(3, 6)); // Special
+    pk5.ribbon(3, 0, ribbon(3, 7)); // Souvenir
+
+    pk5.ribbon(3, 1, ribbon(4, 0)); // Wishing Ribbon
+    pk5.ribbon(7, 1, ribbon(4, 1)); // Battle Champion
+    pk5.ribbon(7, 2, ribbon(4, 2)); // Regional Champion
+    pk5.ribbon(7, 3, ribbon(4, 3)); // National Champion
+    pk5.ribbon(2, 5, ribbon(4, 4)); // World Champion
+
+    pk5.otFriendship(pk5.baseFriendship());
 
     // Check if shiny pid needs to be modified
     u16 val = TID() ^ SID() ^ (PID() >> 16) ^ (PID() & 0xFFFF);
     if (shiny() && (val > 7) && (val < 16))
-        pk5->PID(PID() ^ 0x80000000);
+        pk5.PID(PID() ^ 0x80000000);
 
     for (int i = 0; i < 4; i++)
     {
-        if (pk5->move(i) > TitleLoader::save->maxMove())
+        if (pk5.move(i) > save.maxMove())
         {
-            pk5->move(i, 0);
+            pk5.move(i, 0);
         }
     }
 
-    pk5->refreshChecksum();
-    return std::shared_ptr<PKX>(pk5);
+    pk5.refreshChecksum();
+    return true;
+}
+
+std::shared_ptr<PKX> PK6::previous(const Sav& save) const
+{
+    u8 dt[136];
+    previous(save, dt);
+    return std::make_shared<PK5>(dt);
 }
 
 int PK6::partyCurrHP(void) const
@@ -25,7 +25,7 @@
  */
 
 #include "PK7.hpp"
-#include "loader.hpp"
+#include "Sav.hpp"
 #include "random.hpp"
 
 void PK7::shuffleArray(u8 sv)
@@ -45,21 +45,10 @@ void PK7::shuffleArray(u8 sv)
 
 void PK7::crypt(void)
 {
-    u32 seed = encryptionConstant();
-    for (int i = 0x08; i < 232; i += 2)
+    PKXCrypt::xorKeystream(data + 8, 232 - 8, encryptionConstant());
+    if (length > 232)
     {
-        u16 temp = *(u16*)(data + i);
-        seed     = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
-    }
-    seed = encryptionConstant();
-    for (u32 i = 232; i < length; i += 2)
-    {
-        u16 temp = *(u16*)(data + i);
-        seed     = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
+        PKXCrypt::xorKeystream(data + 232, length - 232, encryptionConstant());
     }
 }
 
@@ -126,6 +115,7 @@ u16 PK7::species(void) const
 }
 void PK7::species(u16 v)
 {
+    invalidate();
     *(u16*)(data + 0x08) = v;
 }
 
@@ -162,6 +152,7 @@ u32 PK7::experience(void) const
 }
 void PK7::experience(u32 v)
 {
+    invalidate(Derived::LEVEL | Derived::STATS);
     *(u32*)(data + 0x10) = v;
 }
 
@@ -222,6 +213,7 @@ u8 PK7::nature(void) const
 }
 void PK7::nature(u8 v)
 {
+    invalidate(Derived::STATS);
     data[0x1C] = v;
 }
 
@@ -249,6 +241,7 @@ u8 PK7::alternativeForm(void) const
 }
 void PK7::alternativeForm(u8 v)
 {
+    invalidate();
     data[0x1D] = u8((data[0x1D] & 0x07) | (v << 3));
 }
 
@@ -258,6 +251,7 @@ u8 PK7::ev(u8 ev) const
 }
 void PK7::ev(u8 ev, u8 v)
 {
+    invalidate(1 << ev);
     data[0x1E + ev] = v;
 }
 
@@ -317,11 +311,11 @@ void PK7::ribbon(u8 ribcat, u8 ribnum, u8 v)
 
 std::string PK7::nickname(void) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, 0x40, 12));
+    return StringUtils::getString67(data, 0x40, 12);
 }
 void PK7::nickname(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString67(v), 0x40, 12);
+    StringUtils::setString67(data, v, 0x40, 12);
 }
 
 u16 PK7::move(u8 m) const
@@ -368,6 +362,7 @@ u8 PK7::iv(u8 stat) const
 
 void PK7::iv(u8 stat, u8 v)
 {
+    invalidate(Derived::HPTYPE | 1 << stat);
     u32 buffer = *(u32*)(data + 0x74);
     buffer &= ~(0x1F << 5 * stat);
     buffer |= v << (5 * stat);
@@ -394,11 +389,11 @@ void PK7::nicknamed(bool v)
 
 std::string PK7::htName(void) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, 0x78, 12));
+    return StringUtils::getString67(data, 0x78, 12);
 }
 void PK7::htName(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString67(v), 0x78, 12);
+    StringUtils::setString67(data, v, 0x78, 12);
 }
 
 u8 PK7::htGender(void) const
@@ -511,11 +506,11 @@ void PK7::enjoyment(u8 v)
 
 std::string PK7::otName(void) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, 0xB0, 13));
+    return StringUtils::getString67(data, 0xB0, 13);
 }
 void PK7::otName(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString67(v), 0xB0, 12);
+    StringUtils::setString67(data, v, 0xB0, 12);
 }
 
 u8 PK7::otFriendship(void) const
@@ -677,6 +672,7 @@ bool PK7::hyperTrain(u8 num) const
 }
 void PK7::hyperTrain(u8 num, bool v)
 {
+    invalidate(Derived::STATS);
     data[0xDE] = (u8)((data[0xDE] & ~(1 << num)) | (v ? 1 << num : 0));
 }
 
@@ -761,7 +757,12 @@ void PK7::refreshChecksum(void)
 
 u8 PK7::hpType(void) const
 {
-    return 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+    if (!(derived.valid & Derived::HPTYPE))
+    {
+        derived.hpType = 15 * ((iv(0) & 1) + 2 * (iv(1) & 1) + 4 * (iv(2) & 1) + 8 * (iv(3) & 1) + 16 * (iv(4) & 1) + 32 * (iv(5) & 1)) / 63;
+        derived.valid |= Derived::HPTYPE;
+    }
+    return derived.hpType;
 }
 void PK7::hpType(u8 v)
 {
@@ -802,11 +803,12 @@ u16 PK7::PSV(void) const
 
 u8 PK7::level(void) const
 {
-    u8 i      = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100)
-        ;
-    return i;
+    if (!(derived.valid & Derived::LEVEL))
+    {
+        derived.level = levelFromExperience(experience(), expType());
+        derived.valid |= Derived::LEVEL;
+    }
+    return derived.level;
 }
 
 void PK7::level(u8 v)
@@ -820,24 +822,19 @@ bool PK7::shiny(void) const
 }
 void PK7::shiny(bool v)
 {
-    if (v)
+    if (shiny() != v)
     {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
-    {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), v, TID(), SID(), generation()));
     }
 }
 
 u16 PK7::formSpecies(void) const
 {
+    if (derived.valid & Derived::FORMSPECIES)
+    {
+        return derived.formSpecies;
+    }
+
     u16 tmpSpecies = species();
     u8 form        = alternativeForm();
     u8 formcount   = PersonalSMUSUM::formCount(tmpSpecies);
@@ -856,26 +853,20 @@ u16 PK7::formSpecies(void) const
         }
     }
 
+    derived.formSpecies = tmpSpecies;
+    derived.valid |= Derived::FORMSPECIES;
     return tmpSpecies;
 }
 
 u16 PK7::stat(const u8 stat) const
 {
-    u16 calc;
-    u8 mult = 10, basestat = 0;
+    if (derived.valid & (1 << stat))
+    {
+        return derived.stats[stat];
+    }
 
-    if (stat == 0)
-        basestat = baseHP();
-    else if (stat == 1)
-        basestat = baseAtk();
-    else if (stat == 2)
-        basestat = baseDef();
-    else if (stat == 3)
-        basestat = baseSpe();
-    else if (stat == 4)
-        basestat = baseSpa();
-    else if (stat == 5)
-        basestat = baseSpd();
+    u16 calc;
+    u8 mult = 10, basestat = baseStat(stat);
 
     if (stat == 0)
         calc = 10 + ((2 * basestat) + ((((data[0xDE] >> hyperTrainLookup[stat]) & 1) == 1) ? 31 : iv(stat)) + ev(stat) / 4 + 100) * level() / 100;
@@ -885,20 +876,21 @@ u16 PK7::stat(const u8 stat) const
         mult++;
     if (nature() % 5 + 1 == stat)
         mult--;
-    return calc * mult / 10;
+    derived.stats[stat] = calc * mult / 10;
+    derived.valid |= 1 << stat;
+    return derived.stats[stat];
 }
 
-std::shared_ptr<PKX> PK7::previous(void) const
+bool PK7::previous(const Sav& save, u8* out) const
 {
-    u8 dt[232];
-    std::copy(data, data + 232, dt);
+    std::copy(data, data + 232, out);
 
     // markvalue field moved, clear old gen 7 data
-    *(u16*)(dt + 0x16) = 0;
+    *(u16*)(out + 0x16) = 0;
 
-    PK6* pk6 = new PK6(dt);
+    PK6 pk6(out, false, false, true);
 
-    pk6->markValue(markValue());
+    pk6.markValue(markValue());
 
     switch (abilityNumber())
     {
@@ -908,32 +900,39 @@ std::shared_ptr<PKX> PK7::previous(void) const
             u8 index = abilityNumber() >> 1;
             if (abilities(index) == ability())
             {
-                pk6->ability(pk6->abilities(index));
+                pk6.ability(pk6.abilities(index));
             }
     }
 
-    pk6->htMemory(4);
-    pk6->htTextVar(0);
-    pk6->htIntensity(1);
-    pk6->htFeeling(randomNumbers() % 10);
-    pk6->geoCountry(0, TitleLoader::save->country());
-    pk6->geoRegion(0, TitleLoader::save->subRegion());
+    pk6.htMemory(4);
+    pk6.htTextVar(0);
+    pk6.htIntensity(1);
+    pk6.htFeeling(randomNumbers() % 10);
+    pk6.geoCountry(0, save.country());
+    pk6.geoRegion(0, save.subRegion());
 
     for (int i = 0; i < 4; i++)
     {
-        if (pk6->move(i) > TitleLoader::save->maxMove())
+        if (pk6.move(i) > save.maxMove())
         {
-            pk6->move(i, 0);
+            pk6.move(i, 0);
         }
-        if (pk6->relearnMove(i) > TitleLoader::save->maxMove())
+        if (pk6.relearnMove(i) > save.maxMove())
         {
-            pk6->relearnMove(i, 0);
+            pk6.relearnMove(i, 0);
         }
     }
-    pk6->fixMoves();
+    pk6.fixMoves();
+
+    pk6.refreshChecksum();
+    return true;
+}
 
-    pk6->refreshChecksum();
-    return std::shared_ptr<PKX>(pk6);
+std::shared_ptr<PKX> PK7::previous(const Sav& save) const
+{
+    u8 dt[232];
+    previous(save, dt);
+    return std::make_shared<PK6>(dt);
 }
 
 int PK7::partyCurrHP(void) const
@@ -79,39 +79,53 @@ u32 PKX::expTable(u8 row, u8 col) const
     return table[row][col];
 }
 
-u8 PKX::blockPosition(u8 index) const
+// Same as counting the rows of expTable the experience has reached, but the rows only go up, so a binary search finds the first one it hasn't
+u8 PKX::levelFromExperience(u32 exp, u8 type) const
 {
-    // clang-format off
-    static constexpr u8 blocks[128] = {
-        0, 1, 2, 3, 0, 1, 3, 2, 0, 2, 1, 3, 0, 3, 1, 2,
-        0, 2, 3, 1, 0, 3, 2, 1, 1, 0, 2, 3, 1, 0, 3, 2,
-        2, 0, 1, 3, 3, 0, 1, 2, 2, 0, 3, 1, 3, 0, 2, 1,
-        1, 2, 0, 3, 1, 3, 0, 2, 2, 1, 0, 3, 3, 1, 0, 2,
-        2, 3, 0, 1, 3, 2, 0, 1, 1, 2, 3, 0, 1, 3, 2, 0,
-        2, 1, 3, 0, 3, 1, 2, 0, 2, 3, 1, 0, 3, 2, 1, 0,
-
-        // duplicates of 0-7 to eliminate modulus
-        0, 1, 2, 3, 0, 1, 3, 2, 0, 2, 1, 3, 0, 3, 1, 2,
-        0, 2, 3, 1, 0, 3, 2, 1, 1, 0, 2, 3, 1, 0, 3, 2,
-    };
-    // clang-format on
-
-    return blocks[index];
+    // Only six growth rates exist; anything else comes from a species the personal tables don't have
+    if (type >= 6)
+    {
+        return 1;
+    }
+    u8 low = 1, high = 100;
+    while (low < high)
+    {
+        u8 mid = (low + high) / 2;
+        if (exp >= expTable(mid, type))
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
 }
 
-u8 PKX::blockPositionInvert(u8 index) const
+u8 PKX::baseStat(u8 stat) const
 {
-    static constexpr u8 blocks[32] = {
-        0, 1, 2, 4, 3, 5, 6, 7, 12, 18, 13, 19, 8, 10, 14, 20, 16, 22, 9, 11, 15, 21, 17, 23, 0, 1, 2, 4, 3, 5, 6,
-        7, // duplicates of 0-7 to eliminate modulus
-    };
+    if (!(derived.valid & Derived::BASESTATS))
+    {
+        derived.baseStats[0] = baseHP();
+        derived.baseStats[1] = baseAtk();
+        derived.baseStats[2] = baseDef();
+        derived.baseStats[3] = baseSpe();
+        derived.baseStats[4] = baseSpa();
+        derived.baseStats[5] = baseSpd();
+        derived.valid |= Derived::BASESTATS;
+    }
+    return stat < 6 ? derived.baseStats[stat] : 0;
+}
 
-    return blocks[index];
+u8 PKX::blockPosition(u8 index) const
+{
+    return PKXCrypt::blockPosition(index);
 }
 
-u32 PKX::seedStep(u32 seed)
+u8 PKX::blockPositionInvert(u8 index) const
 {
-    return seed * 0x41C64E6D + 0x6073;
+    return PKXCrypt::blockPositionInvert(index);
 }
 
 void PKX::reorderMoves(void)
@@ -143,6 +157,7 @@ void PKX::reorderMoves(void)
 
 void PKX::decrypt(void)
 {
+    invalidate();
     u8 sv = (encryptionConstant() >> 13) & 31;
     crypt();
     shuffleArray(sv);
@@ -150,6 +165,7 @@ void PKX::decrypt(void)
 
 void PKX::encrypt(void)
 {
+    invalidate();
     u8 sv = (encryptionConstant() >> 13) & 31;
     refreshChecksum();
     shuffleArray(blockPositionInvert(sv));
@@ -302,70 +318,240 @@ static inline u8 getUnownForm(u32 pid)
     return val % 28;
 }
 
-u32 PKX::getRandomPID(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, u32 oldPid, Generation gen)
+namespace
 {
-    if (originGame >= 24) // Origin game over gen 5
+    enum class Shininess
     {
-        return randomNumbers();
-    }
+        EITHER,
+        SHINY,
+        NOT_SHINY
+    };
 
-    u8 (*genderTypeFinder)(u16 species);
-    switch (gen)
-    {
-        case Generation::FOUR:
-            genderTypeFinder = PersonalDPPtHGSS::gender;
-            break;
-        case Generation::FIVE:
-            genderTypeFinder = PersonalBWB2W2::gender;
-            break;
-        case Generation::SIX:
-            genderTypeFinder = PersonalXYORAS::gender;
-            break;
-        case Generation::SEVEN:
-        default:
-            genderTypeFinder = PersonalSMUSUM::gender;
-            break;
+    // Everything a PID has to encode. Pokemon from Gen 6 onward only care about shininess; their nature, ability and gender are stored separately
+    struct PIDRules
+    {
+        bool natureFixed;
+        u8 nature;
+        bool g3unown;
+        u8 form;
+        int abilityBit;  // -1 when either ability will do
+        u8 abilityShift; // Gen 5 reads the ability from bit 16, the others from bit 0
+        u16 genderMin;   // Low bytes in [genderMin, genderMax) give the right gender
+        u16 genderMax;
+        Shininess shininess;
+        u16 trainerXor; // TID ^ SID
+        u8 shinyShift;  // How many low bits of the XOR of the four halves can differ from zero for the Pokemon to still be shiny
+    };
+
+    PIDRules pidRules(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, Generation gen)
+    {
+        PIDRules ret;
+        ret.natureFixed  = originGame <= 15;
+        ret.nature       = nature;
+        ret.g3unown      = originGame <= 5 && species == 201;
+        ret.form         = form;
+        ret.abilityBit   = ret.g3unown || (abilityNum != 1 && abilityNum != 2) ? -1 : abilityNum - 1;
+        ret.abilityShift = gen == Generation::FIVE ? 16 : 0;
+        ret.genderMin    = 0;
+        ret.genderMax    = 0x100;
+        ret.shininess    = Shininess::EITHER;
+        ret.trainerXor   = 0;
+        ret.shinyShift   = gen == Generation::FOUR || gen == Generation::FIVE ? 3 : 4;
+
+        if (originGame >= 24) // Origin game over gen 5
+        {
+            ret.natureFixed = ret.g3unown = false;
+            ret.abilityBit  = -1;
+            return ret;
+        }
+
+        u8 genderType;
+        switch (gen)
+        {
+            case Generation::FOUR:
+                genderType = PersonalDPPtHGSS::gender(species);
+                break;
+            case Generation::FIVE:
+                genderType = PersonalBWB2W2::gender(species);
+                break;
+            case Generation::SIX:
+                genderType = PersonalXYORAS::gender(species);
+                break;
+            case Generation::SEVEN:
+            default:
+                genderType = PersonalSMUSUM::gender(species);
+                break;
+        }
+        if (genderType != 255 && genderType != 254 && genderType != 0 && gender < 2)
+        {
+            ret.genderMin = gender == 1 ? 0 : genderType;
+            ret.genderMax = gender == 1 ? genderType : 0x100;
+        }
+        // The only low byte of the right gender may have the wrong ability bit, which no PID can satisfy. Gender wins
+        if (ret.abilityBit != -1 && ret.abilityShift == 0 && ret.genderMax - ret.genderMin == 1 && (ret.genderMin & 1) != ret.abilityBit)
+        {
+            ret.abilityBit = -1;
+        }
+        return ret;
     }
 
-    u8 genderType = genderTypeFinder(species);
-    bool g3unown  = originGame <= 5 && species == 201;
-    while (true)
+    bool pidFits(u32 pid, const PIDRules& rules)
     {
-        u32 possiblePID = randomNumbers();
-        if (originGame <= 15 && possiblePID % 25 != nature)
+        if (rules.natureFixed && pid % 25 != rules.nature)
+        {
+            return false;
+        }
+        if (rules.g3unown && getUnownForm(pid) != rules.form)
+        {
+            return false;
+        }
+        if (rules.abilityBit != -1 && int((pid >> rules.abilityShift) & 1) != rules.abilityBit)
+        {
+            return false;
+        }
+        if ((pid & 0xFF) < rules.genderMin || (pid & 0xFF) >= rules.genderMax)
+        {
+            return false;
+        }
+        if (rules.shininess != Shininess::EITHER)
         {
-            continue;
+            bool shiny = (((pid >> 16) ^ (pid & 0xFFFF) ^ rules.trainerXor) >> rules.shinyShift) == 0;
+            return shiny == (rules.shininess == Shininess::SHINY);
         }
+        return true;
+    }
 
-        if (g3unown)
+    // Puts the bits getUnownForm reads where they give the wanted form. When the PID has to be shiny, the form's top two bits come from the
+    // high half, which the low half and the trainer IDs decide, so only values that agree with those can be used. Returns false if none can
+    bool placeUnownForm(u32& pid, const PIDRules& rules, u32 random)
+    {
+        u8 values[10];
+        u8 count = 0;
+        for (u16 value = rules.form; value < 0x100; value += 28)
         {
-            if (getUnownForm(possiblePID) != form)
+            if (rules.shininess != Shininess::SHINY || ((value >> 6) & 3) == (((value >> 2) & 3) ^ ((rules.trainerXor >> 8) & 3)))
             {
-                continue;
+                values[count++] = value;
             }
         }
-        else if (abilityNum != 4)
+        if (count == 0)
+        {
+            return false;
+        }
+        u8 value = values[random % count];
+        pid      = (pid & ~0x03030303) | (value & 0xC0) << 18 | (value & 0x30) << 12 | (value & 0x0C) << 6 | (value & 0x03);
+        return true;
+    }
+
+    // Builds a PID that satisfies every rule instead of drawing random ones until one does. The gender picks the low byte, the ability is put
+    // in its bit, the Unown form in its bits, and shininess decides the high half from the low half and the trainer IDs. What's left are the
+    // bits none of those fix, which are stepped through until the nature comes out right; that takes at most 25 steps when they can move the
+    // PID by a fixed amount, and only a few on average when shininess leaves just the lowest bits of each half free
+    u32 solvePID(const PIDRules& rules)
+    {
+        const u16 shinyMask = (1 << rules.shinyShift) - 1;
+        for (int attempt = 0; attempt < 0x100; attempt++)
         {
-            if (abilityNum == 1 && (possiblePID & (1 << (gen == Generation::FIVE ? 16 : 0))))
+            u32 pid   = randomNumbers();
+            u32 extra = randomNumbers();
+
+            u16 low   = rules.genderMin;
+            u16 count = rules.genderMax - rules.genderMin;
+            if (rules.abilityBit != -1 && rules.abilityShift == 0)
             {
-                continue;
+                low += (low & 1) != rules.abilityBit;
+                count = (rules.genderMax - low + 1) / 2;
+                low += 2 * (extra % count);
             }
-            else if (abilityNum == 2 && !(possiblePID & (1 << (gen == Generation::FIVE ? 16 : 0))))
+            else
             {
-                continue;
+                low += extra % count;
             }
-        }
+            pid = (pid & ~0xFF) | low;
 
-        if (genderType == 255 || genderType == 254 || genderType == 0 || gender == 2)
-        {
-            return possiblePID;
+            if (rules.g3unown && !placeUnownForm(pid, rules, extra >> 8))
+            {
+                break;
+            }
+            if (rules.abilityBit != -1)
+            {
+                pid = (pid & ~(1 << rules.abilityShift)) | rules.abilityBit << rules.abilityShift;
+            }
+
+            // Bits that can change without breaking anything above
+            u32 free;
+            if (rules.shininess == Shininess::SHINY)
+            {
+                u16 high = (((pid & 0xFFFF) ^ rules.trainerXor) & ~shinyMask) | ((pid >> 16) & shinyMask);
+                pid      = u32(high) << 16 | (pid & 0xFFFF);
+                free     = shinyMask << 16 | shinyMask;
+            }
+            else if (rules.g3unown)
+            {
+                // Unown has no gender, so its low byte is free. Stepping bits 2 to 7 moves the PID by 4, which reaches every nature
+                free = 0xFC;
+            }
+            else
+            {
+                // Stepping the high half moves the PID by 0x10000, which is 11 mod 25
+                free = 0xFFFF0000;
+            }
+            if (rules.abilityBit != -1)
+            {
+                free &= ~(1 << rules.abilityShift);
+            }
+            if (rules.g3unown)
+            {
+                free &= ~0x03030303;
+            }
+            if (rules.genderMax - rules.genderMin != 0x100 || (rules.abilityBit != -1 && rules.abilityShift == 0))
+            {
+                free &= ~0xFF;
+            }
+
+            // With shininess fixed only a few bits are free, so try all of them. Otherwise 25 steps reach every nature
+            u32 steps = rules.shininess == Shininess::SHINY ? 1 << __builtin_popcount(free) : 25;
+            for (u32 step = 0; step < steps; step++)
+            {
+                if (pidFits(pid, rules))
+                {
+                    return pid;
+                }
+                // Next value of the free bits, with the others left alone
+                pid = (pid & ~free) | (((pid | ~free) + 1) & free);
+            }
         }
 
-        if (gender == genderFromRatio(possiblePID, genderType))
+        // A shiny Gen 3 Unown gets here when the trainer IDs make its form impossible to get while shiny, so it keeps its form instead
+        if (rules.shininess != Shininess::EITHER)
         {
-            return possiblePID;
+            PIDRules loose  = rules;
+            loose.shininess = Shininess::EITHER;
+            return solvePID(loose);
         }
+        // Nothing fits rules like an out of range nature
+        return randomNumbers();
+    }
+}
+
+u32 PKX::getRandomPID(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, bool shiny, u16 tid, u16 sid, Generation gen)
+{
+    PIDRules rules   = pidRules(species, gender, originGame, nature, form, abilityNum, gen);
+    rules.shininess  = shiny ? Shininess::SHINY : Shininess::NOT_SHINY;
+    rules.trainerXor = tid ^ sid;
+    return solvePID(rules);
+}
+
+bool PKX::checksumValid(void) const
+{
+    // The checksum only covers the box format, which is 136 bytes before Gen 6 and 232 after
+    u32 end = generation() == Generation::FOUR || generation() == Generation::FIVE ? 136 : 232;
+    u16 chk = 0;
+    for (u32 i = 8; i < end; i += 2)
+    {
+        chk += *(u16*)(data + i);
     }
+    return chk == checksum();
 }
 
 u32 PKX::versionTID() const
@@ -442,6 +628,79 @@ std::shared_ptr<PKX> PKX::getPKM(Generation gen, u8* data, bool ekx, bool party)
     }
 }
 
+u32 PKX::boxSize(Generation gen)
+{
+    switch (gen)
+    {
+        case Generation::FOUR:
+        case Generation::FIVE:
+            return 136;
+        case Generation::SIX:
+        case Generation::SEVEN:
+            return 232;
+        case Generation::LGPE:
+            return 260;
+        default:
+            return 0;
+    }
+}
+
+// One generation up or down, through a PKX that reads the input where it is
+static bool convertStep(const Sav& save, Generation gen, const u8* in, bool up, u8* out)
+{
+    u8* source = const_cast<u8*>(in);
+    switch (gen)
+    {
+        case Generation::FOUR:
+            return up && PK4(source, false, false, true).next(save, out);
+        case Generation::FIVE:
+        {
+            PK5 pk5(source, false, false, true);
+            return up ? pk5.next(save, out) : pk5.previous(save, out);
+        }
+        case Generation::SIX:
+        {
+            PK6 pk6(source, false, false, true);
+            return up ? pk6.next(save, out) : pk6.previous(save, out);
+        }
+        case Generation::SEVEN:
+            return !up && PK7(source, false, false, true).previous(save, out);
+        default:
+            return false;
+    }
+}
+
+bool PKX::convert(const Sav& save, Generation from, const u8* in, Generation to, u8* out)
+{
+    if (from == to)
+    {
+        std::copy(in, in + boxSize(from), out);
+        return boxSize(from) != 0;
+    }
+    if (from > Generation::SEVEN || to > Generation::SEVEN)
+    {
+        return false;
+    }
+
+    // The steps in between take turns with these, and the last one writes to out
+    u8 buffers[2][232];
+    u8 buffer = 0;
+    while (from != to)
+    {
+        bool up            = from < to;
+        Generation nextGen = Generation(u8(from) + (up ? 1 : -1));
+        u8* dest           = nextGen == to ? out : buffers[buffer];
+        if (!convertStep(save, from, in, up, dest))
+        {
+            return false;
+        }
+        in   = dest;
+        from = nextGen;
+        buffer ^= 1;
+    }
+    return true;
+}
+
 bool PKX::operator==(const PKFilter& filter) const
 {
     if (filter.generationEnabled() && (filter.generationInversed() != (generation() != filter.generation())))
@@ -0,0 +1,234 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "PKXCrypt.hpp"
+#include <cstring>
+
+// The LCG is s' = s * A + C, which makes s stepped k times equal to s * A^k + C_k. Eight states are
+// stepped at once with the jump to eight steps ahead, so there is no serial dependency between the
+// words of one block and the compiler is free to put the lanes in SIMD registers where they exist
+namespace
+{
+    constexpr u32 A = 0x41C64E6D;
+    constexpr u32 C = 0x6073;
+
+    struct Jump
+    {
+        u32 mult;
+        u32 add;
+    };
+
+    constexpr Jump jump(u32 steps)
+    {
+        Jump ret{1, 0};
+        for (u32 i = 0; i < steps; i++)
+        {
+            ret.mult = ret.mult * A;
+            ret.add  = ret.add * A + C;
+        }
+        return ret;
+    }
+
+    constexpr Jump jump8 = jump(8);
+
+    typedef u32 u32x4 __attribute__((vector_size(16)));
+
+    struct Format
+    {
+        u32 length;
+        u32 blockLength;
+        bool checksumSeed; // Gen 4 and 5 seed the block keystream with the checksum instead of the PID
+    };
+
+    Format format(Generation gen)
+    {
+        switch (gen)
+        {
+            case Generation::FOUR:
+            case Generation::FIVE:
+                return {136, 32, true};
+            case Generation::SIX:
+            case Generation::SEVEN:
+                return {232, 56, false};
+            case Generation::LGPE:
+                return {260, 56, false};
+            default:
+                return {0, 0, false};
+        }
+    }
+
+    // Bytes 0-7 are never encrypted: encryption constant or PID at 0, checksum at 6
+    u32 pv(const u8* pkm)
+    {
+        u32 ret;
+        std::memcpy(&ret, pkm, 4);
+        return ret;
+    }
+
+    u16 storedChecksum(const u8* pkm)
+    {
+        u16 ret;
+        std::memcpy(&ret, pkm + 6, 2);
+        return ret;
+    }
+
+    void crypt(const Format& fmt, u8* pkm)
+    {
+        const u32 blocksEnd = 8 + 4 * fmt.blockLength;
+        PKXCrypt::xorKeystream(pkm + 8, blocksEnd - 8, fmt.checksumSeed ? storedChecksum(pkm) : pv(pkm));
+        if (fmt.length > blocksEnd)
+        {
+            PKXCrypt::xorKeystream(pkm + blocksEnd, fmt.length - blocksEnd, pv(pkm));
+        }
+    }
+
+    void shuffle(const Format& fmt, u8* pkm, u8 sv)
+    {
+        u8 blocks[4 * 56];
+        std::memcpy(blocks, pkm + 8, 4 * fmt.blockLength);
+        for (u8 block = 0; block < 4; block++)
+        {
+            u8 ofs = PKXCrypt::blockPosition(sv * 4 + block);
+            std::memcpy(pkm + 8 + fmt.blockLength * block, blocks + fmt.blockLength * ofs, fmt.blockLength);
+        }
+    }
+
+    u16 checksum(const Format& fmt, const u8* pkm)
+    {
+        u16 chk = 0;
+        for (u32 i = 8; i < 8 + 4 * fmt.blockLength; i += 2)
+        {
+            u16 word;
+            std::memcpy(&word, pkm + i, 2);
+            chk += word;
+        }
+        return chk;
+    }
+}
+
+void PKXCrypt::xorKeystream(u8* data, u32 len, u32 seed)
+{
+    u32 i     = 0;
+    u32 state = seed * A + C;
+    if (len >= 16)
+    {
+        // even holds states 1, 3, 5, 7 and odd holds states 2, 4, 6, 8. One u32 of data takes the upper
+        // half of an even state in its low word and the upper half of the following odd state in its high word
+        u32x4 even, odd;
+        for (int lane = 0; lane < 4; lane++)
+        {
+            even[lane] = state;
+            odd[lane]  = state * A + C;
+            state      = odd[lane] * A + C;
+        }
+        for (; i + 16 <= len; i += 16)
+        {
+            u32x4 block;
+            std::memcpy(&block, data + i, 16);
+            block ^= (even >> 16) | (odd & 0xFFFF0000);
+            std::memcpy(data + i, &block, 16);
+            even = even * jump8.mult + jump8.add;
+            odd  = odd * jump8.mult + jump8.add;
+        }
+        state = even[0];
+    }
+    for (; i < len; i += 2)
+    {
+        u16 word;
+        std::memcpy(&word, data + i, 2);
+        word ^= state >> 16;
+        std::memcpy(data + i, &word, 2);
+        state = state * A + C;
+    }
+}
+
+u8 PKXCrypt::blockPosition(u8 index)
+{
+    // clang-format off
+    static constexpr u8 blocks[128] = {
+        0, 1, 2, 3, 0, 1, 3, 2, 0, 2, 1, 3, 0, 3, 1, 2,
+        0, 2, 3, 1, 0, 3, 2, 1, 1, 0, 2, 3, 1, 0, 3, 2,
+        2, 0, 1, 3, 3, 0, 1, 2, 2, 0, 3, 1, 3, 0, 2, 1,
+        1, 2, 0, 3, 1, 3, 0, 2, 2, 1, 0, 3, 3, 1, 0, 2,
+        2, 3, 0, 1, 3, 2, 0, 1, 1, 2, 3, 0, 1, 3, 2, 0,
+        2, 1, 3, 0, 3, 1, 2, 0, 2, 3, 1, 0, 3, 2, 1, 0,
+
+        // duplicates of 0-7 to eliminate modulus
+        0, 1, 2, 3, 0, 1, 3, 2, 0, 2, 1, 3, 0, 3, 1, 2,
+        0, 2, 3, 1, 0, 3, 2, 1, 1, 0, 2, 3, 1, 0, 3, 2,
+    };
+    // clang-format on
+
+    return blocks[index];
+}
+
+u8 PKXCrypt::blockPositionInvert(u8 index)
+{
+    static constexpr u8 blocks[32] = {
+        0, 1, 2, 4, 3, 5, 6, 7, 12, 18, 13, 19, 8, 10, 14, 20, 16, 22, 9, 11, 15, 21, 17, 23, 0, 1, 2, 4, 3, 5, 6,
+        7, // duplicates of 0-7 to eliminate modulus
+    };
+
+    return blocks[index];
+}
+
+void PKXCrypt::decryptRange(Generation gen, u8* base, u32 stride, u32 count)
+{
+    const Format fmt = format(gen);
+    if (fmt.length == 0)
+    {
+        return;
+    }
+    for (u32 i = 0; i < count; i++)
+    {
+        u8* pkm = base + stride * i;
+        crypt(fmt, pkm);
+        shuffle(fmt, pkm, (pv(pkm) >> 13) & 31);
+    }
+}
+
+bool PKXCrypt::encryptRange(Generation gen, u8* base, u32 stride, u32 count)
+{
+    const Format fmt = format(gen);
+    bool changed     = false;
+    if (fmt.length == 0)
+    {
+        return changed;
+    }
+    for (u32 i = 0; i < count; i++)
+    {
+        u8* pkm = base + stride * i;
+        u16 chk = checksum(fmt, pkm);
+        if (chk != storedChecksum(pkm))
+        {
+            std::memcpy(pkm + 6, &chk, 2);
+            changed = true;
+        }
+        shuffle(fmt, pkm, blockPositionInvert((pv(pkm) >> 13) & 31));
+        crypt(fmt, pkm);
+    }
+    return changed;
+}
@@ -0,0 +1,122 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "PKXIndex.hpp"
+
+namespace
+{
+    // FNV-1a over the OT name, TID and SID, so that Pokemon from the same trainer can be grouped with one compare
+    u32 hashOT(const std::string& name, u16 tid, u16 sid)
+    {
+        u32 hash = 0x811C9DC5;
+        for (char c : name)
+        {
+            hash = (hash ^ u8(c)) * 0x01000193;
+        }
+        for (u8 b : {u8(tid), u8(tid >> 8), u8(sid), u8(sid >> 8)})
+        {
+            hash = (hash ^ b) * 0x01000193;
+        }
+        return hash;
+    }
+}
+
+void PKXIndex::reset(size_t slots)
+{
+    for (auto& column : columns)
+    {
+        column.assign(slots, 0);
+    }
+    occupied.assign(slots, 0);
+    otHashes.assign(slots, 0);
+    nicknames.assign(slots, "");
+    otNames.assign(slots, "");
+}
+
+void PKXIndex::set(size_t index, const PKX& pkm)
+{
+    if (index >= size())
+    {
+        return;
+    }
+    if (pkm.encryptionConstant() == 0 && pkm.species() == 0)
+    {
+        clear(index);
+        return;
+    }
+
+    occupied[index]                             = pkm.encryptionConstant() != 0 && pkm.species() != 0;
+    columns[size_t(Column::SPECIES)][index]     = pkm.species();
+    columns[size_t(Column::FORM)][index]        = pkm.alternativeForm();
+    columns[size_t(Column::LEVEL)][index]       = pkm.level();
+    columns[size_t(Column::NATURE)][index]      = pkm.nature();
+    columns[size_t(Column::TSV)][index]         = pkm.TSV();
+    columns[size_t(Column::BALL)][index]        = pkm.ball();
+    columns[size_t(Column::LANGUAGE)][index]    = pkm.language();
+    columns[size_t(Column::SHINY)][index]       = pkm.shiny();
+    columns[size_t(Column::TYPE1)][index]       = pkm.type1();
+    columns[size_t(Column::TYPE2)][index]       = pkm.type2();
+    columns[size_t(Column::TID)][index]         = pkm.TID();
+    columns[size_t(Column::HIDDENPOWER)][index] = pkm.hpType();
+    columns[size_t(Column::FRIENDSHIP)][index]  = pkm.currentFriendship();
+    for (u8 stat = 0; stat < 6; stat++)
+    {
+        columns[size_t(ivColumn(stat))][index]   = pkm.iv(stat);
+        columns[size_t(statColumn(stat))][index] = pkm.stat(stat);
+    }
+    nicknames[index] = pkm.nickname();
+    otNames[index]   = pkm.otName();
+    otHashes[index]  = hashOT(otNames[index], pkm.TID(), pkm.SID());
+}
+
+void PKXIndex::clear(size_t index)
+{
+    if (index >= size())
+    {
+        return;
+    }
+    for (auto& column : columns)
+    {
+        column[index] = 0;
+    }
+    occupied[index] = 0;
+    otHashes[index] = 0;
+    nicknames[index].clear();
+    otNames[index].clear();
+}
+
+std::vector<u32> PKXIndex::occupiedRows(void) const
+{
+    std::vector<u32> ret;
+    for (size_t i = 0; i < size(); i++)
+    {
+        if (occupied[i])
+        {
+            ret.push_back(i);
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,72 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "PKXView.hpp"
+
+PKXView::PKXView(Generation gen, const u8* data)
+{
+    // The PKX classes take a mutable pointer, but nothing here ever writes through it
+    u8* dt = const_cast<u8*>(data);
+    switch (gen)
+    {
+        case Generation::FOUR:
+            pkm.emplace<PK4>(dt, false, false, true);
+            break;
+        case Generation::FIVE:
+            pkm.emplace<PK5>(dt, false, false, true);
+            break;
+        case Generation::SIX:
+            pkm.emplace<PK6>(dt, false, false, true);
+            break;
+        case Generation::SEVEN:
+            pkm.emplace<PK7>(dt, false, false, true);
+            break;
+        case Generation::LGPE:
+            pkm.emplace<PB7>(dt, false, true);
+            break;
+        default:
+            break;
+    }
+}
+
+const PKX* PKXView::get(void) const
+{
+    switch (pkm.index())
+    {
+        case 1:
+            return std::get_if<PK4>(&pkm);
+        case 2:
+            return std::get_if<PK5>(&pkm);
+        case 3:
+            return std::get_if<PK6>(&pkm);
+        case 4:
+            return std::get_if<PK7>(&pkm);
+        case 5:
+            return std::get_if<PB7>(&pkm);
+        default:
+            return nullptr;
+    }
+}
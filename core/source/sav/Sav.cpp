@@ -25,6 +25,7 @@
  */
 
 #include "Sav.hpp"
+#include "PKXView.hpp"
 #include "SavB2W2.hpp"
 #include "SavBW.hpp"
 #include "SavDP.hpp"
@@ -41,40 +42,30 @@ Sav::~Sav()
     delete[] data;
 }
 
-u16 Sav::ccitt16(const u8* buf, u32 len)
+std::unique_ptr<Sav> Sav::getSave(u8* dt, size_t length)
 {
-    u16 crc = 0xFFFF;
-    for (u32 i = 0; i < len; i++)
-    {
-        crc ^= (u16)(buf[i] << 8);
-        for (u32 j = 0; j < 0x8; j++)
-        {
-            if ((crc & 0x8000) > 0)
-                crc = (u16)((crc << 1) ^ 0x1021);
-            else
-                crc <<= 1;
-        }
-    }
-    return crc;
+    std::unique_ptr<u8[]> buffer(new u8[length]);
+    std::copy(dt, dt + length, buffer.get());
+    return getSave(std::move(buffer), length);
 }
 
-std::unique_ptr<Sav> Sav::getSave(u8* dt, size_t length)
+std::unique_ptr<Sav> Sav::getSave(std::unique_ptr<u8[]> dt, size_t length)
 {
     switch (length)
     {
         case 0x6CC00:
-            return std::make_unique<SavUSUM>(dt);
+            return std::make_unique<SavUSUM>(std::move(dt));
         case 0x6BE00:
-            return std::make_unique<SavSUMO>(dt);
+            return std::make_unique<SavSUMO>(std::move(dt));
         case 0x76000:
-            return std::make_unique<SavORAS>(dt);
+            return std::make_unique<SavORAS>(std::move(dt));
         case 0x65600:
-            return std::make_unique<SavXY>(dt);
+            return std::make_unique<SavXY>(std::move(dt));
         case 0x80000:
             return checkDSType(dt);
         case 0xB8800:
         case 0x100000:
-            return std::make_unique<SavLGPE>(dt);
+            return std::make_unique<SavLGPE>(std::move(dt), length);
         default:
             return std::unique_ptr<Sav>(nullptr);
     }
@@ -83,13 +74,13 @@ std::unique_ptr<Sav> Sav::getSave(u8* dt, size_t length)
 bool Sav::isValidDSSave(u8* dt)
 {
     u16 chk1    = *(u16*)(dt + 0x24000 - 0x100 + 0x8C + 0xE);
-    u16 actual1 = ccitt16(dt + 0x24000 - 0x100, 0x8C);
+    u16 actual1 = CRC::ccitt16(dt + 0x24000 - 0x100, 0x8C);
     if (chk1 == actual1)
     {
         return true;
     }
     u16 chk2    = *(u16*)(dt + 0x26000 - 0x100 + 0x94 + 0xE);
-    u16 actual2 = ccitt16(dt + 0x26000 - 0x100, 0x94);
+    u16 actual2 = CRC::ccitt16(dt + 0x26000 - 0x100, 0x94);
     if (chk2 == actual2)
     {
         return true;
@@ -116,39 +107,39 @@ bool Sav::isValidDSSave(u8* dt)
     return false;
 }
 
-std::unique_ptr<Sav> Sav::checkDSType(u8* dt)
+std::unique_ptr<Sav> Sav::checkDSType(std::unique_ptr<u8[]>& dt)
 {
-    u16 chk1    = *(u16*)(dt + 0x24000 - 0x100 + 0x8C + 0xE);
-    u16 actual1 = ccitt16(dt + 0x24000 - 0x100, 0x8C);
+    u16 chk1    = *(u16*)(dt.get() + 0x24000 - 0x100 + 0x8C + 0xE);
+    u16 actual1 = CRC::ccitt16(dt.get() + 0x24000 - 0x100, 0x8C);
     if (chk1 == actual1)
     {
-        return std::make_unique<SavBW>(dt);
+        return std::make_unique<SavBW>(std::move(dt));
     }
-    u16 chk2    = *(u16*)(dt + 0x26000 - 0x100 + 0x94 + 0xE);
-    u16 actual2 = ccitt16(dt + 0x26000 - 0x100, 0x94);
+    u16 chk2    = *(u16*)(dt.get() + 0x26000 - 0x100 + 0x94 + 0xE);
+    u16 actual2 = CRC::ccitt16(dt.get() + 0x26000 - 0x100, 0x94);
     if (chk2 == actual2)
     {
-        return std::make_unique<SavB2W2>(dt);
+        return std::make_unique<SavB2W2>(std::move(dt));
     }
 
     // Check for block identifiers
     u8 dpPattern[]   = {0x00, 0xC1, 0x00, 0x00, 0x23, 0x06, 0x06, 0x20, 0x00, 0x00};
     u8 ptPattern[]   = {0x2C, 0xCF, 0x00, 0x00, 0x23, 0x06, 0x06, 0x20, 0x00, 0x00};
     u8 hgssPattern[] = {0x28, 0xF6, 0x00, 0x00, 0x23, 0x06, 0x06, 0x20, 0x00, 0x00};
-    if (validSequence(dt, dpPattern))
-        return std::make_unique<SavDP>(dt);
-    if (validSequence(dt, ptPattern))
-        return std::make_unique<SavPT>(dt);
-    if (validSequence(dt, hgssPattern))
-        return std::make_unique<SavHGSS>(dt);
+    if (validSequence(dt.get(), dpPattern))
+        return std::make_unique<SavDP>(std::move(dt));
+    if (validSequence(dt.get(), ptPattern))
+        return std::make_unique<SavPT>(std::move(dt));
+    if (validSequence(dt.get(), hgssPattern))
+        return std::make_unique<SavHGSS>(std::move(dt));
 
     // Check the other save
-    if (validSequence(dt, dpPattern, 0x40000))
-        return std::make_unique<SavDP>(dt);
-    if (validSequence(dt, ptPattern, 0x40000))
-        return std::make_unique<SavPT>(dt);
-    if (validSequence(dt, hgssPattern, 0x40000))
-        return std::make_unique<SavHGSS>(dt);
+    if (validSequence(dt.get(), dpPattern, 0x40000))
+        return std::make_unique<SavDP>(std::move(dt));
+    if (validSequence(dt.get(), ptPattern, 0x40000))
+        return std::make_unique<SavPT>(std::move(dt));
+    if (validSequence(dt.get(), hgssPattern, 0x40000))
+        return std::make_unique<SavHGSS>(std::move(dt));
     return nullptr;
 }
 
@@ -161,19 +152,102 @@ bool Sav::validSequence(u8* dt, u8* pattern, int shift)
     return true;
 }
 
-void Sav::transfer(std::shared_ptr<PKX>& pk)
+void Sav::markDirty(u32 offset, u32 len)
+{
+    auto [start, end] = boxStorage();
+    if (offset < end && offset + len > start)
+    {
+        slotIndex = nullptr;
+    }
+    markPages(offset, len);
+}
+
+void Sav::markPages(u32 offset, u32 len)
 {
-    while (pk->generation() != generation())
+    if (allDirty || len == 0)
+    {
+        return;
+    }
+    if (dirtyPages.empty())
+    {
+        dirtyPages.resize((length + dirtyPageSize - 1) / dirtyPageSize, false);
+    }
+    u32 last = std::min((offset + len - 1) / dirtyPageSize, (u32)dirtyPages.size() - 1);
+    for (u32 page = offset / dirtyPageSize; page <= last; page++)
+    {
+        dirtyPages[page] = true;
+    }
+}
+
+void Sav::markDirty(void)
+{
+    allDirty  = true;
+    slotIndex = nullptr;
+}
+
+void Sav::slotChanged(u8 box, u8 slot, u32 len, const PKX& pk)
+{
+    markPages(boxOffset(box, slot), len);
+    if (slotIndex)
+    {
+        slotIndex->set(box * 30 + slot, pk);
+    }
+}
+
+bool Sav::isDirty(u32 offset, u32 len) const
+{
+    if (allDirty)
+    {
+        return true;
+    }
+    if (dirtyPages.empty() || len == 0)
+    {
+        return false;
+    }
+    u32 last = std::min((offset + len - 1) / dirtyPageSize, (u32)dirtyPages.size() - 1);
+    for (u32 page = offset / dirtyPageSize; page <= last; page++)
     {
-        if (pk->generation() > generation())
+        if (dirtyPages[page])
         {
-            pk = pk->previous();
+            return true;
         }
-        else
+    }
+    return false;
+}
+
+void Sav::clearDirty(void)
+{
+    allDirty = false;
+    std::fill(dirtyPages.begin(), dirtyPages.end(), false);
+}
+
+bool Sav::transfer(std::shared_ptr<PKX>& pk)
+{
+    if (pk->generation() != generation())
+    {
+        u8 converted[260];
+        if (!PKX::convert(*this, pk->generation(), pk->rawData(), generation(), converted))
         {
-            pk = pk->next();
+            return false;
         }
+        pk = PKX::getPKM(generation(), converted);
+    }
+    return true;
+}
+
+bool Sav::transfer(Generation gen, const u8* in, u8 box, u8 slot)
+{
+    // A conversion step can fail after writing part of its output, so the slot is only touched once it's done
+    u8 converted[260];
+    if (!PKX::convert(*this, gen, in, generation(), converted))
+    {
+        return false;
     }
+    u8* out = data + boxOffset(box, slot);
+    std::copy(converted, converted + PKX::boxSize(generation()), out);
+    PKXView view(generation(), out);
+    slotChanged(box, slot, PKX::boxSize(generation()), *view);
+    return true;
 }
 
 void Sav::fixParty()
@@ -200,6 +274,41 @@ void Sav::fixParty()
     partyCount(numPkm);
 }
 
+PKXView Sav::slotView(u8 box, u8 slot) const
+{
+    return PKXView(generation(), data + boxOffset(box, slot));
+}
+
+void Sav::forEachSlot(const std::function<void(u8 box, u8 slot, const PKX& pkm)>& visitor) const
+{
+    for (int i = 0; i < maxSlot(); i++)
+    {
+        PKXView view = slotView(i / 30, i % 30);
+        visitor(i / 30, i % 30, *view);
+    }
+}
+
+u32 Sav::filterBox(const CompiledPKFilter& filter, u8 box) const
+{
+    int count = std::min(30, maxSlot() - box * 30);
+    if (count <= 0)
+    {
+        return 0;
+    }
+    return filter.match(generation(), data + boxOffset(box, 0), boxOffset(box, 1) - boxOffset(box, 0), count);
+}
+
+const PKXIndex& Sav::index(void) const
+{
+    if (!slotIndex)
+    {
+        slotIndex = std::make_unique<PKXIndex>();
+        slotIndex->reset(maxSlot());
+        forEachSlot([this](u8 box, u8 slot, const PKX& pkm) { slotIndex->set(box * 30 + slot, pkm); });
+    }
+    return *slotIndex;
+}
+
 u32 Sav::displayTID() const
 {
     switch (generation())
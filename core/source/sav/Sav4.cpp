@@ -79,23 +79,46 @@ void Sav4::SBO(void)
 
 void Sav4::resign(void)
 {
-    u8* tmp = new u8[0x12300];
-    u16 cs;
-    // start, end, chkoffset
-    int general[3] = {
-        0x0, game == Game::DP ? 0xC0EC : game == Game::Pt ? 0xCF18 : 0xF618, game == Game::DP ? 0xC0FE : game == Game::Pt ? 0xCF2A : 0xF626};
-    int storage[3] = {game == Game::DP ? 0xC100 : game == Game::Pt ? 0xCF2C : 0xF700,
-        game == Game::DP ? 0x1E2CC : game == Game::Pt ? 0x1F0FC : 0x21A00, game == Game::DP ? 0x1E2DE : game == Game::Pt ? 0x1F10E : 0x21A0E};
+    std::vector<Block> checked = blocks();
+    for (size_t i = 0; i < checked.size(); i++)
+    {
+        if (isDirty(checked[i].offset, checked[i].length))
+        {
+            *(u16*)(data + checksumOffset(i)) = CRC::ccitt16(data + checked[i].offset, checked[i].length);
+        }
+    }
 
-    std::copy(data + gbo + general[0], data + gbo + general[1], tmp);
-    cs                               = ccitt16(tmp, general[1] - general[0]);
-    *(u16*)(data + gbo + general[2]) = cs;
+    clearDirty();
+}
 
-    std::copy(data + sbo + storage[0], data + sbo + storage[1], tmp);
-    cs                               = ccitt16(tmp, storage[1] - storage[0]);
-    *(u16*)(data + sbo + storage[2]) = cs;
+std::vector<Sav::Block> Sav4::blocks(void) const
+{
+    u32 generalLength               = game == Game::DP ? 0xC0EC : game == Game::Pt ? 0xCF18 : 0xF618;
+    auto [storageStart, storageEnd] = boxStorage();
+    return {{u32(gbo), generalLength}, {storageStart, storageEnd - storageStart}};
+}
 
-    delete[] tmp;
+u32 Sav4::checksumOffset(size_t block) const
+{
+    if (block == 0)
+    {
+        return gbo + (game == Game::DP ? 0xC0FE : game == Game::Pt ? 0xCF2A : 0xF626);
+    }
+    return sbo + (game == Game::DP ? 0x1E2DE : game == Game::Pt ? 0x1F10E : 0x21A0E);
+}
+
+bool Sav4::blockValid(size_t block) const
+{
+    Block checked = blocks()[block];
+    return *(u16*)(data + checksumOffset(block)) == CRC::ccitt16(data + checked.offset, checked.length);
+}
+
+std::pair<u32, u32> Sav4::boxStorage(void) const
+{
+    // The whole storage block, so box names and the current box have to be tracked too
+    u32 start = game == Game::DP ? 0xC100 : game == Game::Pt ? 0xCF2C : 0xF700;
+    u32 end   = game == Game::DP ? 0x1E2CC : game == Game::Pt ? 0x1F0FC : 0x21A00;
+    return {sbo + start, sbo + end};
 }
 
 u16 Sav4::TID(void) const
@@ -105,6 +128,7 @@ u16 Sav4::TID(void) const
 void Sav4::TID(u16 v)
 {
     *(u16*)(data + Trainer1 + 0x10) = v;
+    markDirty(Trainer1 + 0x10, 2);
 }
 
 u16 Sav4::SID(void) const
@@ -114,6 +138,7 @@ u16 Sav4::SID(void) const
 void Sav4::SID(u16 v)
 {
     *(u16*)(data + Trainer1 + 0x12) = v;
+    markDirty(Trainer1 + 0x12, 2);
 }
 
 u8 Sav4::version(void) const
@@ -132,6 +157,7 @@ u8 Sav4::gender(void) const
 void Sav4::gender(u8 v)
 {
     data[Trainer1 + 0x18] = v;
+    markDirty(Trainer1 + 0x18, 1);
 }
 
 u8 Sav4::subRegion(void) const
@@ -168,6 +194,7 @@ u8 Sav4::language(void) const
 void Sav4::language(u8 v)
 {
     data[Trainer1 + 0x19] = v;
+    markDirty(Trainer1 + 0x19, 1);
 }
 
 std::string Sav4::otName(void) const
@@ -177,6 +204,7 @@ std::string Sav4::otName(void) const
 void Sav4::otName(const std::string& v)
 {
     StringUtils::setString4(data, StringUtils::transString45(v), Trainer1, 8);
+    markDirty(Trainer1, 8 * 2);
 }
 
 u32 Sav4::money(void) const
@@ -186,6 +214,7 @@ u32 Sav4::money(void) const
 void Sav4::money(u32 v)
 {
     *(u32*)(data + Trainer1 + 0x14) = v;
+    markDirty(Trainer1 + 0x14, 4);
 }
 
 u32 Sav4::BP(void) const
@@ -195,6 +224,7 @@ u32 Sav4::BP(void) const
 void Sav4::BP(u32 v)
 {
     *(u16*)(data + Trainer1 + 0x20) = v;
+    markDirty(Trainer1 + 0x20, 2);
 }
 
 u8 Sav4::badges(void) const
@@ -223,6 +253,7 @@ u16 Sav4::playedHours(void) const
 void Sav4::playedHours(u16 v)
 {
     *(u16*)(data + Trainer1 + 0x22) = v;
+    markDirty(Trainer1 + 0x22, 2);
 }
 
 u8 Sav4::playedMinutes(void) const
@@ -232,6 +263,7 @@ u8 Sav4::playedMinutes(void) const
 void Sav4::playedMinutes(u8 v)
 {
     data[Trainer1 + 0x24] = v;
+    markDirty(Trainer1 + 0x24, 1);
 }
 
 u8 Sav4::playedSeconds(void) const
@@ -241,6 +273,7 @@ u8 Sav4::playedSeconds(void) const
 void Sav4::playedSeconds(u8 v)
 {
     data[Trainer1 + 0x25] = v;
+    markDirty(Trainer1 + 0x25, 1);
 }
 
 u8 Sav4::currentBox(void) const
@@ -253,6 +286,7 @@ void Sav4::currentBox(u8 v)
 {
     int ofs   = game == Game::HGSS ? boxOffset(maxBoxes(), 0) : Box - 4;
     data[ofs] = v;
+    markDirty(ofs, 1);
 }
 
 u32 Sav4::boxOffset(u8 box, u8 slot) const
@@ -288,6 +322,7 @@ void Sav4::pkm(std::shared_ptr<PKX> pk, u8 slot)
     pk4->encrypt();
     std::fill(data + partyOffset(slot), data + partyOffset(slot + 1), (u8)0);
     std::copy(pk4->rawData(), pk4->rawData() + pk4->getLength(), data + partyOffset(slot));
+    markDirty(partyOffset(slot), 236);
 }
 
 std::shared_ptr<PKX> Sav4::pkm(u8 box, u8 slot, bool ekx) const
@@ -297,13 +332,17 @@ std::shared_ptr<PKX> Sav4::pkm(u8 box, u8 slot, bool ekx) const
 
 void Sav4::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
 {
-    transfer(pk);
+    if (!transfer(pk))
+    {
+        return;
+    }
     if (applyTrade)
     {
         trade(pk);
     }
 
     std::copy(pk->rawData(), pk->rawData() + 136, data + boxOffset(box, slot));
+    slotChanged(box, slot, 136, *pk);
 }
 
 void Sav4::trade(std::shared_ptr<PKX> pk)
@@ -321,13 +360,14 @@ void Sav4::cryptBoxData(bool crypted)
 {
     for (u8 box = 0; box < boxes; box++)
     {
-        for (u8 slot = 0; slot < 30; slot++)
+        if (crypted)
         {
-            std::unique_ptr<PKX> pk4 = std::make_unique<PK4>(data + boxOffset(box, slot), crypted, false, true);
-            if (!crypted)
-            {
-                pk4->encrypt();
-            }
+            PKXCrypt::decryptRange(Generation::FOUR, data + boxOffset(box, 0), 136, 30);
+        }
+        // Re-encrypting gives back the original bytes unless a stored checksum was wrong
+        else if (PKXCrypt::encryptRange(Generation::FOUR, data + boxOffset(box, 0), 136, 30))
+        {
+            markDirty(boxOffset(box, 0), 30 * 136);
         }
     }
 }
@@ -336,13 +376,16 @@ void Sav4::mysteryGift(WCX& wc, int& pos)
 {
     PGT* pgt                                = (PGT*)&wc;
     *(data + WondercardFlags + (2047 >> 3)) = 0x80;
+    markDirty(WondercardFlags + (2047 >> 3), 1);
     std::copy(pgt->rawData(), pgt->rawData() + PGT::length, data + WondercardData + pos * PGT::length);
+    markDirty(WondercardData + pos * PGT::length, PGT::length);
     pos++;
     if (game == Game::DP)
     {
         static constexpr size_t dpSlotActive = 0xEDB88320;
         static const int ofs                 = WondercardFlags + 0x100;
         *(u32*)(data + ofs + 4 * pos)        = dpSlotActive;
+        markDirty(ofs + 4 * pos, 4);
     }
 }
 
@@ -353,7 +396,9 @@ std::string Sav4::boxName(u8 box) const
 
 void Sav4::boxName(u8 box, const std::string& name)
 {
-    StringUtils::setString4(data, StringUtils::transString45(name), boxOffset(18, 0) + box * 0x28 + (game == Game::HGSS ? 0x8 : 0), 9);
+    u32 ofs = boxOffset(18, 0) + box * 0x28 + (game == Game::HGSS ? 0x8 : 0);
+    StringUtils::setString4(data, StringUtils::transString45(name), ofs, 9);
+    markDirty(ofs, 9 * 2);
 }
 
 u8 Sav4::partyCount(void) const
@@ -363,6 +408,7 @@ u8 Sav4::partyCount(void) const
 void Sav4::partyCount(u8 v)
 {
     data[Party - 4] = v;
+    markDirty(Party - 4, 1);
 }
 
 void Sav4::dex(std::shared_ptr<PKX> pk)
@@ -391,22 +437,28 @@ void Sav4::dex(std::shared_ptr<PKX> pk)
 
     // Set the species() Owned Flag
     data[ofs + brSize * 0] |= mask;
+    markDirty(ofs + brSize * 0, 1);
 
     // Check if already Seen
     if ((data[ofs + brSize * 1] & mask) == 0) // Not seen
     {
         data[ofs + brSize * 1] |= mask; // Set seen
+        markDirty(ofs + brSize * 1, 1);
         u8 gr = pk->genderType();
         switch (gr)
         {
             case 255: // Genderless
             case 0:   // Male Only
                 data[ofs + brSize * 2] &= ~mask;
+                markDirty(ofs + brSize * 2, 1);
                 data[ofs + brSize * 3] &= ~mask;
+                markDirty(ofs + brSize * 3, 1);
                 break;
             case 254: // Female Only
                 data[ofs + brSize * 2] |= mask;
+                markDirty(ofs + brSize * 2, 1);
                 data[ofs + brSize * 3] |= mask;
+                markDirty(ofs + brSize * 3, 1);
                 break;
             default: // Male or Female
                 bool m = (data[ofs + brSize * 2] & mask) != 0;
@@ -415,9 +467,12 @@ void Sav4::dex(std::shared_ptr<PKX> pk)
                     break;
                 u8 gender = pk->gender() & 1;
                 data[ofs + brSize * 2] &= ~mask; // unset
+                markDirty(ofs + brSize * 2, 1);
                 data[ofs + brSize * 3] &= ~mask; // unset
+                markDirty(ofs + brSize * 3, 1);
                 gender ^= 1;                     // Set OTHER gender seen bit so it appears second
                 data[ofs + brSize * (2 + gender)] |= mask;
+                markDirty(ofs + brSize * (2 + gender), 1);
                 break;
         }
     }
@@ -437,6 +492,7 @@ void Sav4::dex(std::shared_ptr<PKX> pk)
                     continue; // keep searching
 
                 data[formOffset + 4 + i] = (u8)pk->alternativeForm();
+                markDirty(formOffset + 4 + i, 1);
                 break; // form now set
             }
         }
@@ -485,6 +541,7 @@ void Sav4::dex(std::shared_ptr<PKX> pk)
         lang = 0;                 // no KOR+
     lang = (lang < 0) ? 1 : lang; // default English
     data[languageFlags + (game == Game::DP ? dpl : pk->species())] |= (u8)(1 << lang);
+    markDirty(languageFlags + (game == Game::DP ? dpl : pk->species()), 1);
 }
 
 int Sav4::dexSeen(void) const
@@ -635,7 +692,9 @@ void Sav4::setForms(std::vector<u8> forms, u16 species)
     {
         u32 newval                           = setDexFormValues(forms, 4, 4);
         data[PokeDex + 0x4 + 1 * brSize - 1] = (u8)(newval & 0xFF);
+        markDirty(PokeDex + 0x4 + 1 * brSize - 1, 1);
         data[PokeDex + 0x4 + 2 * brSize - 1] = (u8)((newval >> 8) & 0xFF);
+        markDirty(PokeDex + 0x4 + 2 * brSize - 1, 1);
     }
 
     int formOffset = PokeDex + 4 + 4 * brSize + 4;
@@ -643,15 +702,19 @@ void Sav4::setForms(std::vector<u8> forms, u16 species)
     {
         case 422: // Shellos
             data[formOffset + 0] = (u8)setDexFormValues(forms, 1, 2);
+            markDirty(formOffset + 0, 1);
             return;
         case 423: // Gastrodon
             data[formOffset + 1] = (u8)setDexFormValues(forms, 1, 2);
+            markDirty(formOffset + 1, 1);
             return;
         case 412: // Burmy
             data[formOffset + 2] = (u8)setDexFormValues(forms, 2, 3);
+            markDirty(formOffset + 2, 1);
             return;
         case 413: // Wormadam
             data[formOffset + 3] = (u8)setDexFormValues(forms, 2, 3);
+            markDirty(formOffset + 3, 1);
             return;
         case 201: // Unown
         {
@@ -661,6 +724,7 @@ void Sav4::setForms(std::vector<u8> forms, u16 species)
             for (size_t i = len; i < forms.size(); i++)
                 forms[i] = 0xFF;
             std::copy(forms.begin(), forms.end(), data + ofs);
+            markDirty(ofs, forms.size());
             return;
         }
     }
@@ -679,17 +743,20 @@ void Sav4::setForms(std::vector<u8> forms, u16 species)
             for (int i = formOffset2; i < formOffset2 + 6; i++)
             {
                 data[i] = values[i - formOffset2];
+                markDirty(i, 1);
             }
             return;
         }
         case 492: // Shaymin
         {
             data[formOffset2 + 4] = (u8)setDexFormValues(forms, 1, 2);
+            markDirty(formOffset2 + 4, 1);
             return;
         }
         case 487: // Giratina
         {
             data[formOffset2 + 5] = (u8)setDexFormValues(forms, 1, 2);
+            markDirty(formOffset2 + 5, 1);
             return;
         }
         case 172: // Pichu
@@ -697,6 +764,7 @@ void Sav4::setForms(std::vector<u8> forms, u16 species)
             if (game == Game::HGSS)
             {
                 data[formOffset2 + 6] = (u8)setDexFormValues(forms, 2, 3);
+                markDirty(formOffset2 + 6, 1);
                 return;
             }
         }
@@ -784,27 +852,35 @@ void Sav4::item(Item& item, Pouch pouch, u16 slot)
     {
         case NormalItem:
             std::copy(write.first, write.first + write.second, data + PouchHeldItem + slot * 4);
+            markDirty(PouchHeldItem + slot * 4, write.second);
             break;
         case KeyItem:
             std::copy(write.first, write.first + write.second, data + PouchKeyItem + slot * 4);
+            markDirty(PouchKeyItem + slot * 4, write.second);
             break;
         case TM:
             std::copy(write.first, write.first + write.second, data + PouchTMHM + slot * 4);
+            markDirty(PouchTMHM + slot * 4, write.second);
             break;
         case Mail:
             std::copy(write.first, write.first + write.second, data + MailItems + slot * 4);
+            markDirty(MailItems + slot * 4, write.second);
             break;
         case Medicine:
             std::copy(write.first, write.first + write.second, data + PouchMedicine + slot * 4);
+            markDirty(PouchMedicine + slot * 4, write.second);
             break;
         case Berry:
             std::copy(write.first, write.first + write.second, data + PouchBerry + slot * 4);
+            markDirty(PouchBerry + slot * 4, write.second);
             break;
         case Ball:
             std::copy(write.first, write.first + write.second, data + PouchBalls + slot * 4);
+            markDirty(PouchBalls + slot * 4, write.second);
             break;
         case Battle:
             std::copy(write.first, write.first + write.second, data + BattleItems + slot * 4);
+            markDirty(BattleItems + slot * 4, write.second);
             break;
         default:
             return;
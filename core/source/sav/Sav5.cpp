@@ -33,6 +33,7 @@ u16 Sav5::TID(void) const
 void Sav5::TID(u16 v)
 {
     *(u16*)(data + Trainer1 + 0x14) = v;
+    markDirty(Trainer1 + 0x14, 2);
 }
 
 u16 Sav5::SID(void) const
@@ -42,6 +43,7 @@ u16 Sav5::SID(void) const
 void Sav5::SID(u16 v)
 {
     *(u16*)(data + Trainer1 + 0x16) = v;
+    markDirty(Trainer1 + 0x16, 2);
 }
 
 u8 Sav5::version(void) const
@@ -51,6 +53,7 @@ u8 Sav5::version(void) const
 void Sav5::version(u8 v)
 {
     data[Trainer1 + 0x1F] = v;
+    markDirty(Trainer1 + 0x1F, 1);
 }
 
 u8 Sav5::gender(void) const
@@ -60,6 +63,7 @@ u8 Sav5::gender(void) const
 void Sav5::gender(u8 v)
 {
     data[Trainer1 + 0x21] = v;
+    markDirty(Trainer1 + 0x21, 1);
 }
 
 u8 Sav5::subRegion(void) const
@@ -96,15 +100,17 @@ u8 Sav5::language(void) const
 void Sav5::language(u8 v)
 {
     data[Trainer1 + 0x1E] = v;
+    markDirty(Trainer1 + 0x1E, 1);
 }
 
 std::string Sav5::otName(void) const
 {
-    return StringUtils::transString45(StringUtils::getString(data, Trainer1 + 0x4, 8, u'\uFFFF'));
+    return StringUtils::getString45(data, Trainer1 + 0x4, 8, u'\uFFFF');
 }
 void Sav5::otName(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString45(v), Trainer1 + 0x4, 8, u'\uFFFF', 0);
+    StringUtils::setString45(data, v, Trainer1 + 0x4, 8, u'\uFFFF', 0);
+    markDirty(Trainer1 + 0x4, 8 * 2);
 }
 
 u32 Sav5::money(void) const
@@ -114,6 +120,7 @@ u32 Sav5::money(void) const
 void Sav5::money(u32 v)
 {
     *(u32*)(data + Trainer2) = v;
+    markDirty(Trainer2, 4);
 }
 
 u32 Sav5::BP(void) const
@@ -123,6 +130,7 @@ u32 Sav5::BP(void) const
 void Sav5::BP(u32 v)
 {
     *(u32*)(data + BattleSubway) = v;
+    markDirty(BattleSubway, 4);
 }
 
 u8 Sav5::badges(void) const
@@ -143,6 +151,7 @@ u16 Sav5::playedHours(void) const
 void Sav5::playedHours(u16 v)
 {
     *(u16*)(data + Trainer1 + 0x24) = v;
+    markDirty(Trainer1 + 0x24, 2);
 }
 
 u8 Sav5::playedMinutes(void) const
@@ -152,6 +161,7 @@ u8 Sav5::playedMinutes(void) const
 void Sav5::playedMinutes(u8 v)
 {
     data[Trainer1 + 0x26] = v;
+    markDirty(Trainer1 + 0x26, 1);
 }
 
 u8 Sav5::playedSeconds(void) const
@@ -161,6 +171,7 @@ u8 Sav5::playedSeconds(void) const
 void Sav5::playedSeconds(u8 v)
 {
     data[Trainer1 + 0x27] = v;
+    markDirty(Trainer1 + 0x27, 1);
 }
 
 u8 Sav5::currentBox(void) const
@@ -170,6 +181,7 @@ u8 Sav5::currentBox(void) const
 void Sav5::currentBox(u8 v)
 {
     data[PCLayout] = v;
+    markDirty(PCLayout, 1);
 }
 
 u32 Sav5::boxOffset(u8 box, u8 slot) const
@@ -205,6 +217,7 @@ void Sav5::pkm(std::shared_ptr<PKX> pk, u8 slot)
     pk5->encrypt();
     std::fill(data + partyOffset(slot), data + partyOffset(slot + 1), (u8)0);
     std::copy(pk5->rawData(), pk5->rawData() + pk5->getLength(), data + partyOffset(slot));
+    markDirty(partyOffset(slot), 220);
 }
 
 std::shared_ptr<PKX> Sav5::pkm(u8 box, u8 slot, bool ekx) const
@@ -214,13 +227,17 @@ std::shared_ptr<PKX> Sav5::pkm(u8 box, u8 slot, bool ekx) const
 
 void Sav5::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
 {
-    transfer(pk);
+    if (!transfer(pk))
+    {
+        return;
+    }
     if (applyTrade)
     {
         trade(pk);
     }
 
     std::copy(pk->rawData(), pk->rawData() + 136, data + boxOffset(box, slot));
+    slotChanged(box, slot, 136, *pk);
 }
 
 void Sav5::trade(std::shared_ptr<PKX> pk)
@@ -238,13 +255,14 @@ void Sav5::cryptBoxData(bool crypted)
 {
     for (u8 box = 0; box < boxes; box++)
     {
-        for (u8 slot = 0; slot < 30; slot++)
+        if (crypted)
         {
-            std::unique_ptr<PKX> pk5 = std::make_unique<PK5>(data + boxOffset(box, slot), crypted, false, true);
-            if (!crypted)
-            {
-                pk5->encrypt();
-            }
+            PKXCrypt::decryptRange(Generation::FIVE, data + boxOffset(box, 0), 136, 30);
+        }
+        // Re-encrypting gives back the original bytes unless a stored checksum was wrong
+        else if (PKXCrypt::encryptRange(Generation::FIVE, data + boxOffset(box, 0), 136, 30))
+        {
+            markDirty(boxOffset(box, 0), 30 * 136);
         }
     }
 }
@@ -327,9 +345,11 @@ void Sav5::dex(std::shared_ptr<PKX> pk)
 
     // Set the Species Owned Flag
     data[ofs + brSize * 0] |= (u8)(1 << (bit % 8));
+    markDirty(ofs + brSize * 0, 1);
 
     // Set the [Species/Gender/Shiny] Seen Flag
     data[PokeDex + 0x8 + shiftoff + bit / 8] |= (u8)(1 << (bit & 7));
+    markDirty(PokeDex + 0x8 + shiftoff + bit / 8, 1);
 
     // Set the Display flag if none are set
     bool displayed = false;
@@ -338,7 +358,10 @@ void Sav5::dex(std::shared_ptr<PKX> pk)
     displayed |= (data[ofs + brSize * 7] & (u8)(1 << (bit & 7))) != 0;
     displayed |= (data[ofs + brSize * 8] & (u8)(1 << (bit & 7))) != 0;
     if (!displayed) // offset is already biased by brSize, reuse shiftoff but for the display flags.
+    {
         data[ofs + brSize * (shift + 4)] |= (u8)(1 << (bit & 7));
+        markDirty(ofs + brSize * (shift + 4), 1);
+    }
 
     // Set the Language
     if (bit < 493) // shifted by 1, Gen5 species do not have international language bits
@@ -349,6 +372,7 @@ void Sav5::dex(std::shared_ptr<PKX> pk)
         if (lang < 0)
             lang = 1;
         data[PokeDexLanguageFlags + ((bit * 7 + lang) >> 3)] |= (u8)(1 << ((bit * 7 + lang) & 7));
+        markDirty(PokeDexLanguageFlags + ((bit * 7 + lang) >> 3), 1);
     }
 
     // Formes
@@ -363,6 +387,7 @@ void Sav5::dex(std::shared_ptr<PKX> pk)
 
     // Set Form Seen Flag
     data[formDex + formLen * shiny + (bit >> 3)] |= (u8)(1 << (bit & 7));
+    markDirty(formDex + formLen * shiny + (bit >> 3), 1);
 
     // Set displayed Flag if necessary, check all flags
     for (int i = 0; i < fc; i++)
@@ -375,6 +400,7 @@ void Sav5::dex(std::shared_ptr<PKX> pk)
     }
     bit = f + pk->alternativeForm();
     data[formDex + formLen * (2 + shiny) + (bit >> 3)] |= (u8)(1 << (bit & 7));
+    markDirty(formDex + formLen * (2 + shiny) + (bit >> 3), 1);
 }
 
 int Sav5::dexSeen(void) const
@@ -416,18 +442,21 @@ void Sav5::mysteryGift(WCX& wc, int& pos)
     PGF* pgf = (PGF*)&wc;
 
     *(data + WondercardFlags + pgf->ID()) |= 0x1 << (pgf->ID() & 7);
+    markDirty(WondercardFlags + pgf->ID(), 1);
     std::copy(pgf->rawData(), pgf->rawData() + PGF::length, data + WondercardData + pos * PGF::length);
+    markDirty(WondercardData + pos * PGF::length, PGF::length);
     pos = (pos + 1) % 12;
 }
 
 std::string Sav5::boxName(u8 box) const
 {
-    return StringUtils::transString45(StringUtils::getString(data, PCLayout + 0x28 * box + 4, 9, u'\uFFFF'));
+    return StringUtils::getString45(data, PCLayout + 0x28 * box + 4, 9, u'\uFFFF');
 }
 
 void Sav5::boxName(u8 box, const std::string& name)
 {
-    StringUtils::setString(data, StringUtils::transString45(name), PCLayout + 0x28 * box + 4, 9, u'\uFFFF', 0);
+    StringUtils::setString45(data, name, PCLayout + 0x28 * box + 4, 9, u'\uFFFF', 0);
+    markDirty(PCLayout + 0x28 * box + 4, 9 * 2);
 }
 
 u8 Sav5::partyCount(void) const
@@ -437,6 +466,7 @@ u8 Sav5::partyCount(void) const
 void Sav5::partyCount(u8 v)
 {
     data[Party + 4] = v;
+    markDirty(Party + 4, 1);
 }
 
 std::shared_ptr<PKX> Sav5::emptyPkm() const
@@ -491,12 +521,8 @@ std::vector<MysteryGift::giftData> Sav5::currentGifts(void) const
 
 void Sav5::cryptMysteryGiftData()
 {
-    u32 seed = *(u32*)(data + 0x1D290);
-    for (int i = 0; i < 0xA90; i += 2)
-    {
-        seed = seed * 0x41C64E6D + 0x6073; // Replace with seedStep?
-        *(u16*)(data + WondercardFlags + i) ^= (seed >> 16);
-    }
+    PKXCrypt::xorKeystream(data + WondercardFlags, 0xA90, *(u32*)(data + 0x1D290));
+    markDirty(WondercardFlags, 0xA90);
 }
 
 std::unique_ptr<WCX> Sav5::mysteryGift(int pos) const
@@ -512,18 +538,23 @@ void Sav5::item(Item& item, Pouch pouch, u16 slot)
     {
         case NormalItem:
             std::copy(write.first, write.first + write.second, data + PouchHeldItem + slot * 4);
+            markDirty(PouchHeldItem + slot * 4, write.second);
             break;
         case KeyItem:
             std::copy(write.first, write.first + write.second, data + PouchKeyItem + slot * 4);
+            markDirty(PouchKeyItem + slot * 4, write.second);
             break;
         case TM:
             std::copy(write.first, write.first + write.second, data + PouchTMHM + slot * 4);
+            markDirty(PouchTMHM + slot * 4, write.second);
             break;
         case Medicine:
             std::copy(write.first, write.first + write.second, data + PouchMedicine + slot * 4);
+            markDirty(PouchMedicine + slot * 4, write.second);
             break;
         case Berry:
             std::copy(write.first, write.first + write.second, data + PouchBerry + slot * 4);
+            markDirty(PouchBerry + slot * 4, write.second);
             break;
         default:
             return;
@@ -33,6 +33,7 @@ u16 Sav6::TID(void) const
 void Sav6::TID(u16 v)
 {
     *(u16*)(data + TrainerCard) = v;
+    markDirty(TrainerCard, 2);
 }
 
 u16 Sav6::SID(void) const
@@ -42,6 +43,7 @@ u16 Sav6::SID(void) const
 void Sav6::SID(u16 v)
 {
     *(u16*)(data + TrainerCard + 2) = v;
+    markDirty(TrainerCard + 2, 2);
 }
 
 u8 Sav6::version(void) const
@@ -51,6 +53,7 @@ u8 Sav6::version(void) const
 void Sav6::version(u8 v)
 {
     data[TrainerCard + 4] = v;
+    markDirty(TrainerCard + 4, 1);
 }
 
 u8 Sav6::gender(void) const
@@ -60,6 +63,7 @@ u8 Sav6::gender(void) const
 void Sav6::gender(u8 v)
 {
     data[TrainerCard + 5] = v;
+    markDirty(TrainerCard + 5, 1);
 }
 
 u8 Sav6::subRegion(void) const
@@ -69,6 +73,7 @@ u8 Sav6::subRegion(void) const
 void Sav6::subRegion(u8 v)
 {
     data[TrainerCard + 0x26] = v;
+    markDirty(TrainerCard + 0x26, 1);
 }
 
 u8 Sav6::country(void) const
@@ -78,6 +83,7 @@ u8 Sav6::country(void) const
 void Sav6::country(u8 v)
 {
     data[TrainerCard + 0x27] = v;
+    markDirty(TrainerCard + 0x27, 1);
 }
 
 u8 Sav6::consoleRegion(void) const
@@ -87,6 +93,7 @@ u8 Sav6::consoleRegion(void) const
 void Sav6::consoleRegion(u8 v)
 {
     data[TrainerCard + 0x2C] = v;
+    markDirty(TrainerCard + 0x2C, 1);
 }
 
 u8 Sav6::language(void) const
@@ -96,15 +103,17 @@ u8 Sav6::language(void) const
 void Sav6::language(u8 v)
 {
     data[TrainerCard + 0x2D] = v;
+    markDirty(TrainerCard + 0x2D, 1);
 }
 
 std::string Sav6::otName(void) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, TrainerCard + 0x48, 13));
+    return StringUtils::getString67(data, TrainerCard + 0x48, 13);
 }
 void Sav6::otName(const std::string& v)
 {
-    StringUtils::setString(data, StringUtils::transString67(v), TrainerCard + 0x48, 13);
+    StringUtils::setString67(data, v, TrainerCard + 0x48, 13);
+    markDirty(TrainerCard + 0x48, 13 * 2);
 }
 
 u32 Sav6::money(void) const
@@ -114,6 +123,7 @@ u32 Sav6::money(void) const
 void Sav6::money(u32 v)
 {
     *(u32*)(data + Trainer2 + 0x8) = v;
+    markDirty(Trainer2 + 0x8, 4);
 }
 
 u32 Sav6::BP(void) const
@@ -123,6 +133,7 @@ u32 Sav6::BP(void) const
 void Sav6::BP(u32 v)
 {
     *(u32*)(data + Trainer2 + (game == Game::XY ? 0x3C : 0x30)) = v;
+    markDirty(Trainer2 + (game == Game::XY ? 0x3C : 0x30), 4);
 }
 
 u8 Sav6::badges(void) const
@@ -143,6 +154,7 @@ u16 Sav6::playedHours(void) const
 void Sav6::playedHours(u16 v)
 {
     *(u16*)(data + PlayTime) = v;
+    markDirty(PlayTime, 2);
 }
 
 u8 Sav6::playedMinutes(void) const
@@ -152,6 +164,7 @@ u8 Sav6::playedMinutes(void) const
 void Sav6::playedMinutes(u8 v)
 {
     *(u8*)(data + PlayTime + 2) = v;
+    markDirty(PlayTime + 2, 1);
 }
 
 u8 Sav6::playedSeconds(void) const
@@ -161,6 +174,7 @@ u8 Sav6::playedSeconds(void) const
 void Sav6::playedSeconds(u8 v)
 {
     *(u8*)(data + PlayTime + 3) = v;
+    markDirty(PlayTime + 3, 1);
 }
 
 u8 Sav6::currentBox(void) const
@@ -170,6 +184,7 @@ u8 Sav6::currentBox(void) const
 void Sav6::currentBox(u8 v)
 {
     data[LastViewedBox] = v;
+    markDirty(LastViewedBox, 1);
 }
 
 u32 Sav6::boxOffset(u8 box, u8 slot) const
@@ -206,6 +221,7 @@ void Sav6::pkm(std::shared_ptr<PKX> pk, u8 slot)
     pk6->encrypt();
     std::fill(data + partyOffset(slot), data + partyOffset(slot + 1), (u8)0);
     std::copy(pk6->rawData(), pk6->rawData() + pk6->getLength(), data + partyOffset(slot));
+    markDirty(partyOffset(slot), 260);
 }
 
 std::shared_ptr<PKX> Sav6::pkm(u8 box, u8 slot, bool ekx) const
@@ -215,13 +231,17 @@ std::shared_ptr<PKX> Sav6::pkm(u8 box, u8 slot, bool ekx) const
 
 void Sav6::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
 {
-    transfer(pk);
+    if (!transfer(pk))
+    {
+        return;
+    }
     if (applyTrade)
     {
         trade(pk);
     }
 
     std::copy(pk->rawData(), pk->rawData() + 232, data + boxOffset(box, slot));
+    slotChanged(box, slot, 232, *pk);
 }
 
 void Sav6::trade(std::shared_ptr<PKX> pk)
@@ -309,13 +329,14 @@ void Sav6::cryptBoxData(bool crypted)
 {
     for (u8 box = 0; box < boxes; box++)
     {
-        for (u8 slot = 0; slot < 30; slot++)
+        if (crypted)
         {
-            std::unique_ptr<PKX> pk6 = std::make_unique<PK6>(data + boxOffset(box, slot), crypted, false, true);
-            if (!crypted)
-            {
-                pk6->encrypt();
-            }
+            PKXCrypt::decryptRange(Generation::SIX, data + boxOffset(box, 0), 232, 30);
+        }
+        // Re-encrypting gives back the original bytes unless a stored checksum was wrong
+        else if (PKXCrypt::encryptRange(Generation::SIX, data + boxOffset(box, 0), 232, 30))
+        {
+            markDirty(boxOffset(box, 0), 30 * 232);
         }
     }
 }
@@ -526,12 +547,19 @@ void Sav6::dex(std::shared_ptr<PKX> pk)
 
     // Owned quality flag
     if (origin < 0x18 && bit < 649 && game != Game::ORAS) // Species: 1-649 for X/Y, and not for ORAS; Set the Foreign Owned Flag
+    {
         data[ofs + 0x644] |= mask;
+        markDirty(ofs + 0x644, 1);
+    }
     else if (origin >= 0x18 || game == Game::ORAS) // Set Native Owned Flag (should always happen)
+    {
         data[ofs + (brSize * 0)] |= mask;
+        markDirty(ofs + (brSize * 0), 1);
+    }
 
     // Set the [Species/Gender/Shiny] Seen Flag
     data[ofs + shiftoff] |= mask;
+    markDirty(ofs + shiftoff, 1);
 
     // Set the Display flag if none are set
     bool displayed = false;
@@ -540,16 +568,23 @@ void Sav6::dex(std::shared_ptr<PKX> pk)
     displayed |= (data[ofs + brSize * 7] & mask) != 0;
     displayed |= (data[ofs + brSize * 8] & mask) != 0;
     if (!displayed) // offset is already biased by brSize, reuse shiftoff but for the display flags.
+    {
         data[ofs + brSize * 4 + shiftoff] |= mask;
+        markDirty(ofs + brSize * 4 + shiftoff, 1);
+    }
 
     // Set the Language
     if (lang < 0)
         lang = 1;
     data[PokeDexLanguageFlags + (bit * 7 + lang) / 8] |= (u8)(1 << ((bit * 7 + lang) % 8));
+    markDirty(PokeDexLanguageFlags + (bit * 7 + lang) / 8, 1);
 
     // Set DexNav count (only if not encountered previously)
     if (game == Game::ORAS && *(u16*)(data + EncounterCount + (pk->species() - 1) * 2) == 0)
+    {
         *(u16*)(data + EncounterCount + (pk->species() - 1) * 2) = 1;
+        markDirty(EncounterCount + (pk->species() - 1) * 2, 2);
+    }
 
     // Set Form flags
     int fc = PersonalXYORAS::formCount(pk->species());
@@ -563,6 +598,7 @@ void Sav6::dex(std::shared_ptr<PKX> pk)
 
     // Set Form Seen Flag
     data[formDex + formLen * shiny + bit / 8] |= (u8)(1 << (bit % 8));
+    markDirty(formDex + formLen * shiny + bit / 8, 1);
 
     // Set Displayed Flag if necessary, check all flags
     for (int i = 0; i < fc; i++)
@@ -575,6 +611,7 @@ void Sav6::dex(std::shared_ptr<PKX> pk)
     }
     bit = f + pk->alternativeForm();
     data[formDex + formLen * (2 + shiny) + bit / 8] |= (u8)(1 << (bit % 8));
+    markDirty(formDex + formLen * (2 + shiny) + bit / 8, 1);
 }
 
 int Sav6::dexSeen(void) const
@@ -615,24 +652,29 @@ void Sav6::mysteryGift(WCX& wc, int& pos)
 {
     WC6* wc6 = (WC6*)&wc;
     *(u8*)(data + WondercardFlags + wc6->ID() / 8) |= 0x1 << (wc6->ID() % 8);
+    markDirty(WondercardFlags + wc6->ID() / 8, 1);
     std::copy(wc6->rawData(), wc6->rawData() + 264, data + WondercardData + 264 * pos);
+    markDirty(WondercardData + 264 * pos, 264);
     if (game == Game::ORAS && wc6->ID() == 2048 && wc6->object() == 726)
     {
         static constexpr u32 EON_MAGIC = 0x225D73C2;
         *(u32*)(data + 0x319B8)        = EON_MAGIC;
         *(u32*)(data + 0x319DE)        = EON_MAGIC;
+        markDirty(0x319B8, 4);
+        markDirty(0x319DE, 4);
     }
     pos = (pos + 1) % 24;
 }
 
 std::string Sav6::boxName(u8 box) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, PCLayout + 0x22 * box, 17));
+    return StringUtils::getString67(data, PCLayout + 0x22 * box, 17);
 }
 
 void Sav6::boxName(u8 box, const std::string& name)
 {
-    StringUtils::setString(data, StringUtils::transString67(name), PCLayout + 0x22 * box, 17);
+    StringUtils::setString67(data, name, PCLayout + 0x22 * box, 17);
+    markDirty(PCLayout + 0x22 * box, 17 * 2);
 }
 
 u8 Sav6::partyCount(void) const
@@ -642,6 +684,7 @@ u8 Sav6::partyCount(void) const
 void Sav6::partyCount(u8 v)
 {
     data[Party + 6 * 260] = v;
+    markDirty(Party + 6 * 260, 1);
 }
 
 std::shared_ptr<PKX> Sav6::emptyPkm() const
@@ -707,18 +750,23 @@ void Sav6::item(Item& item, Pouch pouch, u16 slot)
     {
         case NormalItem:
             std::copy(write.first, write.first + write.second, data + PouchHeldItem + slot * 4);
+            markDirty(PouchHeldItem + slot * 4, write.second);
             break;
         case KeyItem:
             std::copy(write.first, write.first + write.second, data + PouchKeyItem + slot * 4);
+            markDirty(PouchKeyItem + slot * 4, write.second);
             break;
         case TM:
             std::copy(write.first, write.first + write.second, data + PouchTMHM + slot * 4);
+            markDirty(PouchTMHM + slot * 4, write.second);
             break;
         case Medicine:
             std::copy(write.first, write.first + write.second, data + PouchMedicine + slot * 4);
+            markDirty(PouchMedicine + slot * 4, write.second);
             break;
         case Berry:
             std::copy(write.first, write.first + write.second, data + PouchBerry + slot * 4);
+            markDirty(PouchBerry + slot * 4, write.second);
             break;
         default:
             return;
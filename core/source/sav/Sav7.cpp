@@ -26,18 +26,20 @@
 
 #include "Sav7.hpp"
 
-u16 Sav7::check16(u8* buf, u32 blockID, u32 len) const
+u16 Sav7::check16(const u8* buf, u32 blockID, u32 len) const
 {
+    u16 chk = ~0;
     if (blockID == 36)
     {
-        u8 tmp[0x80] = {0};
-        std::copy(tmp, tmp + 0x80, buf + 0x100);
+        // The memecrypto signature inside this block is checksummed as if it were zeroed
+        static constexpr u8 zeroes[0x80] = {0};
+        chk                              = CRC::crc16(buf, 0x100, chk);
+        chk                              = CRC::crc16(zeroes, 0x80, chk);
+        chk                              = CRC::crc16(buf + 0x180, len - 0x180, chk);
     }
-
-    u16 chk = ~0;
-    for (u32 i = 0; i < len; i++)
+    else
     {
-        chk = (crc16[(buf[i] ^ chk) & 0xFF] ^ chk >> 8);
+        chk = CRC::crc16(buf, len, chk);
     }
     return ~chk;
 }
@@ -49,6 +51,7 @@ u16 Sav7::TID(void) const
 void Sav7::TID(u16 v)
 {
     *(u16*)(data + TrainerCard) = v;
+    markDirty(TrainerCard, 2);
 }
 
 u16 Sav7::SID(void) const
@@ -58,6 +61,7 @@ u16 Sav7::SID(void) const
 void Sav7::SID(u16 v)
 {
     *(u16*)(data + TrainerCard + 2) = v;
+    markDirty(TrainerCard + 2, 2);
 }
 
 u8 Sav7::version(void) const
@@ -67,6 +71,7 @@ u8 Sav7::version(void) const
 void Sav7::version(u8 v)
 {
     data[TrainerCard + 4] = v;
+    markDirty(TrainerCard + 4, 1);
 }
 
 u8 Sav7::gender(void) const
@@ -76,6 +81,7 @@ u8 Sav7::gender(void) const
 void Sav7::gender(u8 v)
 {
     data[TrainerCard + 5] = v;
+    markDirty(TrainerCard + 5, 1);
 }
 
 u8 Sav7::subRegion(void) const
@@ -85,6 +91,7 @@ u8 Sav7::subRegion(void) const
 void Sav7::subRegion(u8 v)
 {
     data[TrainerCard + 0x2E] = v;
+    markDirty(TrainerCard + 0x2E, 1);
 }
 
 u8 Sav7::country(void) const
@@ -94,6 +101,7 @@ u8 Sav7::country(void) const
 void Sav7::country(u8 v)
 {
     data[TrainerCard + 0x2F] = v;
+    markDirty(TrainerCard + 0x2F, 1);
 }
 
 u8 Sav7::consoleRegion(void) const
@@ -103,6 +111,7 @@ u8 Sav7::consoleRegion(void) const
 void Sav7::consoleRegion(u8 v)
 {
     data[TrainerCard + 0x34] = v;
+    markDirty(TrainerCard + 0x34, 1);
 }
 
 u8 Sav7::language(void) const
@@ -112,15 +121,17 @@ u8 Sav7::language(void) const
 void Sav7::language(u8 v)
 {
     data[TrainerCard + 0x35] = v;
+    markDirty(TrainerCard + 0x35, 1);
 }
 
 std::string Sav7::otName(void) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, TrainerCard + 0x38, 13));
+    return StringUtils::getString67(data, TrainerCard + 0x38, 13);
 }
 void Sav7::otName(const std::string& v)
 {
-    return StringUtils::setString(data, StringUtils::transString67(v), TrainerCard + 0x38, 13);
+    StringUtils::setString67(data, v, TrainerCard + 0x38, 13);
+    markDirty(TrainerCard + 0x38, 13 * 2);
 }
 
 u32 Sav7::money(void) const
@@ -130,6 +141,7 @@ u32 Sav7::money(void) const
 void Sav7::money(u32 v)
 {
     *(u32*)(data + Misc + 0x4) = v > 9999999 ? 9999999 : v;
+    markDirty(Misc + 0x4, 4);
 }
 
 u32 Sav7::BP(void) const
@@ -139,6 +151,7 @@ u32 Sav7::BP(void) const
 void Sav7::BP(u32 v)
 {
     *(u32*)(data + Misc + 0x11C) = v > 9999 ? 9999 : v;
+    markDirty(Misc + 0x11C, 4);
 }
 
 u8 Sav7::badges(void) const
@@ -159,6 +172,7 @@ u16 Sav7::playedHours(void) const
 void Sav7::playedHours(u16 v)
 {
     *(u16*)(data + PlayTime) = v;
+    markDirty(PlayTime, 2);
 }
 
 u8 Sav7::playedMinutes(void) const
@@ -168,6 +182,7 @@ u8 Sav7::playedMinutes(void) const
 void Sav7::playedMinutes(u8 v)
 {
     data[PlayTime + 2] = v;
+    markDirty(PlayTime + 2, 1);
 }
 
 u8 Sav7::playedSeconds(void) const
@@ -177,6 +192,7 @@ u8 Sav7::playedSeconds(void) const
 void Sav7::playedSeconds(u8 v)
 {
     data[PlayTime + 3] = v;
+    markDirty(PlayTime + 3, 1);
 }
 
 u8 Sav7::currentBox(void) const
@@ -186,6 +202,7 @@ u8 Sav7::currentBox(void) const
 void Sav7::currentBox(u8 v)
 {
     data[LastViewedBox] = v;
+    markDirty(LastViewedBox, 1);
 }
 
 u32 Sav7::boxOffset(u8 box, u8 slot) const
@@ -222,6 +239,7 @@ void Sav7::pkm(std::shared_ptr<PKX> pk, u8 slot)
     pk7->encrypt();
     std::fill(data + partyOffset(slot), data + partyOffset(slot + 1), (u8)0);
     std::copy(pk7->rawData(), pk7->rawData() + pk7->getLength(), data + partyOffset(slot));
+    markDirty(partyOffset(slot), 260);
 }
 
 std::shared_ptr<PKX> Sav7::pkm(u8 box, u8 slot, bool ekx) const
@@ -231,13 +249,17 @@ std::shared_ptr<PKX> Sav7::pkm(u8 box, u8 slot, bool ekx) const
 
 void Sav7::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
 {
-    transfer(pk);
+    if (!transfer(pk))
+    {
+        return;
+    }
     if (applyTrade)
     {
         trade(pk);
     }
 
     std::copy(pk->rawData(), pk->rawData() + 232, data + boxOffset(box, slot));
+    slotChanged(box, slot, 232, *pk);
 }
 
 void Sav7::trade(std::shared_ptr<PKX> pk)
@@ -275,13 +297,14 @@ void Sav7::cryptBoxData(bool crypted)
 {
     for (u8 box = 0; box < boxes; box++)
     {
-        for (u8 slot = 0; slot < 30; slot++)
+        if (crypted)
         {
-            std::unique_ptr<PKX> pk7 = std::make_unique<PK7>(data + boxOffset(box, slot), crypted, false, true);
-            if (!crypted)
-            {
-                pk7->encrypt();
-            }
+            PKXCrypt::decryptRange(Generation::SEVEN, data + boxOffset(box, 0), 232, 30);
+        }
+        // Re-encrypting gives back the original bytes unless a stored checksum was wrong
+        else if (PKXCrypt::encryptRange(Generation::SEVEN, data + boxOffset(box, 0), 232, 30))
+        {
+            markDirty(boxOffset(box, 0), 30 * 232);
         }
     }
 }
@@ -298,6 +321,7 @@ void Sav7::setDexFlags(int index, int gender, int shiny, int baseSpecies)
 
     int brSeen = shift * brSize;
     data[ofs + brSeen + bd] |= (u8)(1 << bm);
+    markDirty(ofs + brSeen + bd, 1);
 
     bool displayed = false;
     for (u8 i = 0; i < 4; i++)
@@ -318,6 +342,7 @@ void Sav7::setDexFlags(int index, int gender, int shiny, int baseSpecies)
         return;
 
     data[ofs + (4 + shift) * brSize + bd] |= (u8)(1 << bm);
+    markDirty(ofs + (4 + shift) * brSize + bd, 1);
 }
 
 bool Sav7::sanitizeFormsToIterate(int species, int& fs, int& fe, int formIn) const
@@ -399,16 +424,20 @@ void Sav7::dex(std::shared_ptr<PKX> pk)
         if ((data[PokeDex + 0x84] & (1 << (shift + 4))) != 0)
         { // Already 2
             *(u32*)(data + PokeDex + 0x8E8 + shift * 4) = pk->encryptionConstant();
+            markDirty(PokeDex + 0x8E8 + shift * 4, 4);
             data[PokeDex + 0x84] |= (u8)(1 << shift);
+            markDirty(PokeDex + 0x84, 1);
         }
         else if ((data[PokeDex + 0x84] & (1 << shift)) == 0)
         {                                             // Not yet 1
             data[PokeDex + 0x84] |= (u8)(1 << shift); // 1
+            markDirty(PokeDex + 0x84, 1);
         }
     }
 
     int off = PokeDex + 0x08 + 0x80;
     data[off + bd] |= (u8)(1 << bm);
+    markDirty(off + bd, 1);
 
     int formstart = pk->alternativeForm();
     int formend   = formstart;
@@ -447,7 +476,10 @@ void Sav7::dex(std::shared_ptr<PKX> pk)
             lang = 1;
         int lbit = bit * langCount + lang;
         if (lbit >> 3 < 920)
+        {
             data[PokeDexLanguageFlags + (lbit >> 3)] |= (u8)(1 << (lbit & 7));
+            markDirty(PokeDexLanguageFlags + (lbit >> 3), 1);
+        }
     }
 }
 
@@ -489,18 +521,21 @@ void Sav7::mysteryGift(WCX& wc, int& pos)
 {
     WC7* wc7 = (WC7*)&wc;
     *(u8*)(data + WondercardFlags + wc7->ID() / 8) |= 0x1 << (wc7->ID() % 8);
+    markDirty(WondercardFlags + wc7->ID() / 8, 1);
     std::copy(wc7->rawData(), wc7->rawData() + 264, data + WondercardData + 264 * pos);
+    markDirty(WondercardData + 264 * pos, 264);
     pos = (pos + 1) % 48;
 }
 
 std::string Sav7::boxName(u8 box) const
 {
-    return StringUtils::transString67(StringUtils::getString(data, PCLayout + 0x22 * box, 17));
+    return StringUtils::getString67(data, PCLayout + 0x22 * box, 17);
 }
 
 void Sav7::boxName(u8 box, const std::string& name)
 {
-    StringUtils::setString(data, StringUtils::transString67(name), PCLayout + 0x22 * box, 17);
+    StringUtils::setString67(data, name, PCLayout + 0x22 * box, 17);
+    markDirty(PCLayout + 0x22 * box, 17 * 2);
 }
 
 u8 Sav7::partyCount(void) const
@@ -510,6 +545,7 @@ u8 Sav7::partyCount(void) const
 void Sav7::partyCount(u8 v)
 {
     data[Party + 6 * 260] = v;
+    markDirty(Party + 6 * 260, 1);
 }
 
 std::shared_ptr<PKX> Sav7::emptyPkm() const
@@ -575,24 +611,31 @@ void Sav7::item(Item& item, Pouch pouch, u16 slot)
     {
         case NormalItem:
             std::copy(write.first, write.first + write.second, data + PouchHeldItem + slot * 4);
+            markDirty(PouchHeldItem + slot * 4, write.second);
             break;
         case KeyItem:
             std::copy(write.first, write.first + write.second, data + PouchKeyItem + slot * 4);
+            markDirty(PouchKeyItem + slot * 4, write.second);
             break;
         case TM:
             std::copy(write.first, write.first + write.second, data + PouchTMHM + slot * 4);
+            markDirty(PouchTMHM + slot * 4, write.second);
             break;
         case Medicine:
             std::copy(write.first, write.first + write.second, data + PouchMedicine + slot * 4);
+            markDirty(PouchMedicine + slot * 4, write.second);
             break;
         case Berry:
             std::copy(write.first, write.first + write.second, data + PouchBerry + slot * 4);
+            markDirty(PouchBerry + slot * 4, write.second);
             break;
         case ZCrystals:
             std::copy(write.first, write.first + write.second, data + PouchZCrystals + slot * 4);
+            markDirty(PouchZCrystals + slot * 4, write.second);
             break;
         case Battle:
             std::copy(write.first, write.first + write.second, data + BattleItems + slot * 4);
+            markDirty(BattleItems + slot * 4, write.second);
             break;
         default:
             return;
@@ -26,14 +26,13 @@
 
 #include "SavB2W2.hpp"
 
-SavB2W2::SavB2W2(u8* dt)
+SavB2W2::SavB2W2(std::unique_ptr<u8[]> dt)
 {
     length = 0x80000;
     boxes  = 24;
     game   = Game::B2W2;
 
-    data = new u8[length];
-    std::copy(dt, dt + length, data);
+    data = dt.release();
 
     PCLayout             = 0x0;
     Trainer1             = 0x19400;
@@ -56,19 +55,38 @@ SavB2W2::~SavB2W2() {}
 
 void SavB2W2::resign(void)
 {
-    const u8 blockCount = 74;
-    u8* tmp             = new u8[*std::max_element(lengths, lengths + blockCount)];
     u16 cs;
 
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + blockOfs[i], data + blockOfs[i] + lengths[i], tmp);
-        cs                           = ccitt16(tmp, lengths[i]);
+        if (!isDirty(blockOfs[i], lengths[i]))
+        {
+            continue;
+        }
+        cs                           = CRC::ccitt16(data + blockOfs[i], lengths[i]);
         *(u16*)(data + chkMirror[i]) = cs;
         *(u16*)(data + chkofs[i])    = cs;
+        // The mirror is the last block, which then needs its checksum redone as well
+        markDirty(chkMirror[i], 2);
     }
 
-    delete[] tmp;
+    clearDirty();
+}
+
+std::vector<Sav::Block> SavB2W2::blocks(void) const
+{
+    std::vector<Block> ret;
+    for (u8 i = 0; i < blockCount; i++)
+    {
+        ret.push_back({blockOfs[i], lengths[i]});
+    }
+    return ret;
+}
+
+bool SavB2W2::blockValid(size_t block) const
+{
+    u16 cs = CRC::ccitt16(data + blockOfs[block], lengths[block]);
+    return *(u16*)(data + chkofs[block]) == cs && *(u16*)(data + chkMirror[block]) == cs;
 }
 
 std::map<Pouch, std::vector<int>> SavB2W2::validItems() const
@@ -27,18 +27,26 @@
 #include "SavLGPE.hpp"
 #include "PB7.hpp"
 #include "WB7.hpp"
-#include "gui.hpp"
 #include "random.hpp"
 
-SavLGPE::SavLGPE(u8* dt)
+SavLGPE::SavLGPE(std::unique_ptr<u8[]> dt, size_t size)
 {
     length  = 0x100000;
     boxes   = 34; // Ish
     game    = Game::LGPE;
     PokeDex = 0x2A00;
 
-    data = new u8[length]{0};
-    std::copy(dt, dt + 0xB8800, data);
+    // Only the first 0xB8800 bytes are meaningful; anything past that is zeroed
+    if (size == length)
+    {
+        data = dt.release();
+        std::fill(data + 0xB8800, data + length, 0);
+    }
+    else
+    {
+        data = new u8[length]{0};
+        std::copy(dt.get(), dt.get() + 0xB8800, data);
+    }
 }
 
 SavLGPE::~SavLGPE() {}
@@ -56,6 +64,7 @@ u16 SavLGPE::partyBoxSlot(u8 slot) const
 void SavLGPE::partyBoxSlot(u8 slot, u16 v)
 {
     *(u16*)(data + 0x5A00 + slot * 2) = v;
+    markDirty(0x5A00 + slot * 2, 2);
 }
 
 u32 SavLGPE::partyOffset(u8 slot) const
@@ -76,6 +85,7 @@ u16 SavLGPE::boxedPkm() const
 void SavLGPE::boxedPkm(u16 v)
 {
     *(u16*)(data + 0x5A00 + 14) = v;
+    markDirty(0x5A00 + 14, 2);
 }
 
 u16 SavLGPE::followPkm() const
@@ -86,6 +96,7 @@ u16 SavLGPE::followPkm() const
 void SavLGPE::followPkm(u16 v)
 {
     *(u16*)(data + 0x5A00 + 12) = v;
+    markDirty(0x5A00 + 12, 2);
 }
 
 u8 SavLGPE::partyCount() const
@@ -148,6 +159,8 @@ void SavLGPE::compressBox()
                 std::copy(data + emptyOffset, data + emptyOffset + 260, emptyData);
                 std::copy(data + offset, data + offset + 260, data + emptyOffset);
                 std::copy(emptyData, emptyData + 260, data + offset);
+                markDirty(emptyOffset, 260);
+                markDirty(offset, 260);
                 for (int j = 0; j < partyCount(); j++)
                 {
                     if (partyBoxSlot(j) == i)
@@ -165,29 +178,38 @@ void SavLGPE::compressBox()
     }
 }
 
-u16 SavLGPE::check16(u8* buf, u32 blockID, u32 len) const
+u16 SavLGPE::check16(const u8* buf, u32 blockID, u32 len) const
 {
-    u16 chk = 0;
-    for (u32 i = 0; i < len; i++)
-    {
-        chk = (crc16[(buf[i] ^ chk) & 0xFF] ^ chk >> 8);
-    }
-    return chk;
+    (void)blockID;
+    return CRC::crc16(buf, len, 0);
 }
 
 void SavLGPE::resign()
 {
-    const u8 blockCount = 21;
-    u8* tmp             = new u8[*std::max_element(chklen, chklen + blockCount)];
-    const u32 csoff     = 0xB861A;
+    for (u8 i = 0; i < blockCount; i++)
+    {
+        if (isDirty(chkofs[i], chklen[i]))
+        {
+            *(u16*)(data + csoff + i * 8) = check16(data + chkofs[i], *(u16*)(data + csoff + i * 8 - 2), chklen[i]);
+        }
+    }
 
+    clearDirty();
+}
+
+std::vector<Sav::Block> SavLGPE::blocks(void) const
+{
+    std::vector<Block> ret;
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + chkofs[i], data + chkofs[i] + chklen[i], tmp);
-        *(u16*)(data + csoff + i * 8) = check16(tmp, *(u16*)(data + csoff + i * 8 - 2), chklen[i]);
+        ret.push_back({chkofs[i], chklen[i]});
     }
+    return ret;
+}
 
-    delete[] tmp;
+bool SavLGPE::blockValid(size_t block) const
+{
+    return *(u16*)(data + csoff + block * 8) == check16(data + chkofs[block], *(u16*)(data + csoff + block * 8 - 2), chklen[block]);
 }
 
 u16 SavLGPE::TID() const
@@ -198,6 +220,7 @@ u16 SavLGPE::TID() const
 void SavLGPE::TID(u16 v)
 {
     *(u16*)(data + 0x1000) = v;
+    markDirty(0x1000, 2);
 }
 
 u16 SavLGPE::SID() const
@@ -208,6 +231,7 @@ u16 SavLGPE::SID() const
 void SavLGPE::SID(u16 v)
 {
     *(u16*)(data + 0x1002) = v;
+    markDirty(0x1002, 2);
 }
 
 u8 SavLGPE::version() const
@@ -218,6 +242,7 @@ u8 SavLGPE::version() const
 void SavLGPE::version(u8 v)
 {
     *(data + 0x1004) = v;
+    markDirty(0x1004, 1);
 }
 
 u8 SavLGPE::gender() const
@@ -228,6 +253,7 @@ u8 SavLGPE::gender() const
 void SavLGPE::gender(u8 v)
 {
     *(data + 0x1005) = v;
+    markDirty(0x1005, 1);
 }
 
 u8 SavLGPE::language() const
@@ -238,6 +264,7 @@ u8 SavLGPE::language() const
 void SavLGPE::language(u8 v)
 {
     *(data + 0x1035) = v;
+    markDirty(0x1035, 1);
 }
 
 std::string SavLGPE::otName() const
@@ -248,6 +275,7 @@ std::string SavLGPE::otName() const
 void SavLGPE::otName(const std::string& v)
 {
     StringUtils::setString(data, v, 0x1000 + 0x38, 13);
+    markDirty(0x1000 + 0x38, 13 * 2);
 }
 
 u32 SavLGPE::money() const
@@ -258,6 +286,7 @@ u32 SavLGPE::money() const
 void SavLGPE::money(u32 v)
 {
     *(u32*)(data + 0x4C04) = v;
+    markDirty(0x4C04, 4);
 }
 
 u8 SavLGPE::badges() const
@@ -287,6 +316,7 @@ u16 SavLGPE::playedHours(void) const
 void SavLGPE::playedHours(u16 v)
 {
     *(u16*)(data + 0x45400) = v;
+    markDirty(0x45400, 2);
 }
 
 u8 SavLGPE::playedMinutes(void) const
@@ -297,6 +327,7 @@ u8 SavLGPE::playedMinutes(void) const
 void SavLGPE::playedMinutes(u8 v)
 {
     *(data + 0x45402) = v;
+    markDirty(0x45402, 1);
 }
 
 u8 SavLGPE::playedSeconds(void) const
@@ -307,6 +338,7 @@ u8 SavLGPE::playedSeconds(void) const
 void SavLGPE::playedSeconds(u8 v)
 {
     *(data + 0x45403) = v;
+    markDirty(0x45403, 1);
 }
 
 std::shared_ptr<PKX> SavLGPE::pkm(u8 slot) const
@@ -334,6 +366,7 @@ void SavLGPE::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
         trade(pk);
     }
     std::copy(pk->rawData(), pk->rawData() + pk->getLength(), data + boxOffset(box, slot));
+    slotChanged(box, slot, 260, *pk);
 }
 
 void SavLGPE::pkm(std::shared_ptr<PKX> pk, u8 slot)
@@ -345,6 +378,7 @@ void SavLGPE::pkm(std::shared_ptr<PKX> pk, u8 slot)
         if (off != 0)
         {
             std::fill_n(data + off, 260, 0);
+            slotChanged(newSlot / 30, newSlot % 30, 260, *pk);
         }
         partyBoxSlot(slot, 1001);
         return;
@@ -368,6 +402,7 @@ void SavLGPE::pkm(std::shared_ptr<PKX> pk, u8 slot)
     }
 
     std::copy(pk->rawData(), pk->rawData() + pk->getLength(), data + off);
+    slotChanged(newSlot / 30, newSlot % 30, 260, *pk);
     partyBoxSlot(slot, newSlot);
 }
 
@@ -473,6 +508,7 @@ void SavLGPE::setDexFlags(int index, int gender, int shiny, int baseSpecies)
 
     int brSeen = shift * brSize;
     data[off + brSeen + bd] |= (u8)(1 << bm);
+    markDirty(off + brSeen + bd, 1);
 
     bool displayed = false;
     for (u8 i = 0; i < 4; i++)
@@ -493,6 +529,7 @@ void SavLGPE::setDexFlags(int index, int gender, int shiny, int baseSpecies)
         return;
 
     data[off + (4 + shift) * brSize + bd] |= (u8)(1 << bm);
+    markDirty(off + (4 + shift) * brSize + bd, 1);
 }
 
 void SavLGPE::dex(std::shared_ptr<PKX> pk)
@@ -519,16 +556,20 @@ void SavLGPE::dex(std::shared_ptr<PKX> pk)
         if ((data[PokeDex + 0x84] & (1 << (shift + 4))) != 0)
         { // Already 2
             *(u32*)(data + PokeDex + 0x8E8 + shift * 4) = pk->encryptionConstant();
+            markDirty(PokeDex + 0x8E8 + shift * 4, 4);
             data[PokeDex + 0x84] |= (u8)(1 << shift);
+            markDirty(PokeDex + 0x84, 1);
         }
         else if ((data[PokeDex + 0x84] & (1 << shift)) == 0)
         {                                             // Not yet 1
             data[PokeDex + 0x84] |= (u8)(1 << shift); // 1
+            markDirty(PokeDex + 0x84, 1);
         }
     }
 
     int off = PokeDex + 0x08 + 0x80;
     data[off + bd] |= (u8)(1 << bm);
+    markDirty(off + bd, 1);
 
     int formstart = pk->alternativeForm();
     int formend   = formstart;
@@ -567,7 +608,10 @@ void SavLGPE::dex(std::shared_ptr<PKX> pk)
             lang = 1;
         int lbit = bit * langCount + lang;
         if (lbit >> 3 < 920)
+        {
             data[PokeDexLanguageFlags + (lbit >> 3)] |= (u8)(1 << (lbit & 7));
+            markDirty(PokeDexLanguageFlags + (lbit >> 3), 1);
+        }
     }
 }
 
@@ -604,25 +648,21 @@ int SavLGPE::dexCaught(void) const
 
 void SavLGPE::cryptBoxData(bool crypted)
 {
-    for (u8 box = 0; box < maxBoxes(); box++)
+    if (crypted)
     {
-        for (u8 slot = 0; slot < 30; slot++)
-        {
-            if (box * 30 + slot > 1000)
-            {
-                return;
-            }
-            std::unique_ptr<PKX> pb7 = std::make_unique<PB7>(data + boxOffset(box, slot), crypted, true);
-            if (!crypted)
-            {
-                pb7->encrypt();
-            }
-        }
+        PKXCrypt::decryptRange(Generation::LGPE, data + boxOffset(0, 0), 260, maxSlot());
+    }
+    // Re-encrypting gives back the original bytes unless a stored checksum was wrong
+    else if (PKXCrypt::encryptRange(Generation::LGPE, data + boxOffset(0, 0), 260, maxSlot()))
+    {
+        markDirty(boxOffset(0, 0), 260 * maxSlot());
     }
 }
 
 void SavLGPE::mysteryGift(WCX& wc, int& pos)
 {
+    // Gifts go straight into the boxes or the bag; there are no card slots to put them in
+    (void)pos;
     WB7* wb7 = (WB7*)&wc;
     if (wb7->pokemon())
     {
@@ -983,6 +1023,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 60)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + slot * 4);
+                markDirty(slot * 4, writeData.second);
             }
             else
             {
@@ -993,6 +1034,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 108)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0xF0 + slot * 4);
+                markDirty(0xF0 + slot * 4, writeData.second);
             }
             else
             {
@@ -1003,6 +1045,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 200)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0x2A0 + slot * 4);
+                markDirty(0x2A0 + slot * 4, writeData.second);
             }
             else
             {
@@ -1013,6 +1056,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 150)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0x5C0 + slot * 4);
+                markDirty(0x5C0 + slot * 4, writeData.second);
             }
             else
             {
@@ -1023,6 +1067,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 50)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0x818 + slot * 4);
+                markDirty(0x818 + slot * 4, writeData.second);
             }
             else
             {
@@ -1033,6 +1078,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 150)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0x8E0 + slot * 4);
+                markDirty(0x8E0 + slot * 4, writeData.second);
             }
             else
             {
@@ -1044,6 +1090,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 150)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0xB38 + slot * 4);
+                markDirty(0xB38 + slot * 4, writeData.second);
             }
             else
             {
@@ -1082,6 +1129,7 @@ std::unique_ptr<Item> SavLGPE::item(Pouch pouch, u16 slot) const
 
 std::unique_ptr<WCX> SavLGPE::mysteryGift(int pos) const
 {
+    (void)pos;
     return nullptr;
 }
 
@@ -26,14 +26,13 @@
 
 #include "SavORAS.hpp"
 
-SavORAS::SavORAS(u8* dt)
+SavORAS::SavORAS(std::unique_ptr<u8[]> dt)
 {
     length = 0x76000;
     boxes  = 31;
     game   = Game::ORAS;
 
-    data = new u8[length];
-    std::copy(dt, dt + length, data);
+    data = dt.release();
 
     TrainerCard          = 0x14000;
     Trainer2             = 0x04200;
@@ -56,17 +55,30 @@ SavORAS::SavORAS(u8* dt)
 
 void SavORAS::resign(void)
 {
-    const u8 blockCount = 58;
-    u8* tmp             = new u8[*std::max_element(chklen, chklen + blockCount)];
-    const u32 csoff     = 0x75E1A;
+    for (u8 i = 0; i < blockCount; i++)
+    {
+        if (isDirty(chkofs[i], chklen[i]))
+        {
+            *(u16*)(data + csoff + i * 8) = CRC::ccitt16(data + chkofs[i], chklen[i]);
+        }
+    }
+
+    clearDirty();
+}
 
+std::vector<Sav::Block> SavORAS::blocks(void) const
+{
+    std::vector<Block> ret;
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + chkofs[i], data + chkofs[i] + chklen[i], tmp);
-        *(u16*)(data + csoff + i * 8) = ccitt16(tmp, chklen[i]);
+        ret.push_back({chkofs[i], chklen[i]});
     }
+    return ret;
+}
 
-    delete[] tmp;
+bool SavORAS::blockValid(size_t block) const
+{
+    return *(u16*)(data + csoff + block * 8) == CRC::ccitt16(data + chkofs[block], chklen[block]);
 }
 
 std::map<Pouch, std::vector<int>> SavORAS::validItems() const
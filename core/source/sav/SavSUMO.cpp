@@ -26,14 +26,13 @@
 
 #include "SavSUMO.hpp"
 
-SavSUMO::SavSUMO(u8* dt)
+SavSUMO::SavSUMO(std::unique_ptr<u8[]> dt)
 {
     length = 0x6BE00;
     boxes  = 32;
     game   = Game::SM;
 
-    data = new u8[length];
-    std::copy(dt, dt + length, data);
+    data = dt.release();
 
     TrainerCard          = 0x1200;
     Misc                 = 0x4000;
@@ -56,28 +55,33 @@ SavSUMO::SavSUMO(u8* dt)
 
 void SavSUMO::resign(void)
 {
-    const u8 blockCount = 37;
-    u8* tmp             = new u8[*std::max_element(chklen, chklen + blockCount)];
-    const u32 csoff     = 0x6BC1A;
+    const u32 checksumTableOffset = 0x6BC00;
+    const u32 checksumTableLength = 0x140;
+    const u32 memecryptoOffset    = 0x6BB00;
+
+    // The signature only covers the checksum table, so it can stay as is when no checksum moved
+    const bool fullResign = everythingDirty();
+    u8 checksumTable[checksumTableLength];
+    std::copy(data + checksumTableOffset, data + checksumTableOffset + checksumTableLength, checksumTable);
 
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + chkofs[i], data + chkofs[i] + chklen[i], tmp);
-        *(u16*)(data + csoff + i * 8) = check16(tmp, *(u16*)(data + csoff + i * 8 - 2), chklen[i]);
+        if (isDirty(chkofs[i], chklen[i]))
+        {
+            *(u16*)(data + csoff + i * 8) = check16(data + chkofs[i], *(u16*)(data + csoff + i * 8 - 2), chklen[i]);
+        }
     }
 
-    delete[] tmp;
-
-    const u32 checksumTableOffset = 0x6BC00;
-    const u32 checksumTableLength = 0x140;
-    const u32 memecryptoOffset    = 0x6BB00;
+    clearDirty();
+    if (!fullResign && std::equal(checksumTable, checksumTable + checksumTableLength, data + checksumTableOffset))
+    {
+        return;
+    }
+    std::copy(data + checksumTableOffset, data + checksumTableOffset + checksumTableLength, checksumTable);
 
     u8 currentSignature[0x80];
     std::copy(data + memecryptoOffset, data + memecryptoOffset + 0x80, currentSignature);
 
-    u8 checksumTable[checksumTableLength];
-    std::copy(data + checksumTableOffset, data + checksumTableOffset + checksumTableLength, checksumTable);
-
     u8 hash[SHA256_BLOCK_SIZE];
     sha256(hash, checksumTable, checksumTableLength);
 
@@ -89,6 +93,21 @@ void SavSUMO::resign(void)
     std::copy(currentSignature, currentSignature + 0x80, data + memecryptoOffset);
 }
 
+std::vector<Sav::Block> SavSUMO::blocks(void) const
+{
+    std::vector<Block> ret;
+    for (u8 i = 0; i < blockCount; i++)
+    {
+        ret.push_back({chkofs[i], chklen[i]});
+    }
+    return ret;
+}
+
+bool SavSUMO::blockValid(size_t block) const
+{
+    return *(u16*)(data + csoff + block * 8) == check16(data + chkofs[block], *(u16*)(data + csoff + block * 8 - 2), chklen[block]);
+}
+
 int SavSUMO::dexFormIndex(int species, int formct, int start) const
 {
     int formindex = start;
@@ -26,14 +26,13 @@
 
 #include "SavXY.hpp"
 
-SavXY::SavXY(u8* dt)
+SavXY::SavXY(std::unique_ptr<u8[]> dt)
 {
     length = 0x65600;
     boxes  = 31;
     game   = Game::XY;
 
-    data = new u8[length];
-    std::copy(dt, dt + length, data);
+    data = dt.release();
 
     TrainerCard          = 0x14000;
     Trainer2             = 0x4200;
@@ -56,17 +55,30 @@ SavXY::SavXY(u8* dt)
 
 void SavXY::resign(void)
 {
-    static constexpr u8 blockCount = 55;
-    u8* tmp                        = new u8[*std::max_element(chklen, chklen + blockCount)];
-    static constexpr u32 csoff     = 0x6541A;
+    for (u8 i = 0; i < blockCount; i++)
+    {
+        if (isDirty(chkofs[i], chklen[i]))
+        {
+            *(u16*)(data + csoff + i * 8) = CRC::ccitt16(data + chkofs[i], chklen[i]);
+        }
+    }
+
+    clearDirty();
+}
 
+std::vector<Sav::Block> SavXY::blocks(void) const
+{
+    std::vector<Block> ret;
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + chkofs[i], data + chkofs[i] + chklen[i], tmp);
-        *(u16*)(data + csoff + i * 8) = ccitt16(tmp, chklen[i]);
+        ret.push_back({chkofs[i], chklen[i]});
     }
+    return ret;
+}
 
-    delete[] tmp;
+bool SavXY::blockValid(size_t block) const
+{
+    return *(u16*)(data + csoff + block * 8) == CRC::ccitt16(data + chkofs[block], chklen[block]);
 }
 
 std::map<Pouch, std::vector<int>> SavXY::validItems() const
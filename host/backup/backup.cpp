@@ -0,0 +1,166 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "BackupStore.hpp"
+#include "Sav.hpp"
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Command line access to a BackupStore, like the one PKSM keeps in /3ds/PKSM/backups/store. Usage:
+//   pksm-backup <store> backup <id> <save files...>
+//   pksm-backup <store> restore <manifest> <output file>
+//   pksm-backup <store> list <id>
+//   pksm-backup <store> verify
+//   pksm-backup <store> prune <backups to keep per id>
+
+namespace
+{
+    bool readFile(const char* path, std::vector<u8>& data)
+    {
+        FILE* in = fopen(path, "rb");
+        if (!in)
+        {
+            return false;
+        }
+        fseek(in, 0, SEEK_END);
+        data.resize(ftell(in));
+        fseek(in, 0, SEEK_SET);
+        bool good = fread(data.data(), 1, data.size(), in) == data.size();
+        fclose(in);
+        return good;
+    }
+
+    const char* baseName(const char* path)
+    {
+        const char* slash = strrchr(path, '/');
+        return slash ? slash + 1 : path;
+    }
+
+    int usage(const char* self)
+    {
+        fprintf(stderr,
+            "Usage: %s <store> backup <id> <save files...>\n"
+            "       %s <store> restore <manifest> <output file>\n"
+            "       %s <store> list <id>\n"
+            "       %s <store> verify\n"
+            "       %s <store> prune <backups to keep per id>\n",
+            self, self, self, self, self);
+        return 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        return usage(argv[0]);
+    }
+    BackupStore store(argv[1]);
+    const char* command = argv[2];
+
+    if (!strcmp(command, "backup") && argc >= 5)
+    {
+        int ret = 0;
+        for (int i = 4; i < argc; i++)
+        {
+            std::vector<u8> data;
+            if (!readFile(argv[i], data))
+            {
+                fprintf(stderr, "Could not read %s\n", argv[i]);
+                ret = 1;
+                continue;
+            }
+            // Anything that isn't a save is still backed up, just in fixed-size chunks
+            std::vector<Sav::Block> blocks;
+            if (std::unique_ptr<Sav> save = Sav::getSave(data.data(), data.size()))
+            {
+                blocks = save->blocks();
+            }
+            std::string manifest = store.backup(argv[3], baseName(argv[i]), data.data(), data.size(), blocks);
+            if (manifest.empty())
+            {
+                fprintf(stderr, "Could not back up %s\n", argv[i]);
+                ret = 1;
+                continue;
+            }
+            printf("%s\n", manifest.c_str());
+        }
+        return ret;
+    }
+    else if (!strcmp(command, "restore") && argc == 5)
+    {
+        std::vector<u8> data;
+        if (!store.restore(argv[3], data))
+        {
+            fprintf(stderr, "Could not restore %s\n", argv[3]);
+            return 1;
+        }
+        FILE* out = fopen(argv[4], "wb");
+        if (!out || fwrite(data.data(), 1, data.size(), out) != data.size())
+        {
+            fprintf(stderr, "Could not write %s\n", argv[4]);
+            if (out)
+            {
+                fclose(out);
+            }
+            return 1;
+        }
+        fclose(out);
+        return 0;
+    }
+    else if (!strcmp(command, "list") && argc == 4)
+    {
+        for (const auto& path : store.backups(argv[3]))
+        {
+            BackupStore::Manifest manifest;
+            if (store.readManifest(path, manifest))
+            {
+                printf("%s\t%s\t%u bytes\t%zu chunks\n", path.c_str(), manifest.saveName.c_str(), manifest.size, manifest.chunks.size());
+            }
+            else
+            {
+                printf("%s\tdamaged\n", path.c_str());
+            }
+        }
+        return 0;
+    }
+    else if (!strcmp(command, "verify") && argc == 3)
+    {
+        BackupStore::Report report = store.verify();
+        printf("%zu manifests, %zu damaged\n%zu chunks, %zu missing, %zu corrupt, %zu unreferenced\n", report.manifests,
+            report.damagedManifests, report.chunks, report.missingChunks, report.corruptChunks, report.unreferencedChunks);
+        return report.damagedManifests || report.missingChunks || report.corruptChunks ? 1 : 0;
+    }
+    else if (!strcmp(command, "prune") && argc == 4)
+    {
+        printf("%zu chunks removed\n", store.prune(strtoul(argv[3], nullptr, 10)));
+        return 0;
+    }
+    return usage(argv[0]);
+}
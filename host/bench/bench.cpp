@@ -0,0 +1,1036 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "CompiledPKFilter.hpp"
+#include "PB7.hpp"
+#include "PK4.hpp"
+#include "PK5.hpp"
+#include "PK6.hpp"
+#include "PK7.hpp"
+#include "PKXIndex.hpp"
+#include "Sav.hpp"
+#include "crc.hpp"
+#include "i18n.hpp"
+#include "json.hpp"
+#include "mysterygift.hpp"
+#include "random.hpp"
+#include "sha256.h"
+#include "utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <malloc.h>
+#include <map>
+#include <numeric>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+
+// Times the hot paths of the save and Pokemon code and prints the results as JSON.
+// Every save given on the command line is a fixture, and so is a blank save of each supported game, with every box slot filled with
+// random Pokemon. The run also checks that CompiledPKFilter gives the same answers as PKX::operator==, and fails if it doesn't
+
+namespace
+{
+    volatile u64 sink;
+
+    // The checksums as they were before the slicing-by-8 tables: bitwise CCITT, and CRC-16 one byte at a time through a single table.
+    // CRC:: has to agree with them on every buffer, and the MB/s of both shows what the tables buy
+    u16 referenceCcitt16(const u8* buf, u32 len)
+    {
+        u16 crc = 0xFFFF;
+        for (u32 i = 0; i < len; i++)
+        {
+            crc ^= (u16)(buf[i] << 8);
+            for (u32 j = 0; j < 0x8; j++)
+            {
+                if ((crc & 0x8000) > 0)
+                    crc = (u16)((crc << 1) ^ 0x1021);
+                else
+                    crc <<= 1;
+            }
+        }
+        return crc;
+    }
+
+    constexpr u16 referenceCrc16Table[256] = {
+        0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241, 0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1,
+        0xC481, 0x0440, 0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40, 0x0A00, 0xCAC1, 0xCB81, 0x0B40,
+        0xC901, 0x09C0, 0x0880, 0xC841, 0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40, 0x1E00, 0xDEC1,
+        0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41, 0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+        0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040, 0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1,
+        0xF281, 0x3240, 0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441, 0x3C00, 0xFCC1, 0xFD81, 0x3D40,
+        0xFF01, 0x3FC0, 0x3E80, 0xFE41, 0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840, 0x2800, 0xE8C1,
+        0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41, 0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+        0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640, 0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0,
+        0x2080, 0xE041, 0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240, 0x6600, 0xA6C1, 0xA781, 0x6740,
+        0xA501, 0x65C0, 0x6480, 0xA441, 0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41, 0xAA01, 0x6AC0,
+        0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840, 0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+        0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40, 0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1,
+        0xB681, 0x7640, 0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041, 0x5000, 0x90C1, 0x9181, 0x5140,
+        0x9301, 0x53C0, 0x5280, 0x9241, 0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440, 0x9C01, 0x5CC0,
+        0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40, 0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+        0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40, 0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0,
+        0x4C80, 0x8C41, 0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641, 0x8201, 0x42C0, 0x4380, 0x8341,
+        0x4100, 0x81C1, 0x8081, 0x4040};
+
+    u16 referenceCrc16(const u8* buf, u32 len, u16 crc)
+    {
+        for (u32 i = 0; i < len; i++)
+        {
+            crc = (referenceCrc16Table[(buf[i] ^ crc) & 0xFF] ^ crc >> 8);
+        }
+        return crc;
+    }
+
+    // Blocks as big as a whole save are mmapped by glibc and only show up in hblkhd
+    size_t heapInUse(void)
+    {
+        struct mallinfo2 info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+    }
+
+    const std::string sampleNames[] = {"Pikachu", "Nidoran♀", "Flabébé", "ピカチュウ", "피카츄", "皮卡丘", "Farfetch'd", "Mr. Mime"};
+
+    struct Fixture
+    {
+        std::string name;
+        std::vector<u8> data;
+        bool synthetic;
+    };
+
+    class Runner
+    {
+    public:
+        explicit Runner(u32 iterations) : iterations(iterations) {}
+
+        // setup runs before every iteration and is not part of the measurement
+        void run(const std::string& fixture, const std::string& name, size_t bytes, const std::function<void()>& setup,
+            const std::function<void()>& body)
+        {
+            std::vector<double> times;
+            times.reserve(iterations);
+            for (u32 i = 0; i < iterations; i++)
+            {
+                setup();
+                auto start = std::chrono::steady_clock::now();
+                body();
+                auto end = std::chrono::steady_clock::now();
+                times.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+            }
+            std::sort(times.begin(), times.end());
+            nlohmann::json result;
+            result["fixture"]    = fixture;
+            result["name"]       = name;
+            result["iterations"] = iterations;
+            result["bytes"]      = bytes;
+            result["min_ns"]     = times.front();
+            result["median_ns"]  = times[times.size() / 2];
+            result["mean_ns"]    = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+            // Bytes per nanosecond is GB/s
+            double mbPerSecond = bytes ? bytes * 1000.0 / std::max(times[times.size() / 2], 1.0) : 0;
+            if (bytes)
+            {
+                result["mb_per_s"] = mbPerSecond;
+            }
+            results.push_back(result);
+            fprintf(stderr, "%-24s %-28s %14.0f ns", fixture.c_str(), name.c_str(), times[times.size() / 2]);
+            if (bytes)
+            {
+                fprintf(stderr, " %10.1f MB/s", mbPerSecond);
+            }
+            fprintf(stderr, "\n");
+        }
+
+        void run(const std::string& fixture, const std::string& name, size_t bytes, const std::function<void()>& body)
+        {
+            run(fixture, name, bytes, [] {}, body);
+        }
+
+        void check(const std::string& fixture, const std::string& name, u32 cases, u32 mismatches)
+        {
+            nlohmann::json result;
+            result["fixture"]    = fixture;
+            result["name"]       = name;
+            result["cases"]      = cases;
+            result["mismatches"] = mismatches;
+            checks.push_back(result);
+            failed |= mismatches != 0;
+            if (mismatches != 0)
+            {
+                fprintf(stderr, "%-24s %-28s %u of %u cases differ\n", fixture.c_str(), name.c_str(), mismatches, cases);
+            }
+        }
+
+        void memory(const std::string& name, size_t bytes)
+        {
+            nlohmann::json result;
+            result["name"]  = name;
+            result["bytes"] = bytes;
+            memoryUse.push_back(result);
+            fprintf(stderr, "%-24s %-28s %14zu B\n", "", name.c_str(), bytes);
+        }
+
+        nlohmann::json json(void) const
+        {
+            nlohmann::json ret;
+            ret["iterations"] = iterations;
+            ret["results"]    = results;
+            ret["checks"]     = checks;
+            ret["memory"]     = memoryUse;
+            return ret;
+        }
+
+        bool passed(void) const { return !failed; }
+
+    private:
+        u32 iterations;
+        nlohmann::json results = nlohmann::json::array();
+        nlohmann::json checks    = nlohmann::json::array();
+        nlohmann::json memoryUse = nlohmann::json::array();
+        bool failed              = false;
+    };
+
+    std::vector<u8> blankGen4(const u8 (&pattern)[10])
+    {
+        std::vector<u8> ret(0x80000, 0);
+        std::copy(pattern, pattern + 10, ret.begin() + *(u16*)pattern - 0xC);
+        return ret;
+    }
+
+    std::vector<u8> blankGen5(u32 footer, u32 footerLength)
+    {
+        std::vector<u8> ret(0x80000, 0);
+        *(u16*)(ret.data() + footer + footerLength + 0xE) = CRC::ccitt16(ret.data() + footer, footerLength);
+        return ret;
+    }
+
+    // The checksum of a Gen 7 block depends on the block ID stored next to it
+    std::vector<u8> blankGen7(u32 size, u32 checksumTable, u32 blocks)
+    {
+        std::vector<u8> ret(size, 0);
+        for (u32 i = 0; i < blocks; i++)
+        {
+            *(u16*)(ret.data() + checksumTable + i * 8 + 0x18) = i;
+        }
+        return ret;
+    }
+
+    // Only what Sav::getSave looks at to tell the games apart is filled in, along with what the checksums need
+    std::vector<Fixture> blankSaves(void)
+    {
+        static constexpr u8 dpPattern[]   = {0x00, 0xC1, 0x00, 0x00, 0x23, 0x06, 0x06, 0x20, 0x00, 0x00};
+        static constexpr u8 ptPattern[]   = {0x2C, 0xCF, 0x00, 0x00, 0x23, 0x06, 0x06, 0x20, 0x00, 0x00};
+        static constexpr u8 hgssPattern[] = {0x28, 0xF6, 0x00, 0x00, 0x23, 0x06, 0x06, 0x20, 0x00, 0x00};
+        return {{"blank DP", blankGen4(dpPattern), true}, {"blank Pt", blankGen4(ptPattern), true}, {"blank HGSS", blankGen4(hgssPattern), true},
+            {"blank BW", blankGen5(0x24000 - 0x100, 0x8C), true}, {"blank B2W2", blankGen5(0x26000 - 0x100, 0x94), true},
+            {"blank XY", std::vector<u8>(0x65600, 0), true}, {"blank ORAS", std::vector<u8>(0x76000, 0), true},
+            {"blank SM", blankGen7(0x6BE00, 0x6BC00, 37), true}, {"blank USUM", blankGen7(0x6CC00, 0x6CA00, 39), true},
+            {"blank LGPE", std::vector<u8>(0xB8800, 0), true}};
+    }
+
+    bool readFixture(const char* path, Fixture& fixture)
+    {
+        FILE* in = fopen(path, "rb");
+        if (!in)
+        {
+            return false;
+        }
+        fseek(in, 0, SEEK_END);
+        fixture.data.resize(ftell(in));
+        fseek(in, 0, SEEK_SET);
+        bool good = fread(fixture.data.data(), 1, fixture.data.size(), in) == fixture.data.size();
+        fclose(in);
+        const char* name  = strrchr(path, '/');
+        fixture.name      = name ? name + 1 : path;
+        fixture.synthetic = false;
+        return good;
+    }
+
+    void fillBoxes(Sav& save, std::mt19937& rng)
+    {
+        for (int i = 0; i < save.maxSlot(); i++)
+        {
+            auto pkm = save.emptyPkm();
+            pkm->species(1 + rng() % save.maxSpecies());
+            pkm->encryptionConstant(rng());
+            pkm->PID(rng());
+            pkm->TID(rng());
+            pkm->SID(rng());
+            pkm->level(1 + rng() % 100);
+            pkm->nature(rng() % 25);
+            pkm->heldItem(rng() % save.maxItem());
+            pkm->ball(1 + rng() % save.maxBall());
+            pkm->language(1 + rng() % 8);
+            pkm->nickname(sampleNames[rng() % 8]);
+            pkm->otName(sampleNames[rng() % 8]);
+            for (u8 move = 0; move < 4; move++)
+            {
+                pkm->move(move, rng() % save.maxMove());
+            }
+            for (u8 stat = 0; stat < 6; stat++)
+            {
+                pkm->iv(stat, rng() % 32);
+            }
+            if (rng() % 16 == 0)
+            {
+                pkm->shiny(true);
+            }
+            save.pkm(pkm, i / 30, i % 30, false);
+        }
+    }
+
+    // One filter per kind of check, with values taken from a Pokemon in the save so that each of them matches something
+    std::vector<PKFilter> sampleFilters(const PKX& pkm)
+    {
+        std::vector<PKFilter> ret(17);
+        ret[1].species(pkm.species());
+        ret[1].speciesEnabled(true);
+        ret[2].species(pkm.species());
+        ret[2].speciesEnabled(true);
+        ret[2].speciesInversed(true);
+        ret[3].level(pkm.level());
+        ret[3].levelEnabled(true);
+        ret[4].shiny(true);
+        ret[4].shinyEnabled(true);
+        ret[5].nature(pkm.nature());
+        ret[5].natureEnabled(true);
+        ret[6].ball(pkm.ball());
+        ret[6].ballEnabled(true);
+        ret[7].heldItem(pkm.heldItem());
+        ret[7].heldItemEnabled(true);
+        ret[8].ability(pkm.ability());
+        ret[8].abilityEnabled(true);
+        ret[9].TSV(pkm.TSV());
+        ret[9].TSVEnabled(true);
+        ret[10].gender(pkm.gender());
+        ret[10].genderEnabled(true);
+        ret[11].move(0, pkm.move(0));
+        ret[11].moveEnabled(0, true);
+        ret[12].iv(0, pkm.iv(0));
+        ret[12].ivEnabled(0, true);
+        ret[13].language(pkm.language());
+        ret[13].languageEnabled(true);
+        ret[14].egg(true);
+        ret[14].eggEnabled(true);
+        ret[14].eggInversed(true);
+        ret[15].generation(pkm.generation());
+        ret[15].generationEnabled(true);
+        ret[16].alternativeForm(pkm.alternativeForm());
+        ret[16].alternativeFormEnabled(true);
+        ret[16].level(50);
+        ret[16].levelEnabled(true);
+        ret[16].levelInversed(true);
+        return ret;
+    }
+
+    // Moves up to 30 boxes of Gen 4 Pokemon into the save's boxes, like a bank transfer does
+    void benchTransfer(Runner& runner, Sav& save, const std::string& name)
+    {
+        std::mt19937 rng(0x504B534D);
+        const int count = std::min(save.maxSlot(), 30 * 30);
+        std::vector<u8> gen4(136 * count);
+        for (int i = 0; i < count; i++)
+        {
+            PK4 pk4(gen4.data() + i * 136, false, false, true);
+            pk4.species(1 + rng() % 493);
+            pk4.PID(rng());
+            pk4.TID(rng());
+            pk4.SID(rng());
+            pk4.version(10 + rng() % 3);
+            pk4.level(1 + rng() % 100);
+            pk4.heldItem(rng() % 400);
+            pk4.ball(1 + rng() % 16);
+            pk4.language(1 + rng() % 7);
+            pk4.nickname(sampleNames[rng() % 8]);
+            pk4.otName(sampleNames[rng() % 8]);
+            for (u8 move = 0; move < 4; move++)
+            {
+                pk4.move(move, rng() % 467);
+            }
+            for (u8 stat = 0; stat < 6; stat++)
+            {
+                pk4.iv(stat, rng() % 32);
+            }
+            pk4.refreshChecksum();
+        }
+
+        runner.run(name, "transfer Gen 4 (PKX chain)", gen4.size(), [&] {
+            for (int i = 0; i < count; i++)
+            {
+                std::shared_ptr<PKX> pkm = std::make_shared<PK4>(gen4.data() + i * 136);
+                while (pkm->generation() != save.generation())
+                {
+                    pkm = pkm->next(save);
+                }
+                save.pkm(pkm, i / 30, i % 30, false);
+            }
+        });
+        runner.run(name, "transfer Gen 4 (direct)", gen4.size(), [&] {
+            for (int i = 0; i < count; i++)
+            {
+                save.transfer(Generation::FOUR, gen4.data() + i * 136, i / 30, i % 30);
+            }
+        });
+
+        // Both draw the same random numbers when they're seeded the same, so the results have to be identical
+        u32 mismatches = 0;
+        for (int i = 0; i < count; i++)
+        {
+            randomNumbers.seed(i);
+            std::shared_ptr<PKX> pkm = std::make_shared<PK4>(gen4.data() + i * 136);
+            while (pkm->generation() != save.generation())
+            {
+                pkm = pkm->next(save);
+            }
+            randomNumbers.seed(i);
+            u8 converted[260];
+            mismatches += !PKX::convert(save, Generation::FOUR, gen4.data() + i * 136, save.generation(), converted) ||
+                          !std::equal(converted, converted + pkm->getLength(), pkm->rawData());
+        }
+        runner.check(name, "PKX::convert from Gen 4", count, mismatches);
+    }
+
+    void benchSave(Runner& runner, const Fixture& fixture)
+    {
+        const std::string& name = fixture.name;
+        std::unique_ptr<u8[]> buffer;
+        std::unique_ptr<Sav> loaded;
+        runner.run(name, "Sav::getSave", fixture.data.size(),
+            [&] {
+                loaded = nullptr;
+                buffer = std::unique_ptr<u8[]>(new u8[fixture.data.size()]);
+                std::copy(fixture.data.begin(), fixture.data.end(), buffer.get());
+            },
+            [&] { loaded = Sav::getSave(std::move(buffer), fixture.data.size()); });
+        if (!loaded)
+        {
+            fprintf(stderr, "%s is not a supported save\n", name.c_str());
+            return;
+        }
+
+        // The most the heap holds while loading, which is right after getSave returns and before the caller lets go of what it read
+        loaded        = nullptr;
+        size_t heap   = heapInUse();
+        auto fileData = std::unique_ptr<u8[]>(new u8[fixture.data.size()]);
+        std::copy(fixture.data.begin(), fixture.data.end(), fileData.get());
+        loaded = Sav::getSave(fileData.get(), fixture.data.size());
+        runner.memory(name + " Sav::getSave copying", heapInUse() - heap);
+        loaded   = nullptr;
+        fileData = nullptr;
+        heap     = heapInUse();
+        fileData = std::unique_ptr<u8[]>(new u8[fixture.data.size()]);
+        std::copy(fixture.data.begin(), fixture.data.end(), fileData.get());
+        loaded = Sav::getSave(std::move(fileData), fixture.data.size());
+        runner.memory(name + " Sav::getSave adopting", heapInUse() - heap);
+        Sav& save = *loaded;
+
+        save.cryptBoxData(true);
+        if (fixture.synthetic)
+        {
+            std::mt19937 rng(0x504B534D);
+            fillBoxes(save, rng);
+        }
+        const size_t boxBytes = save.boxOffset(1, 0) - save.boxOffset(0, 0);
+
+        std::shared_ptr<PKX> sample;
+        save.forEachSlot([&](u8 box, u8 slot, const PKX&) {
+            if (!sample)
+            {
+                sample = save.pkm(box, slot);
+            }
+        });
+        if (sample)
+        {
+            runner.run(name, "PKX::encrypt+decrypt", sample->getLength() * 2, [&] {
+                sample->encrypt();
+                sample->decrypt();
+            });
+        }
+
+        runner.run(name, "Sav::forEachSlot", boxBytes * save.maxBoxes(), [&] {
+            u64 total = 0;
+            save.forEachSlot([&](u8, u8, const PKX& pkm) { total += pkm.species(); });
+            sink = total;
+        });
+        runner.run(name, "PKX names", 0, [&] {
+            size_t total = 0;
+            save.forEachSlot([&](u8, u8, const PKX& pkm) { total += pkm.nickname().size() + pkm.otName().size(); });
+            sink = total;
+        });
+        runner.run(name, "Sav::index build", boxBytes * save.maxBoxes(), [&] { save.markDirty(); }, [&] { sink = save.index().size(); });
+        runner.run(name, "sort by level (index)", 0, [&] {
+            const PKXIndex& index          = save.index();
+            std::vector<u32> rows          = index.occupiedRows();
+            const std::vector<u16>& levels = index.column(PKXIndex::Column::LEVEL);
+            std::stable_sort(rows.begin(), rows.end(), [&](u32 a, u32 b) { return levels[a] < levels[b]; });
+            sink = rows.empty() ? 0 : rows[0];
+        });
+        runner.run(name, "sort by level (PKX)", 0, [&] {
+            std::vector<std::shared_ptr<PKX>> pkms;
+            for (int i = 0; i < save.maxSlot(); i++)
+            {
+                auto pkm = save.pkm(i / 30, i % 30);
+                if (pkm->species() != 0)
+                {
+                    pkms.push_back(pkm);
+                }
+            }
+            std::stable_sort(pkms.begin(), pkms.end(),
+                [](const std::shared_ptr<PKX>& a, const std::shared_ptr<PKX>& b) { return a->level() < b->level(); });
+            sink = pkms.size();
+        });
+
+        if (sample)
+        {
+            std::vector<PKFilter> filters = sampleFilters(*sample);
+            u32 cases = 0, mismatches = 0;
+            for (const auto& filter : filters)
+            {
+                CompiledPKFilter compiled(filter);
+                for (int box = 0; box < save.maxBoxes(); box++)
+                {
+                    u32 matches = save.filterBox(compiled, box);
+                    for (int slot = 0; slot < 30 && box * 30 + slot < save.maxSlot(); slot++)
+                    {
+                        bool expected = *save.pkm(box, slot) == filter;
+                        cases++;
+                        mismatches += expected != bool((matches >> slot) & 1);
+                    }
+                }
+            }
+            runner.check(name, "CompiledPKFilter", cases, mismatches);
+
+            const PKFilter& filter = filters[3];
+            CompiledPKFilter compiled(filter);
+            runner.run(name, "filter level (compiled)", boxBytes * save.maxBoxes(), [&] {
+                u32 total = 0;
+                for (int box = 0; box < save.maxBoxes(); box++)
+                {
+                    total += __builtin_popcount(save.filterBox(compiled, box));
+                }
+                sink = total;
+            });
+            runner.run(name, "filter level (PKX)", boxBytes * save.maxBoxes(), [&] {
+                u32 total = 0;
+                for (int i = 0; i < save.maxSlot(); i++)
+                {
+                    total += *save.pkm(i / 30, i % 30) == filter;
+                }
+                sink = total;
+            });
+        }
+
+        if (save.generation() != Generation::LGPE)
+        {
+            benchTransfer(runner, save, name);
+        }
+
+        bool decrypted = true;
+        runner.run(name, "Sav::cryptBoxData decrypt", boxBytes * save.maxBoxes(),
+            [&] {
+                if (decrypted)
+                {
+                    save.cryptBoxData(false);
+                }
+            },
+            [&] {
+                save.cryptBoxData(true);
+                decrypted = true;
+            });
+        runner.run(name, "Sav::cryptBoxData encrypt", boxBytes * save.maxBoxes(),
+            [&] {
+                if (!decrypted)
+                {
+                    save.cryptBoxData(true);
+                }
+            },
+            [&] {
+                save.cryptBoxData(false);
+                decrypted = false;
+            });
+
+        runner.run(name, "Sav::resign everything", fixture.data.size(), [&] { save.markDirty(); }, [&] { save.resign(); });
+
+        // Everything was just resigned with the boxes encrypted, like on disk, so every block has to check out until its data changes
+        std::vector<Sav::Block> blocks = save.blocks();
+        u32 blockMismatches            = 0;
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            u8& last = save.rawData()[blocks[i].offset + blocks[i].length - 1];
+            blockMismatches += !save.blockValid(i);
+            last ^= 1;
+            blockMismatches += save.blockValid(i);
+            last ^= 1;
+        }
+        runner.check(name, "Sav::blockValid", blocks.size() * 2, blockMismatches);
+        u32 crcMismatches = 0;
+        for (const auto& block : blocks)
+        {
+            const u8* start = save.rawData() + block.offset;
+            crcMismatches += CRC::ccitt16(start, block.length) != referenceCcitt16(start, block.length);
+            crcMismatches += CRC::crc16(start, block.length, 0) != referenceCrc16(start, block.length, 0);
+            crcMismatches += CRC::crc16(start, block.length, 0xFFFF) != referenceCrc16(start, block.length, 0xFFFF);
+        }
+        runner.check(name, "CRC against reference", blocks.size() * 3, crcMismatches);
+
+        // resign only redoes blocks that were reported through markDirty, so a setter that doesn't report its writes leaves a stale
+        // checksum behind. Setters that share a block would cover for each other, so each one starts from a freshly signed save
+        std::vector<std::pair<std::string, std::function<void()>>> setters = {
+            {"TID", [&] { save.TID(save.TID() + 1); }},
+            {"SID", [&] { save.SID(save.SID() + 1); }},
+            {"version", [&] { save.version(save.version() + 1); }},
+            {"gender", [&] { save.gender(save.gender() ^ 1); }},
+            {"subRegion", [&] { save.subRegion(save.subRegion() + 1); }},
+            {"country", [&] { save.country(save.country() + 1); }},
+            {"consoleRegion", [&] { save.consoleRegion(save.consoleRegion() + 1); }},
+            {"language", [&] { save.language(save.language() % 7 + 1); }},
+            {"otName", [&] { save.otName(save.otName() == "Bench" ? "Check" : "Bench"); }},
+            {"money", [&] { save.money(save.money() + 1); }},
+            {"BP", [&] { save.BP(save.BP() + 1); }},
+            {"playedHours", [&] { save.playedHours(save.playedHours() + 1); }},
+            {"playedMinutes", [&] { save.playedMinutes((save.playedMinutes() + 1) % 60); }},
+            {"playedSeconds", [&] { save.playedSeconds((save.playedSeconds() + 1) % 60); }},
+            {"currentBox", [&] { save.currentBox((save.currentBox() + 1) % save.maxBoxes()); }},
+            {"boxName", [&] { save.boxName(1, save.boxName(1) == "Bench" ? "Check" : "Bench"); }},
+        };
+        if (sample)
+        {
+            setters.emplace_back("party pkm", [&] { save.pkm(sample, 0); });
+            setters.emplace_back("partyCount", [&] { save.partyCount(save.partyCount() % 6 + 1); });
+            setters.emplace_back("dex", [&] { save.dex(sample); });
+        }
+        std::map<Pouch, std::vector<int>> validItems = save.validItems();
+        for (const auto& pouch : save.pouches())
+        {
+            Pouch kind = pouch.first;
+            if (validItems[kind].empty())
+            {
+                continue;
+            }
+            setters.emplace_back("item", [&, kind] {
+                auto item = save.item(kind, 0);
+                if (item)
+                {
+                    item->id(validItems[kind][0] == item->id() ? validItems[kind].back() : validItems[kind][0]);
+                    item->count(item->count() + 1);
+                    save.item(*item, kind, 0);
+                }
+            });
+        }
+        if (save.generation() != Generation::LGPE && save.maxWondercards() > 0)
+        {
+            setters.emplace_back("mysteryGift", [&] {
+                auto gift = save.mysteryGift(0);
+                int pos   = save.maxWondercards() - 1;
+                save.mysteryGift(*gift, pos);
+            });
+        }
+        u32 staleSetters = 0;
+        for (const auto& setter : setters)
+        {
+            save.markDirty();
+            save.resign();
+            setter.second();
+            save.resign();
+            bool stale = false;
+            for (size_t i = 0; i < blocks.size(); i++)
+            {
+                stale |= !save.blockValid(i);
+            }
+            std::vector<u8> incremental(save.rawData(), save.rawData() + save.getLength());
+            save.markDirty();
+            save.resign();
+            stale |= !std::equal(incremental.begin(), incremental.end(), save.rawData());
+            if (stale)
+            {
+                fprintf(stderr, "%s: Sav::resign missed what %s wrote\n", name.c_str(), setter.first.c_str());
+                staleSetters++;
+            }
+        }
+        runner.check(name, "Sav::resign after each setter", setters.size(), staleSetters);
+
+        if (sample)
+        {
+            runner.run(name, "Sav::resign one slot", fixture.data.size(), [&] { save.pkm(sample, 0, 0, false); }, [&] { save.resign(); });
+            runner.run(name, "Sav::resign trainer edit", fixture.data.size(), [&] { save.money(save.money() ^ 1); }, [&] { save.resign(); });
+        }
+    }
+
+    void benchCommon(Runner& runner)
+    {
+        std::mt19937 rng(0x504B534D);
+        std::vector<u8> data(0x10000);
+        std::generate(data.begin(), data.end(), [&] { return rng(); });
+
+        runner.run("", "CRC::ccitt16", data.size(), [&] { sink = CRC::ccitt16(data.data(), data.size()); });
+        runner.run("", "CRC::ccitt16 (bitwise)", data.size(), [&] { sink = referenceCcitt16(data.data(), data.size()); });
+        runner.run("", "CRC::crc16", data.size(), [&] { sink = CRC::crc16(data.data(), data.size(), 0); });
+        runner.run("", "CRC::crc16 (bytewise)", data.size(), [&] { sink = referenceCrc16(data.data(), data.size(), 0); });
+        // Every length up to a few slices, at every alignment the slicing loop can start on
+        u32 cases = 0, mismatches = 0;
+        for (u32 offset = 0; offset < 8; offset++)
+        {
+            for (u32 len = 0; len <= 300; len++)
+            {
+                u16 init = rng();
+                cases += 2;
+                mismatches += CRC::ccitt16(data.data() + offset, len) != referenceCcitt16(data.data() + offset, len);
+                mismatches += CRC::crc16(data.data() + offset, len, init) != referenceCrc16(data.data() + offset, len, init);
+            }
+        }
+        runner.check("", "CRC against reference", cases, mismatches);
+        runner.run("", "PKXCrypt::xorKeystream", data.size(), [&] { PKXCrypt::xorKeystream(data.data(), data.size(), 0x12345678); });
+
+        // A 100 box bank laid out like Bank's entries, half of them holding a Pokemon. The running checksum is what Bank::load pays once
+        // and Bank::pkm pays per entry; SHA-256 over the same bytes is what every hasChanged used to cost
+        struct BankEntry
+        {
+            Generation gen;
+            u8 data[260];
+        };
+        std::vector<BankEntry> bank(100 * 30);
+        for (size_t i = 0; i < bank.size(); i++)
+        {
+            bank[i].gen = i % 2 ? Generation::SEVEN : Generation::UNUSED;
+            std::generate(std::begin(bank[i].data), std::end(bank[i].data), [&] { return rng(); });
+        }
+        const size_t bankBytes = bank.size() * sizeof(BankEntry);
+        auto entryChecksum     = [](u32 index, const BankEntry& entry) -> u64 {
+            return entry.gen == Generation::UNUSED ? 0 : CRC::fnv1a64((const u8*)&entry, sizeof(BankEntry)) * (2 * u64(index) + 1);
+        };
+        runner.run("", "Bank checksum (100 boxes)", bankBytes, [&] {
+            u64 sum = 0;
+            for (u32 i = 0; i < bank.size(); i++)
+            {
+                sum += entryChecksum(i, bank[i]);
+            }
+            sink = sum;
+        });
+        runner.run("", "Bank checksum one entry", sizeof(BankEntry) * 2, [&] {
+            sink = sink - entryChecksum(1, bank[1]) + entryChecksum(1, bank[3]);
+        });
+        u8 hash[SHA256_BLOCK_SIZE];
+        runner.run("", "sha256 (100 box bank)", bankBytes, [&] { sha256(hash, (u8*)bank.data(), bankBytes); });
+
+        std::vector<std::string> names;
+        std::vector<std::u16string> names16;
+        size_t bytes = 0;
+        for (int i = 0; i < 1000; i++)
+        {
+            names.push_back(sampleNames[i % 8]);
+            names16.push_back(StringUtils::UTF8toUTF16(names.back()));
+            bytes += names.back().size();
+        }
+        std::vector<u8> buffer(0x40 * names.size());
+
+        runner.run("", "StringUtils::UTF8toUTF16", bytes, [&] {
+            size_t total = 0;
+            for (const auto& name : names)
+            {
+                total += StringUtils::UTF8toUTF16(name).size();
+            }
+            sink = total;
+        });
+        runner.run("", "StringUtils::UTF16toUTF8", bytes, [&] {
+            size_t total = 0;
+            for (const auto& name : names16)
+            {
+                total += StringUtils::UTF16toUTF8(name).size();
+            }
+            sink = total;
+        });
+        runner.run("", "StringUtils::setString", bytes, [&] {
+            for (size_t i = 0; i < names.size(); i++)
+            {
+                StringUtils::setString(buffer.data(), names[i], i * 0x40, 12);
+            }
+        });
+        runner.run("", "StringUtils::getString", bytes, [&] {
+            size_t total = 0;
+            for (size_t i = 0; i < names.size(); i++)
+            {
+                total += StringUtils::getString(buffer.data(), i * 0x40, 12).size();
+            }
+            sink = total;
+        });
+        runner.run("", "StringUtils::setString67", bytes, [&] {
+            for (size_t i = 0; i < names.size(); i++)
+            {
+                StringUtils::setString67(buffer.data(), names[i], i * 0x40, 12);
+            }
+        });
+        runner.run("", "StringUtils::getString67", bytes, [&] {
+            size_t total = 0;
+            for (size_t i = 0; i < names.size(); i++)
+            {
+                total += StringUtils::getString67(buffer.data(), i * 0x40, 12).size();
+            }
+            sink = total;
+        });
+        runner.run("", "StringUtils::setString4", bytes, [&] {
+            for (size_t i = 0; i < names.size(); i++)
+            {
+                StringUtils::setString4(buffer.data(), names[i], i * 0x40, 11);
+            }
+        });
+        runner.run("", "StringUtils::getString4", bytes, [&] {
+            size_t total = 0;
+            for (size_t i = 0; i < names.size(); i++)
+            {
+                total += StringUtils::getString4(buffer.data(), i * 0x40, 11).size();
+            }
+            sink = total;
+        });
+    }
+    // Makes Pokemon from games whose PIDs decide the nature, ability and gender shiny, which is the worst case for PID generation
+    void benchPID(Runner& runner)
+    {
+        struct Case
+        {
+            Generation gen;
+            u8 version;
+        };
+        for (auto c : {Case{Generation::FOUR, 2}, Case{Generation::FIVE, 20}, Case{Generation::SIX, 12}, Case{Generation::SEVEN, 24},
+                 Case{Generation::LGPE, 42}})
+        {
+            std::string fixture = std::string("PID gen ") + genToCstring(c.gen);
+            std::mt19937 rng(0x504B534D);
+            std::vector<u8> data(260 * 1000);
+            std::vector<std::unique_ptr<PKX>> pkms;
+            for (size_t i = 0; i < 1000; i++)
+            {
+                u8* pkmData = data.data() + i * 260;
+                switch (c.gen)
+                {
+                    case Generation::FOUR:
+                        pkms.emplace_back(std::make_unique<PK4>(pkmData, false, false, true));
+                        break;
+                    case Generation::FIVE:
+                        pkms.emplace_back(std::make_unique<PK5>(pkmData, false, false, true));
+                        break;
+                    case Generation::SIX:
+                        pkms.emplace_back(std::make_unique<PK6>(pkmData, false, false, true));
+                        break;
+                    case Generation::SEVEN:
+                        pkms.emplace_back(std::make_unique<PK7>(pkmData, false, false, true));
+                        break;
+                    default:
+                        pkms.emplace_back(std::make_unique<PB7>(pkmData, false, true));
+                        break;
+                }
+            }
+            auto reset = [&] {
+                for (auto& pkm : pkms)
+                {
+                    pkm->species(1 + rng() % 386);
+                    pkm->version(c.version);
+                    pkm->TID(rng());
+                    pkm->SID(rng());
+                    u8 ability = 1 << (rng() % 2);
+                    pkm->PID(PKX::getRandomPID(pkm->species(), pkm->gender(), c.version, rng() % 25, 0, ability, false, pkm->TID(), pkm->SID(), c.gen));
+                    pkm->abilityNumber(ability);
+                    pkm->shiny(false);
+                }
+            };
+
+            runner.run(fixture, "PKX::shiny", 0, reset, [&] {
+                for (auto& pkm : pkms)
+                {
+                    pkm->shiny(true);
+                }
+            });
+
+            // The PID only holds the ability for games before Gen 6, in bit 16 for Gen 5 and bit 0 for the others
+            auto abilityBit = [&](const PKX& pkm) { return c.version < 24 ? (pkm.PID() >> (c.gen == Generation::FIVE ? 16 : 0)) & 1 : 0; };
+            reset();
+            u32 mismatches = 0;
+            for (auto& pkm : pkms)
+            {
+                u8 nature = pkm->nature();
+                u32 bit   = abilityBit(*pkm);
+                pkm->shiny(true);
+                mismatches += !pkm->shiny() || pkm->nature() != nature || abilityBit(*pkm) != bit;
+            }
+            runner.check(fixture, "PKX::shiny keeps the rest", pkms.size(), mismatches);
+        }
+    }
+
+    // Reads something from every table of every language, which is what i18n::init used to do up front
+    void touchEverything(void)
+    {
+        for (u8 lang = Language::JP; lang <= Language::RU; lang++)
+        {
+            sink = i18n::ability(lang, 1).size() + i18n::ball(lang, 1).size() + i18n::form(lang, 3, 1, Generation::SEVEN).size() +
+                   i18n::hp(lang, 1).size() + i18n::item(lang, 1).size() + i18n::move(lang, 1).size() + i18n::nature(lang, 1).size() +
+                   i18n::species(lang, 1).size() + i18n::game(lang, 1).size() + i18n::localize(Language(lang), "YES").size();
+            for (auto g : {Generation::FOUR, Generation::FIVE, Generation::SIX, Generation::SEVEN, Generation::LGPE})
+            {
+                sink = i18n::location(lang, 1, g).size();
+            }
+            for (const auto& country : i18n::rawCountries(lang))
+            {
+                sink = i18n::rawSubregions(lang, country.first).size();
+            }
+        }
+    }
+
+    void benchI18n(Runner& runner)
+    {
+        runner.run("", "i18n cold start", 0, [] { i18n::exit(); }, [] {
+            i18n::init();
+            sink = i18n::localize("YES").size();
+        });
+        runner.run("", "i18n every table", 0, [] { i18n::exit(); }, [] { touchEverything(); });
+        runner.run("", "i18n::form every form", 0, [] {
+            size_t total = 0;
+            for (auto g : {Generation::FOUR, Generation::FIVE, Generation::SIX, Generation::SEVEN, Generation::LGPE})
+            {
+                for (u16 species = 0; species <= 809; species++)
+                {
+                    for (u8 form = 0; form < 32; form++)
+                    {
+                        total += i18n::form(Language::EN, species, form, g).size();
+                    }
+                }
+            }
+            sink = total;
+        });
+
+        i18n::exit();
+        size_t heap = heapInUse();
+        i18n::init();
+        sink = i18n::localize("YES").size();
+        runner.memory("i18n cold start", heapInUse() - heap);
+        touchEverything();
+        runner.memory("i18n every table", heapInUse() - heap);
+        i18n::exit();
+    }
+
+    // Uses the event databases that common/EventsGalleryPacker puts in assets/romfs/mg, and skips generations that don't have one
+    void benchMysteryGift(Runner& runner)
+    {
+        for (auto g : {Generation::FOUR, Generation::FIVE, Generation::SIX, Generation::SEVEN})
+        {
+            std::string fixture = std::string("mystery gift gen ") + genToCstring(g);
+            MysteryGift::init(g);
+            std::vector<MysteryGift::eventData> events = MysteryGift::wondercards();
+            MysteryGift::exit();
+            if (events.empty())
+            {
+                continue;
+            }
+
+            runner.run(fixture, "MysteryGift::init", 0, [] { MysteryGift::exit(); }, [g] {
+                MysteryGift::init(g);
+                sink = MysteryGift::wondercards().size();
+            });
+            runner.run(fixture, "MysteryGift::wondercardInfo", 0, [&] {
+                size_t total = 0;
+                for (const auto& event : events)
+                {
+                    total += MysteryGift::wondercardInfo(event.card(event.firstLanguage())).name.size();
+                }
+                sink = total;
+            });
+            runner.run(fixture, "MysteryGift::wondercard", 0, [g] { MysteryGift::init(g); }, [&] {
+                auto wc = MysteryGift::wondercard(events[events.size() / 2].card(events[events.size() / 2].firstLanguage()));
+                sink    = wc ? wc->species() : 0;
+            });
+
+            MysteryGift::exit();
+            size_t heap = heapInUse();
+            MysteryGift::init(g);
+            sink = MysteryGift::wondercards().size();
+            runner.memory(fixture + " init", heapInUse() - heap);
+            MysteryGift::exit();
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    u32 iterations     = 20;
+    const char* output = nullptr;
+    bool blanks        = true;
+    std::vector<Fixture> fixtures;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+        {
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--no-blank-saves"))
+        {
+            blanks = false;
+        }
+        else
+        {
+            Fixture fixture;
+            if (!readFixture(argv[i], fixture))
+            {
+                fprintf(stderr, "Could not read %s\n", argv[i]);
+                return 2;
+            }
+            fixtures.emplace_back(std::move(fixture));
+        }
+    }
+    if (blanks)
+    {
+        for (auto& fixture : blankSaves())
+        {
+            fixtures.emplace_back(std::move(fixture));
+        }
+    }
+
+    Runner runner(iterations);
+    benchCommon(runner);
+    benchPID(runner);
+    benchI18n(runner);
+    benchMysteryGift(runner);
+    for (const auto& fixture : fixtures)
+    {
+        benchSave(runner, fixture);
+    }
+
+    std::string json = runner.json().dump(2);
+    FILE* out        = output ? fopen(output, "w") : stdout;
+    if (!out)
+    {
+        fprintf(stderr, "Could not write %s\n", output);
+        return 2;
+    }
+    fprintf(out, "%s\n", json.c_str());
+    if (output)
+    {
+        fclose(out);
+    }
+    return runner.passed() ? 0 : 1;
+}
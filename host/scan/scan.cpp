@@ -0,0 +1,452 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "PKXIndex.hpp"
+#include "PKXView.hpp"
+#include "Sav.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// Walks directories for saves, like the backups PKSM and Checkpoint keep, checks the checksum of every block of each one and writes
+// every boxed and party Pokemon to a columnar file. Usage: pksm-scan [--threads N] [--output scan.bin] <directories or files...>
+//
+// Saves are handed to a work-stealing pool as soon as the walk finds them, and each one is written out as soon as it's done, so
+// neither the walk nor the output ever holds more than a few saves. Layout of the output, all little endian:
+//   char magic[8] = "PKSMSCAN"
+//   u32 version
+//   u32 columnCount
+//   char names[columnCount][16], NUL padded
+// followed by one group per save until the end of the file:
+//   u32 rows
+//   u32 pathLength
+//   char path[pathLength]
+//   u8 generation, as in generation.hpp
+//   u8 version, the save's game
+//   u16 blocks, the number of checksummed blocks
+//   u16 badBlocks, the number of those whose checksum doesn't match
+//   u16 values[columnCount][rows], column after column
+//   and for the nickname and then the OT name, u32 ends[rows] followed by the UTF-8 strings without terminators
+
+namespace
+{
+    constexpr u32 version = 1;
+
+    // The sizes Sav::getSave knows
+    constexpr size_t saveSizes[] = {0x65600, 0x6BE00, 0x6CC00, 0x76000, 0x80000, 0xB8800, 0x100000};
+
+    // box and slot, then PKXIndex::Column in order. Party Pokemon are in box 0xFFFF
+    constexpr char columnNames[][16] = {"box", "slot", "species", "form", "level", "nature", "hpIV", "atkIV", "defIV", "speIV", "satkIV",
+        "sdefIV", "hp", "atk", "def", "spe", "satk", "sdef", "tsv", "ball", "language", "shiny", "type1", "type2", "tid", "hiddenPower",
+        "friendship"};
+    static_assert(std::size(columnNames) == 2 + size_t(PKXIndex::Column::COLUMN_COUNT));
+    constexpr u16 partyBox = 0xFFFF;
+
+    class WorkStealingPool
+    {
+    public:
+        explicit WorkStealingPool(size_t threads)
+        {
+            for (size_t i = 0; i < threads; i++)
+            {
+                queues.emplace_back(std::make_unique<Queue>());
+            }
+            for (size_t i = 0; i < threads; i++)
+            {
+                workers.emplace_back([this, i] { work(i); });
+            }
+        }
+
+        // Waits for every job
+        ~WorkStealingPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                closing = true;
+            }
+            idle.notify_all();
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        // Jobs are dealt out in turn; a worker that runs out takes from the back of the others' queues
+        void submit(std::function<void()> job)
+        {
+            Queue& queue = *queues[next++ % queues.size()];
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.jobs.emplace_back(std::move(job));
+            }
+            {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                pending++;
+            }
+            idle.notify_one();
+        }
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> jobs;
+        };
+
+        bool take(size_t self, std::function<void()>& job)
+        {
+            for (size_t i = 0; i < queues.size(); i++)
+            {
+                Queue& queue = *queues[(self + i) % queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.jobs.empty())
+                {
+                    if (i == 0)
+                    {
+                        job = std::move(queue.jobs.front());
+                        queue.jobs.pop_front();
+                    }
+                    else
+                    {
+                        job = std::move(queue.jobs.back());
+                        queue.jobs.pop_back();
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void work(size_t self)
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(idleMutex);
+                    idle.wait(lock, [this] { return pending > 0 || closing; });
+                    if (pending == 0)
+                    {
+                        return;
+                    }
+                    pending--;
+                }
+                // Every pending count stands for a job in some queue, so this finds one
+                std::function<void()> job;
+                while (!take(self, job)) {}
+                job();
+            }
+        }
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+        std::mutex idleMutex;
+        std::condition_variable idle;
+        size_t pending = 0;
+        size_t next    = 0;
+        bool closing   = false;
+    };
+
+    class Output
+    {
+    public:
+        explicit Output(const char* path) : out(fopen(path, "wb"))
+        {
+            if (out)
+            {
+                u32 header[2] = {version, u32(std::size(columnNames))};
+                fwrite("PKSMSCAN", 1, 8, out);
+                fwrite(header, sizeof(u32), 2, out);
+                fwrite(columnNames, sizeof(columnNames[0]), std::size(columnNames), out);
+            }
+        }
+        ~Output()
+        {
+            if (out)
+            {
+                fclose(out);
+            }
+        }
+
+        bool good(void) const { return out != nullptr; }
+
+        void write(const std::vector<u8>& group)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fwrite(group.data(), 1, group.size(), out);
+        }
+
+    private:
+        FILE* out;
+        std::mutex mutex;
+    };
+
+    struct Totals
+    {
+        std::atomic<u64> files{0};
+        std::atomic<u64> saves{0};
+        std::atomic<u64> bytes{0};
+        std::atomic<u64> pokemon{0};
+        std::atomic<u64> badSaves{0};
+        std::atomic<u64> corruptSlots{0};
+    };
+
+    template <typename T>
+    void append(std::vector<u8>& out, const T* values, size_t count)
+    {
+        const u8* bytes = (const u8*)values;
+        out.insert(out.end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    void appendStrings(std::vector<u8>& out, const PKXIndex& index, const std::vector<u32>& rows,
+        const std::string& (PKXIndex::*string)(size_t) const)
+    {
+        std::vector<u32> ends;
+        std::string strings;
+        for (u32 row : rows)
+        {
+            strings += (index.*string)(row);
+            ends.push_back(strings.size());
+        }
+        append(out, ends.data(), ends.size());
+        append(out, strings.data(), strings.size());
+    }
+
+    bool readFile(const std::string& path, std::unique_ptr<u8[]>& data, size_t size)
+    {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in)
+        {
+            return false;
+        }
+        data      = std::unique_ptr<u8[]>(new u8[size]);
+        bool good = fread(data.get(), 1, size, in) == size;
+        fclose(in);
+        return good;
+    }
+
+    void scan(const std::string& path, size_t size, Output& output, Totals& totals)
+    {
+        std::unique_ptr<u8[]> data;
+        if (!readFile(path, data, size))
+        {
+            fprintf(stderr, "Could not read %s\n", path.c_str());
+            return;
+        }
+        totals.bytes += size;
+        std::unique_ptr<Sav> save = Sav::getSave(std::move(data), size);
+        if (!save)
+        {
+            return;
+        }
+        totals.saves++;
+
+        // Checksums are over the data as it is on disk, so this has to happen before the boxes are decrypted
+        u16 blocks    = save->blocks().size();
+        u16 badBlocks = 0;
+        for (size_t i = 0; i < blocks; i++)
+        {
+            badBlocks += !save->blockValid(i);
+        }
+        if (badBlocks != 0)
+        {
+            totals.badSaves++;
+        }
+
+        save->cryptBoxData(true);
+        const int boxSlots = save->maxSlot();
+        PKXIndex index;
+        index.reset(boxSlots + 6);
+        // A damaged slot decodes to anything, and a species past the end of the personal tables would send the index reading outside them
+        u32 corruptSlots = 0;
+        auto add         = [&](size_t row, const PKX& pkm) {
+            if (pkm.encryptionConstant() == 0 && pkm.species() == 0)
+            {
+                return;
+            }
+            if (!pkm.checksumValid() || pkm.species() > save->maxSpecies())
+            {
+                corruptSlots++;
+                return;
+            }
+            index.set(row, pkm);
+        };
+        for (int i = 0; i < boxSlots; i++)
+        {
+            PKXView view = save->slotView(i / 30, i % 30);
+            if (view)
+            {
+                add(i, *view);
+            }
+        }
+        // The LGPE party only points at box slots, which are in already
+        for (u8 slot = 0; save->generation() != Generation::LGPE && slot < std::min(save->partyCount(), u8(6)); slot++)
+        {
+            add(boxSlots + slot, *save->pkm(slot));
+        }
+        totals.corruptSlots += corruptSlots;
+        std::vector<u32> rows = index.occupiedRows();
+        totals.pokemon += rows.size();
+
+        std::vector<u8> group;
+        u32 header[2] = {u32(rows.size()), u32(path.size())};
+        append(group, header, 2);
+        append(group, path.data(), path.size());
+        u8 game[2] = {u8(save->generation()), save->version()};
+        append(group, game, 2);
+        u16 checks[2] = {blocks, badBlocks};
+        append(group, checks, 2);
+
+        std::vector<u16> values(rows.size());
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            values[i] = rows[i] < u32(boxSlots) ? rows[i] / 30 : partyBox;
+        }
+        append(group, values.data(), values.size());
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            values[i] = rows[i] < u32(boxSlots) ? rows[i] % 30 : rows[i] - boxSlots;
+        }
+        append(group, values.data(), values.size());
+        for (size_t column = 0; column < size_t(PKXIndex::Column::COLUMN_COUNT); column++)
+        {
+            const std::vector<u16>& source = index.column(PKXIndex::Column(column));
+            for (size_t i = 0; i < rows.size(); i++)
+            {
+                values[i] = source[rows[i]];
+            }
+            append(group, values.data(), values.size());
+        }
+        appendStrings(group, index, rows, &PKXIndex::nickname);
+        appendStrings(group, index, rows, &PKXIndex::otName);
+        output.write(group);
+
+        if (badBlocks != 0)
+        {
+            fprintf(stderr, "%s: %u of %u blocks have bad checksums\n", path.c_str(), badBlocks, blocks);
+        }
+        if (corruptSlots != 0)
+        {
+            fprintf(stderr, "%s: %u corrupt slots skipped\n", path.c_str(), corruptSlots);
+        }
+    }
+
+    // Hands every file that has the size of a save to the pool, as the walk finds it
+    void walk(const std::filesystem::path& root, WorkStealingPool& pool, Output& output, Totals& totals)
+    {
+        auto visit = [&](const std::filesystem::path& path) {
+            std::error_code error;
+            if (!std::filesystem::is_regular_file(path, error))
+            {
+                return;
+            }
+            size_t size = std::filesystem::file_size(path, error);
+            totals.files++;
+            if (!error && std::find(std::begin(saveSizes), std::end(saveSizes), size) != std::end(saveSizes))
+            {
+                pool.submit([path = path.string(), size, &output, &totals] { scan(path, size, output, totals); });
+            }
+        };
+
+        std::error_code error;
+        if (!std::filesystem::is_directory(root, error))
+        {
+            visit(root);
+            return;
+        }
+        std::filesystem::recursive_directory_iterator it(root, std::filesystem::directory_options::skip_permission_denied, error);
+        for (; !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+        {
+            visit(it->path());
+        }
+        if (error)
+        {
+            fprintf(stderr, "Could not walk %s: %s\n", root.c_str(), error.message().c_str());
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t threads     = std::max(1u, std::thread::hardware_concurrency());
+    const char* output = "scan.bin";
+    std::vector<const char*> roots;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            threads = std::max(1, atoi(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else
+        {
+            roots.push_back(argv[i]);
+        }
+    }
+    if (roots.empty())
+    {
+        fprintf(stderr, "Usage: %s [--threads N] [--output scan.bin] <directories or files...>\n", argv[0]);
+        return 2;
+    }
+
+    Output out(output);
+    if (!out.good())
+    {
+        fprintf(stderr, "Could not write %s\n", output);
+        return 2;
+    }
+
+    Totals totals;
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(threads);
+        for (const char* root : roots)
+        {
+            walk(root, pool, out, totals);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fprintf(stderr, "%llu files, %llu saves (%llu with bad checksums), %llu Pokemon (%llu corrupt slots skipped) in %.2f s with %zu threads\n",
+        (unsigned long long)totals.files, (unsigned long long)totals.saves, (unsigned long long)totals.badSaves,
+        (unsigned long long)totals.pokemon, (unsigned long long)totals.corruptSlots, seconds, threads);
+    fprintf(stderr, "%.1f saves/s, %.0f Pokemon/s, %.1f MB/s\n", totals.saves / seconds, totals.pokemon / seconds,
+        totals.bytes / seconds / 1e6);
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ *   This file is part of PKSM
+ *   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+ *       * Requiring preservation of specified reasonable legal notices or
+ *         author attributions in that material or in the Appropriate Legal
+ *         Notices displayed by works containing it.
+ *       * Prohibiting misrepresentation of the origin of that material,
+ *         or requiring that modified versions of such material be marked in
+ *         reasonable ways as different from the original version.
+ */
+
+#include "host/utf.h"
+
+ssize_t decode_utf8(u32* out, const u8* in)
+{
+    u8 code1 = in[0];
+    if (code1 < 0x80)
+    {
+        *out = code1;
+        return 1;
+    }
+    else if (code1 < 0xC2)
+    {
+        return -1;
+    }
+    else if (code1 < 0xE0)
+    {
+        u8 code2 = in[1];
+        if ((code2 & 0xC0) != 0x80)
+        {
+            return -1;
+        }
+        *out = (code1 << 6) + code2 - 0x3080;
+        return 2;
+    }
+    else if (code1 < 0xF0)
+    {
+        u8 code2 = in[1];
+        if ((code2 & 0xC0) != 0x80 || (code1 == 0xE0 && code2 < 0xA0))
+        {
+            return -1;
+        }
+        u8 code3 = in[2];
+        if ((code3 & 0xC0) != 0x80)
+        {
+            return -1;
+        }
+        *out = (code1 << 12) + (code2 << 6) + code3 - 0xE2080;
+        return 3;
+    }
+    else if (code1 < 0xF5)
+    {
+        u8 code2 = in[1];
+        if ((code2 & 0xC0) != 0x80 || (code1 == 0xF0 && code2 < 0x90) || (code1 == 0xF4 && code2 >= 0x90))
+        {
+            return -1;
+        }
+        u8 code3 = in[2];
+        if ((code3 & 0xC0) != 0x80)
+        {
+            return -1;
+        }
+        u8 code4 = in[3];
+        if ((code4 & 0xC0) != 0x80)
+        {
+            return -1;
+        }
+        *out = (code1 << 18) + (code2 << 12) + (code3 << 6) + code4 - 0x3C82080;
+        return 4;
+    }
+    return -1;
+}
+
+ssize_t encode_utf8(u8* out, u32 in)
+{
+    if (in < 0x80)
+    {
+        if (out != nullptr)
+        {
+            *out++ = in;
+        }
+        return 1;
+    }
+    else if (in < 0x800)
+    {
+        if (out != nullptr)
+        {
+            *out++ = (in >> 6) + 0xC0;
+            *out++ = (in & 0x3F) + 0x80;
+        }
+        return 2;
+    }
+    else if (in < 0x10000)
+    {
+        if (out != nullptr)
+        {
+            *out++ = (in >> 12) + 0xE0;
+            *out++ = ((in >> 6) & 0x3F) + 0x80;
+            *out++ = (in & 0x3F) + 0x80;
+        }
+        return 3;
+    }
+    else if (in < 0x110000)
+    {
+        if (out != nullptr)
+        {
+            *out++ = (in >> 18) + 0xF0;
+            *out++ = ((in >> 12) & 0x3F) + 0x80;
+            *out++ = ((in >> 6) & 0x3F) + 0x80;
+            *out++ = (in & 0x3F) + 0x80;
+        }
+        return 4;
+    }
+    return -1;
+}